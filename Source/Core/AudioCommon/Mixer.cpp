@@ -6,8 +6,12 @@
 #include "AudioCommon/AudioCommon.h"
 #include "AudioCommon/Mixer.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "Common/Atomic.h"
 #include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/Swap.h"
@@ -37,46 +41,163 @@ CMixer::CMixer(u32 BackendSampleRate)
 	INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
 }
 
-void CMixer::LinearMixerFifo::Interpolate(u32 left_input_index, float* left_output, float* right_output)
+// Phases of the windowed sinc filter table. Coefficients between two phases are
+// linearly interpolated.
+static const u32 SINC_PHASES = 256;
+
+// Builds the windowed sinc filter, with each coefficient stored twice so that
+// it lines up with interleaved stereo input. Phase p of the table interpolates
+// at p / SINC_PHASES frames after the middle of the filter.
+std::vector<float> CMixer::CubicMixerFifo::BuildSincTable()
 {
-	*left_output = (1 - m_fraction) * m_float_buffer[left_input_index & INDEX_MASK]
-		+ m_fraction * m_float_buffer[(left_input_index + 2) & INDEX_MASK];
-	*right_output = (1 - m_fraction) * m_float_buffer[(left_input_index + 1) & INDEX_MASK]
-		+ m_fraction * m_float_buffer[(left_input_index + 3) & INDEX_MASK];
+	const u32 taps = SINC_TAPS;
+	// Slightly below the input Nyquist frequency, to leave room for the
+	// transition band of a short filter
+	const double cutoff = 0.9;
+
+	std::vector<float> table((SINC_PHASES + 1) * taps * 2);
+	for (u32 phase = 0; phase <= SINC_PHASES; ++phase)
+	{
+		double coefs[SINC_TAPS];
+		double sum = 0.0;
+		for (u32 tap = 0; tap < taps; ++tap)
+		{
+			const double x = (double)tap - (taps / 2 - 1) - (double)phase / SINC_PHASES;
+			const double sinc = x == 0.0 ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+			// Blackman window over the taps
+			const double w = 2.0 * M_PI * (x + taps / 2) / taps;
+			const double window = 0.42 - 0.5 * cos(w) + 0.08 * cos(2.0 * w);
+			coefs[tap] = sinc * window;
+			sum += coefs[tap];
+		}
+		// Unity gain at DC for every phase
+		for (u32 tap = 0; tap < taps; ++tap)
+		{
+			table[(phase * taps + tap) * 2] = (float)(coefs[tap] / sum);
+			table[(phase * taps + tap) * 2 + 1] = (float)(coefs[tap] / sum);
+		}
+	}
+	return table;
 }
 
-void CMixer::CubicMixerFifo::Interpolate(u32 left_input_index, float* left_output, float* right_output)
+void CMixer::LinearMixerFifo::Interpolate(const float* input, const u32* positions,
+	const float* fractions, u32 count, float* output)
 {
-	static const float cubic_coef[] =
+	for (u32 i = 0; i < count; ++i)
 	{
-	  -0.5f, 1.0f, -0.5f, 0.0f,
-	  1.5f, -2.5f, 0.0f, 1.0f,
-	  -1.5f, 2.0f, 0.5f, 0.0f,
-	  0.5f, -0.5f, 0.0f, 0.0f
-	};
-
-	const float x2 = m_fraction;		// x
-	const float x1 = x2*x2;          // x^2
-	const float x0 = x1*x2;          // x^3
-
-	float y0 = cubic_coef[0] * x0 + cubic_coef[1] * x1 + cubic_coef[2] * x2 + cubic_coef[3];
-	float y1 = cubic_coef[4] * x0 + cubic_coef[5] * x1 + cubic_coef[6] * x2 + cubic_coef[7];
-	float y2 = cubic_coef[8] * x0 + cubic_coef[9] * x1 + cubic_coef[10] * x2 + cubic_coef[11];
-	float y3 = cubic_coef[12] * x0 + cubic_coef[13] * x1 + cubic_coef[14] * x2 + cubic_coef[15];
-
-	*left_output = y0 * m_float_buffer[left_input_index & INDEX_MASK]
-		+ y1 * m_float_buffer[(left_input_index + 2) & INDEX_MASK]
-		+ y2 * m_float_buffer[(left_input_index + 4) & INDEX_MASK]
-		+ y3 * m_float_buffer[(left_input_index + 6) & INDEX_MASK];
-	*right_output = y0 * m_float_buffer[(left_input_index + 1) & INDEX_MASK]
-		+ y1 * m_float_buffer[(left_input_index + 3) & INDEX_MASK]
-		+ y2 * m_float_buffer[(left_input_index + 5) & INDEX_MASK]
-		+ y3 * m_float_buffer[(left_input_index + 7) & INDEX_MASK];
+		const float* in = input + positions[i];
+		const float fraction = fractions[i];
+#ifdef _M_X86
+		const __m128 weights = _mm_setr_ps(1 - fraction, 1 - fraction, fraction, fraction);
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(in), weights);
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		_mm_storel_pi((__m64*)(output + i * 2), sum);
+#else
+		output[i * 2] = (1 - fraction) * in[0] + fraction * in[2];
+		output[i * 2 + 1] = (1 - fraction) * in[1] + fraction * in[3];
+#endif
+	}
+}
+
+void CMixer::CubicMixerFifo::Interpolate(const float* input, const u32* positions,
+	const float* fractions, u32 count, float* output)
+{
+	if (m_sinc)
+	{
+		static const std::vector<float> table = BuildSincTable();
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			const float* in = input + positions[i];
+			const float scaled_fraction = fractions[i] * SINC_PHASES;
+			const u32 phase = std::min((u32)scaled_fraction, SINC_PHASES - 1);
+			const float t = scaled_fraction - phase;
+			const float* coefs0 = &table[phase * SINC_TAPS * 2];
+			const float* coefs1 = coefs0 + SINC_TAPS * 2;
+#ifdef _M_X86
+			const __m128 t4 = _mm_set1_ps(t);
+			__m128 sum = _mm_setzero_ps();
+			for (u32 j = 0; j < SINC_TAPS * 2; j += 4)
+			{
+				const __m128 c0 = _mm_loadu_ps(coefs0 + j);
+				const __m128 c1 = _mm_loadu_ps(coefs1 + j);
+				const __m128 c = _mm_add_ps(c0, _mm_mul_ps(t4, _mm_sub_ps(c1, c0)));
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + j), c));
+			}
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			_mm_storel_pi((__m64*)(output + i * 2), sum);
+#else
+			float left = 0.0f, right = 0.0f;
+			for (u32 j = 0; j < SINC_TAPS * 2; j += 2)
+			{
+				const float c = coefs0[j] + t * (coefs1[j] - coefs0[j]);
+				left += in[j] * c;
+				right += in[j + 1] * c;
+			}
+			output[i * 2] = left;
+			output[i * 2 + 1] = right;
+#endif
+		}
+		return;
+	}
+
+	u32 i = 0;
+#ifdef _M_X86
+	// Computes the weights of four frames at once, then applies them per frame
+	// to both channels of two taps at a time.
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(fractions + i);
+		const __m128 x2 = _mm_mul_ps(x, x);
+		const __m128 x3 = _mm_mul_ps(x2, x);
+		const __m128 half = _mm_set1_ps(0.5f);
+		__m128 y[4];
+		// -0.5x^3 + x^2 - 0.5x
+		y[0] = _mm_sub_ps(x2, _mm_mul_ps(half, _mm_add_ps(x3, x)));
+		// 1.5x^3 - 2.5x^2 + 1
+		y[1] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.5f), x3),
+			_mm_mul_ps(_mm_set1_ps(2.5f), x2)), _mm_set1_ps(1.0f));
+		// -1.5x^3 + 2x^2 + 0.5x
+		y[2] = _mm_add_ps(_mm_sub_ps(_mm_add_ps(x2, x2), _mm_mul_ps(_mm_set1_ps(1.5f), x3)),
+			_mm_mul_ps(half, x));
+		// 0.5x^3 - 0.5x^2
+		y[3] = _mm_mul_ps(half, _mm_sub_ps(x3, x2));
+
+		// Transposes to the four weights of each frame
+		_MM_TRANSPOSE4_PS(y[0], y[1], y[2], y[3]);
+		for (u32 j = 0; j < 4; ++j)
+		{
+			const float* in = input + positions[i + j];
+			// [y0, y0, y1, y1] and [y2, y2, y3, y3]
+			const __m128 w01 = _mm_unpacklo_ps(y[j], y[j]);
+			const __m128 w23 = _mm_unpackhi_ps(y[j], y[j]);
+			__m128 sum = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in), w01),
+				_mm_mul_ps(_mm_loadu_ps(in + 4), w23));
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			_mm_storel_pi((__m64*)(output + (i + j) * 2), sum);
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		const float* in = input + positions[i];
+		const float x = fractions[i];
+		const float x2 = x * x;
+		const float x3 = x2 * x;
+
+		const float y0 = x2 - 0.5f * (x3 + x);
+		const float y1 = 1.5f * x3 - 2.5f * x2 + 1.0f;
+		const float y2 = (x2 + x2) - 1.5f * x3 + 0.5f * x;
+		const float y3 = 0.5f * (x3 - x2);
+
+		output[i * 2] = y0 * in[0] + y1 * in[2] + y2 * in[4] + y3 * in[6];
+		output[i * 2 + 1] = y0 * in[1] + y1 * in[3] + y2 * in[5] + y3 * in[7];
+	}
 }
 
 void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framelimit)
 {
-	u32 current_sample = 0;
 	// Cache access in non-volatile variable so interpolation loop can be optimized
 	u32 read_index = m_read_index.load();
 	const u32 write_index = m_write_index.load();
@@ -102,27 +223,72 @@ void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framel
 	float ratio = aid_sample_rate / (float)m_mixer->m_sample_rate;
 	float l_volume = (float)m_lvolume.load() / 256.f;
 	float r_volume = (float)m_rvolume.load() / 256.f;
-	// for each output sample pair (left and right),
-	// linear interpolate between current and next sample
-	// increment output sample position
-	// increment input sample position by ratio, store fraction
-	// QUESTION: do we need to check for NUM_CROSSINGS samples before we interpolate?
-	// seems to work fine as is
-	for (; current_sample < numSamples * 2 && ((write_index - read_index) & INDEX_MASK) > GetWindowSize(); current_sample += 2)
+	const u32 window_size = GetWindowSize();
+
+	// First step the input position for each output sample pair (left and right):
+	// increment input sample position by ratio, store fraction.
+	// Then interpolate the whole buffer at once.
+	m_positions.resize(numSamples);
+	m_fractions.resize(numSamples);
+	// Locals, since the stores to the buffers could alias the members
+	u32* const positions = m_positions.data();
+	float* const fractions = m_fractions.data();
+	float fraction = m_fraction;
+	const u32 start_index = read_index;
+	u32 count = 0;
+	for (; count < numSamples && ((write_index - read_index) & INDEX_MASK) > window_size; ++count)
 	{
-		float l_output, r_output;
-		Interpolate(read_index, &l_output, &r_output);
-		samples[current_sample + 1] += l_volume * l_output;
-		samples[current_sample] += r_volume * r_output;
-		m_fraction += ratio;
-		read_index += 2 * (s32)m_fraction;
-		m_fraction = m_fraction - (s32)m_fraction;
+		positions[count] = read_index - start_index;
+		fractions[count] = fraction;
+		// Subtracting whole steps keeps float to int conversions out of the
+		// dependency chain between frames.
+		fraction += ratio;
+		while (fraction >= 1.0f)
+		{
+			fraction -= 1.0f;
+			read_index += 2;
+		}
 	}
+	m_fraction = fraction;
+
+	if (count)
+	{
+		// Copy the part of the FIFO the interpolation reads from, so that it
+		// doesn't have to handle the wrap around.
+		const u32 input_size = m_positions[count - 1] + window_size;
+		const u32 first = start_index & INDEX_MASK;
+		const u32 first_size = std::min(input_size, MAX_SAMPLES * 2 - first);
+		m_input.resize(input_size);
+		std::copy_n(m_float_buffer.begin() + first, first_size, m_input.begin());
+		std::copy_n(m_float_buffer.begin(), input_size - first_size, m_input.begin() + first_size);
+
+		m_output.resize(count * 2);
+		Interpolate(m_input.data(), m_positions.data(), m_fractions.data(), count, m_output.data());
+
+		// The FIFO has the left channel first, the output the right one
+		u32 i = 0;
+#ifdef _M_X86
+		const __m128 volumes = _mm_setr_ps(r_volume, l_volume, r_volume, l_volume);
+		for (; i + 4 <= count * 2; i += 4)
+		{
+			__m128 frames = _mm_loadu_ps(&m_output[i]);
+			frames = _mm_shuffle_ps(frames, frames, _MM_SHUFFLE(2, 3, 0, 1));
+			_mm_storeu_ps(samples + i,
+				_mm_add_ps(_mm_loadu_ps(samples + i), _mm_mul_ps(frames, volumes)));
+		}
+#endif
+		for (; i < count * 2; i += 2)
+		{
+			samples[i] += r_volume * m_output[i + 1];
+			samples[i + 1] += l_volume * m_output[i];
+		}
+	}
+
 	// pad output if not enough input samples
 	float s[2];
 	s[0] = m_float_buffer[(read_index - 1) & INDEX_MASK] * r_volume;
 	s[1] = m_float_buffer[(read_index - 2) & INDEX_MASK] * l_volume;
-	for (; current_sample < numSamples * 2; current_sample += 2)
+	for (u32 current_sample = count * 2; current_sample < numSamples * 2; current_sample += 2)
 	{
 		samples[current_sample] += s[0];
 		samples[current_sample + 1] += s[1];
@@ -158,9 +324,7 @@ u32 CMixer::Mix(s16* samples, u32 num_samples, bool consider_framelimit)
 	// reset float output buffer
 	m_output_buffer.resize(num_samples * 2);
 	std::fill_n(m_output_buffer.begin(), num_samples * 2, 0.f);
-	m_dma_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
-	m_streaming_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
-	m_wiimote_speaker_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
+	MixFifos(m_output_buffer.data(), num_samples, consider_framelimit);
 	// dither and clamp
 	for (u32 i = 0; i < num_samples * 2; i += 2)
 	{
@@ -180,10 +344,19 @@ u32 CMixer::Mix(float* samples, u32 num_samples, bool consider_framelimit)
 		return 0;
 	std::lock_guard<std::mutex> lk(m_cs_mixing);
 	memset(samples, 0, num_samples * 2 * sizeof(float));
+	MixFifos(samples, num_samples, consider_framelimit);
+	return num_samples;
+}
+
+void CMixer::MixFifos(float* samples, u32 num_samples, bool consider_framelimit)
+{
+	const bool sinc = SConfig::GetInstance().bSincResampling;
+	m_dma_mixer.SetSincResampling(sinc);
+	m_streaming_mixer.SetSincResampling(sinc);
+
 	m_dma_mixer.Mix(samples, num_samples, consider_framelimit);
 	m_streaming_mixer.Mix(samples, num_samples, consider_framelimit);
 	m_wiimote_speaker_mixer.Mix(samples, num_samples, consider_framelimit);
-	return num_samples;
 }
 
 
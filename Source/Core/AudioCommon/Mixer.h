@@ -88,8 +88,12 @@ protected:
 			srand((u32)time(nullptr));
 			m_float_buffer.fill(0.0f);
 		}
+		// Number of input floats after a read position that Interpolate reads from.
 		virtual u32 GetWindowSize() = 0;
-		virtual void Interpolate(u32 left_input_index, float* left_output, float* right_output) = 0;
+		// Resamples <count> stereo frames to <output>. <input> is a linear copy of the
+		// FIFO, and frame i is interpolated at input + positions[i] with fractions[i].
+		virtual void Interpolate(const float* input, const u32* positions, const float* fractions,
+			u32 count, float* output) = 0;
 		void PushSamples(const s16* samples, u32 num_samples);
 		void Mix(float* samples, u32 numSamples, bool consider_framelimit = true);
 		void SetInputSampleRate(u32 rate);
@@ -112,6 +116,12 @@ protected:
 
 		float m_num_left_i;
 		float m_fraction;
+
+		// Scratch buffers of Mix, kept to avoid allocations on the audio thread
+		std::vector<u32> m_positions;
+		std::vector<float> m_fractions;
+		std::vector<float> m_input;
+		std::vector<float> m_output;
 	};
 
 	class LinearMixerFifo: public MixerFifo
@@ -119,7 +129,8 @@ protected:
 	public:
 		LinearMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate)
 		{}
-		void Interpolate(u32 left_input_index, float* left_output, float* right_output) override;
+		void Interpolate(const float* input, const u32* positions, const float* fractions, u32 count,
+			float* output) override;
 		u32 GetWindowSize() override
 		{
 			return 4;
@@ -129,13 +140,28 @@ protected:
 	class CubicMixerFifo: public MixerFifo
 	{
 	public:
-		CubicMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate)
+		CubicMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate), m_sinc(false)
 		{}
-		void Interpolate(u32 left_input_index, float* left_output, float* right_output) override;
+		void Interpolate(const float* input, const u32* positions, const float* fractions, u32 count,
+			float* output) override;
 		u32 GetWindowSize() override
 		{
-			return 8;
+			return m_sinc ? SINC_TAPS * 2 : 8;
 		};
+		// Switches to the windowed sinc filter, which is slower but has much less
+		// aliasing than the cubic one.
+		void SetSincResampling(bool enable)
+		{
+			m_sinc = enable;
+		}
+
+		// Input frames the windowed sinc filter reads for each output frame
+		static const u32 SINC_TAPS = 16;
+
+	private:
+		static std::vector<float> BuildSincTable();
+
+		bool m_sinc;
 	};
 
 	CubicMixerFifo m_dma_mixer;
@@ -158,6 +184,7 @@ protected:
 	std::atomic<float> m_speed; // Current rate of the emulation (1.0 = 100% speed)
 
 private:
+	void MixFifos(float* samples, u32 num_samples, bool consider_framelimit);
 
 	std::vector<float> m_output_buffer;
 };
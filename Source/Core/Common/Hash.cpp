@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <xxhash.h>
 #include "Common/CommonFuncs.h"
 #include "Common/CPUDetect.h"
 #include "Common/Hash.h"
@@ -333,7 +334,7 @@ u64 GetCRC32(const u8* src, u32 len, u32 samples)
 * changed, make sure this one is still used when the legacy parameter is
 * true.
 */
-u64 GetHashHiresTexture(const u8* src, u32 len, u32 samples)
+u64 GetLegacyHiresTextureHash(const u8* src, u32 len, u32 samples)
 {
 	const u64 m = 0xc6a4a7935bd1e995;
 	u64 h = len * m;
@@ -530,7 +531,7 @@ u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 * 64-bit version. Until someone can make a new version of the 32-bit one that
 * makes identical hashes, this is just a c/p of the 64-bit one.
 */
-u64 GetHashHiresTexture(const u8* src, u32 len, u32 samples)
+u64 GetLegacyHiresTextureHash(const u8* src, u32 len, u32 samples)
 {
 	const u64 m = 0xc6a4a7935bd1e995ULL;
 	u64 h = len * m;
@@ -576,29 +577,52 @@ u64 GetHashHiresTexture(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+// With samples, the data is split into as many blocks and only the first bytes of each are hashed
+u64 GetXXHash64(const u8* src, u32 len, u32 samples)
+{
+	return XXH64(src, len, samples);
+}
+
+u64 GetHiresTextureHash(const u8* src, u32 len)
+{
+	return XXH64(src, len);
+}
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
 	return ptrHashFunction(src, len, samples);
 }
 
-// sets the hash function used for the texture cache
-void SetHash64Function()
+static bool CPUSupportsCRC32()
 {
 #if _M_SSE >= 0x402
-	if (cpu_info.bSSE4_2) // sse crc32 version
-	{
-		ptrHashFunction = &GetCRC32;
-	}
-	else
+	return cpu_info.bSSE4_2;
 #elif defined(_M_ARM_64)
-	if (cpu_info.bCRC32)
-	{
-		ptrHashFunction = &GetCRC32;
-	}
-	else
+	return cpu_info.bCRC32;
+#else
+	return false;
 #endif
+}
+
+// sets the hash function used for the texture cache
+void SetHash64Function(Hash64Function function)
+{
+	switch (function)
 	{
+	case HASH64_XXHASH64:
+		ptrHashFunction = &GetXXHash64;
+		break;
+	case HASH64_CRC32:
+	case HASH64_DEFAULT:
+		if (CPUSupportsCRC32())
+		{
+			ptrHashFunction = &GetCRC32;
+			break;
+		}
+		// fall through
+	default:
 		ptrHashFunction = &GetMurmurHash3;
+		break;
 	}
 }
 
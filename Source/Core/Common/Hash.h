@@ -12,7 +12,21 @@ u32 HashFletcher(const u8* data_u8, size_t length);  // FAST. Length & 1 == 0.
 u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightly slower
 u32 HashEctor(const u8* ptr, int length);            // JUNK. DO NOT USE FOR NEW THINGS
 u64 GetCRC32(const u8* src, u32 len, u32 samples);   // SSE4.2 version of CRC32
-u64 GetHashHiresTexture(const u8* src, u32 len, u32 samples = 0);
 u64 GetMurmurHash3(const u8* src, u32 len, u32 samples);
+u64 GetXXHash64(const u8* src, u32 len, u32 samples);
+
+// Custom textures are named after these hashes, so they must never change
+u64 GetLegacyHiresTextureHash(const u8* src, u32 len, u32 samples = 0);  // <game id>_<hash>_<format>
+u64 GetHiresTextureHash(const u8* src, u32 len);  // tex1_<width>x<height>_<hash>_<format>
+
+enum Hash64Function
+{
+	HASH64_DEFAULT,  // CRC32 if the CPU supports it, MurmurHash3 otherwise
+	HASH64_MURMURHASH3,
+	HASH64_CRC32,
+	HASH64_XXHASH64,
+};
+
+// The hash used by the texture cache and the shader caches
 u64 GetHash64(const u8* src, u32 len, u32 samples);
-void SetHash64Function();
+void SetHash64Function(Hash64Function function = HASH64_DEFAULT);
@@ -0,0 +1,79 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/MappedFile.h"
+
+#include <cinttypes>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+
+namespace Common
+{
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+bool MappedFile::Map(File::IOFile& file, u64 size)
+{
+	Unmap();
+	if (!file.IsOpen() || size == 0)
+		return false;
+
+#ifdef _WIN32
+	const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file.GetHandle())));
+	m_mapping = CreateFileMapping(handle, nullptr, PAGE_READONLY, static_cast<DWORD>(size >> 32),
+		static_cast<DWORD>(size), nullptr);
+	void* data =
+		m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size)) : nullptr;
+	if (!data)
+	{
+		ERROR_LOG(COMMON, "Failed to map %" PRIu64 " bytes of a file: %s", size,
+			GetLastErrorMsg().c_str());
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		m_mapping = nullptr;
+		return false;
+	}
+#else
+	void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileno(file.GetHandle()), 0);
+	if (data == MAP_FAILED)
+	{
+		ERROR_LOG(COMMON, "Failed to map %" PRIu64 " bytes of a file: %s", size,
+			GetLastErrorMsg().c_str());
+		return false;
+	}
+#endif
+
+	m_data = static_cast<const u8*>(data);
+	m_size = size;
+	return true;
+}
+
+void MappedFile::Unmap()
+{
+	if (!m_data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	munmap(const_cast<u8*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+}
@@ -0,0 +1,42 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace File
+{
+class IOFile;
+}
+
+namespace Common
+{
+// Read only view of the start of a file. The file can grow while it is mapped, but must not
+// shrink below the mapped size.
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Maps the first size bytes of file, replacing the previous view. Data written through file
+	// must be flushed to be visible.
+	bool Map(File::IOFile& file, u64 size);
+	void Unmap();
+
+	bool IsMapped() const { return m_data != nullptr; }
+	const u8* GetData() const { return m_data; }
+	u64 GetSize() const { return m_size; }
+
+private:
+	const u8* m_data = nullptr;
+	u64 m_size = 0;
+#ifdef _WIN32
+	void* m_mapping = nullptr;
+#endif
+};
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <chrono>
+
 #include "Common/Common.h"
 #include "Common/CPUDetect.h"
 #include "Common/ThreadPool.h"
@@ -11,6 +14,9 @@ ThreadPool::ThreadPool(): m_workflag(0), m_workercount(0), m_workers(16)
 	m_working.store(true);
 	int workers = cpu_info.logical_cpu_count - 1;
 	workers = workers < 1 ? 1 : workers;
+	m_passes.reset(new std::atomic<u32>[workers]);
+	for (int i = 0; i < workers; i++)
+		m_passes[i].store(0);
 	for (size_t i = 0; i < workers; i++)
 	{
 		std::thread* current = new std::thread(&ThreadPool::Workloop, std::ref(*this), i);
@@ -24,6 +30,10 @@ ThreadPool::ThreadPool(): m_workflag(0), m_workercount(0), m_workers(16)
 ThreadPool::~ThreadPool()
 {
 	m_working.store(false);
+	{
+		std::lock_guard<std::mutex> lk(m_wakeLock);
+	}
+	m_wake.notify_all();
 	for (u32 i = 0; i < m_workerThreads.size(); i++)
 	{
 		std::thread* current = m_workerThreads[i].get();
@@ -40,12 +50,31 @@ ThreadPool& ThreadPool::Getinstance()
 	return instance;
 }
 
-void ThreadPool::NotifyWorkPending()
+void ThreadPool::NotifyWorkPending(s32 count)
 {
-	ThreadPool::Getinstance().m_workflag.fetch_add(2);
+	ThreadPool& instance = ThreadPool::Getinstance();
+	instance.m_workflag.fetch_add(count);
+	// Taking the lock orders the flag update against a worker about to go to sleep
+	{
+		std::lock_guard<std::mutex> lk(instance.m_wakeLock);
+	}
+	instance.m_wake.notify_all();
+}
+
+size_t ThreadPool::GetWorkerThreadCount()
+{
+	return ThreadPool::Getinstance().m_workerThreads.size();
+}
+
+void ThreadPool::ParallelFor(s32 begin, s32 end, const std::function<void(s32, s32)>& func, s32 grain)
+{
+	ParallelForWorker::Getinstance().Run(begin, end, func, grain);
 }
 
 static SpinLock<true> workerLock;
+// Index of the pool thread running the current code, -1 on other threads
+static thread_local s32 s_worker_thread_id = -1;
+
 void ThreadPool::RegisterWorker(IWorker* worker)
 {
 	workerLock.lock();
@@ -71,16 +100,33 @@ void ThreadPool::UnregisterWorker(IWorker* worker)
 	instance.m_workers[index] = instance.m_workers[count - 1];
 	instance.m_workercount.fetch_sub(1);
 	workerLock.unlock();
+
+	// Threads that started walking the list before the removal may still call the worker, wait
+	// for them to finish that walk. Later walks don't see it anymore.
+	for (size_t i = 0; i < instance.m_workerThreads.size(); i++)
+	{
+		if (static_cast<s32>(i) == s_worker_thread_id)
+			continue;
+		const u32 pass = instance.m_passes[i].load();
+		if (pass & 1)
+		{
+			while (instance.m_passes[i].load() == pass)
+				Common::YieldCPU();
+		}
+	}
 }
 
 void ThreadPool::Workloop(ThreadPool &state, size_t ID)
 {
 	u32 rest_time = 1;
+	s_worker_thread_id = static_cast<s32>(ID);
+	std::atomic<u32>& passes = state.m_passes[ID];
 	while (state.m_working.load())
 	{
 		if (state.m_workflag.load() > ID)
 		{
 			bool worked = false;
+			passes.fetch_add(1);
 			u32 count = state.m_workercount.load();
 			for (u32 i = 0; i < count; i++)
 			{
@@ -94,6 +140,7 @@ void ThreadPool::Workloop(ThreadPool &state, size_t ID)
 					}
 				}
 			}
+			passes.fetch_add(1);
 			if (worked)
 			{
 				Common::YieldCPU();
@@ -110,7 +157,10 @@ void ThreadPool::Workloop(ThreadPool &state, size_t ID)
 			rest_time++;
 			rest_time = rest_time > 5 ? 5 : rest_time;
 		}
-		SleepCurrentThread(rest_time);
+		std::unique_lock<std::mutex> lk(state.m_wakeLock);
+		state.m_wake.wait_for(lk, std::chrono::milliseconds(rest_time), [&state, ID] {
+			return !state.m_working.load() || state.m_workflag.load() > static_cast<s32>(ID);
+		});
 	}
 }
 
@@ -154,3 +204,107 @@ void AsyncWorker::ExecuteAsync(std::function<void()> &&func)
 }
 
 
+
+ParallelForWorker& ParallelForWorker::Getinstance()
+{
+	static ParallelForWorker instance;
+	return instance;
+}
+
+ParallelForWorker::ParallelForWorker():
+	m_slices(ThreadPool::GetWorkerThreadCount() + 1),
+	m_inUse(false),
+	m_func(nullptr),
+	m_grain(1),
+	m_active(false),
+	m_remaining(0),
+	m_joined(0),
+	m_busy(0)
+{
+	ThreadPool::RegisterWorker(this);
+}
+
+ParallelForWorker::~ParallelForWorker()
+{
+	ThreadPool::UnregisterWorker(this);
+}
+
+bool ParallelForWorker::RunSlices(size_t home)
+{
+	bool worked = false;
+	size_t count = m_slices.size();
+	// Drain our own slice first, then steal from the others
+	for (size_t i = 0; i < count; i++)
+	{
+		Slice& slice = m_slices[(home + i) % count];
+		while (true)
+		{
+			s32 l = slice.next.fetch_add(m_grain);
+			if (l >= slice.end)
+				break;
+			s32 u = std::min(l + m_grain, slice.end);
+			(*m_func)(l, u);
+			m_remaining.fetch_sub(u - l);
+			worked = true;
+		}
+	}
+	return worked;
+}
+
+bool ParallelForWorker::NextTask()
+{
+	// m_busy keeps Run from returning while we may still look at the loop state
+	m_busy.fetch_add(1);
+	bool worked = false;
+	if (m_active.load())
+	{
+		size_t home = static_cast<size_t>(m_joined.fetch_add(1)) % m_slices.size();
+		worked = RunSlices(home);
+	}
+	m_busy.fetch_sub(1);
+	return worked;
+}
+
+void ParallelForWorker::Run(s32 begin, s32 end, const std::function<void(s32, s32)>& func, s32 grain)
+{
+	if (end <= begin)
+		return;
+	grain = std::max(grain, 1);
+	s32 total = end - begin;
+	s32 chunks = (total + grain - 1) / grain;
+	s32 participants = std::min(static_cast<s32>(m_slices.size()), chunks);
+	if (participants < 2 || m_inUse.exchange(true))
+	{
+		func(begin, end);
+		return;
+	}
+
+	// Give every participant a contiguous run of whole chunks
+	s32 per_slice = chunks / participants;
+	s32 extra = chunks % participants;
+	s32 position = begin;
+	for (s32 i = 0; i < static_cast<s32>(m_slices.size()); i++)
+	{
+		Slice& slice = m_slices[i];
+		s32 slice_chunks = i < participants ? per_slice + (i < extra ? 1 : 0) : 0;
+		slice.next.store(position);
+		slice.end = std::min(end, position + slice_chunks * grain);
+		position = slice.end;
+	}
+	m_func = &func;
+	m_grain = grain;
+	m_remaining.store(total);
+	m_joined.store(1);
+	m_active.store(true);
+	ThreadPool::NotifyWorkPending(participants - 1);
+
+	RunSlices(0);
+	// Wait for the chunks still running on other threads
+	while (m_remaining.load() > 0)
+		Common::YieldCPU();
+	m_active.store(false);
+	while (m_busy.load() > 0)
+		Common::YieldCPU();
+	m_func = nullptr;
+	m_inUse.store(false);
+}
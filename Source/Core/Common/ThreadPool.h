@@ -31,7 +31,10 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include "Common/Thread.h"
 
@@ -442,9 +445,13 @@ class ThreadPool
 private:
 	std::vector<std::unique_ptr<std::thread>> m_workerThreads;
 	std::vector<IWorker*> m_workers;
+	// Incremented by each worker thread before and after it walks m_workers, odd while walking
+	std::unique_ptr<std::atomic<u32>[]> m_passes;
 	std::atomic<s32> m_workflag;
 	std::atomic<s32> m_workercount;
 	std::atomic<bool> m_working;
+	std::mutex m_wakeLock;
+	std::condition_variable m_wake;
 	static void Workloop(ThreadPool &state, size_t ID);
 	static ThreadPool &Getinstance();
 	ThreadPool(ThreadPool const&);
@@ -452,9 +459,45 @@ private:
 	ThreadPool();
 public:
 	virtual ~ThreadPool();
-	static void NotifyWorkPending();
+	// Wakes up the first count worker threads
+	static void NotifyWorkPending(s32 count = 2);
 	static void RegisterWorker(IWorker* worker);
+	// Returns once no worker thread can call worker->NextTask() anymore, so it can be freed
 	static void UnregisterWorker(IWorker* worker);
+	static size_t GetWorkerThreadCount();
+	// Runs func(l, u) over consecutive subranges of [begin, end) on the calling thread and all the
+	// worker threads, returning once the whole range is done. Every thread starts on its own slice
+	// of the range and steals chunks of at least grain items from the other slices when it runs out.
+	// Only one loop runs at a time: a call made while another loop is active (including from inside
+	// func) runs serially on the calling thread.
+	static void ParallelFor(s32 begin, s32 end, const std::function<void(s32, s32)>& func, s32 grain = 1);
+};
+
+class ParallelForWorker final: IWorker
+{
+private:
+	// One per participating thread, padded to keep the counters on separate cache lines
+	struct Slice
+	{
+		std::atomic<s32> next;
+		s32 end;
+		u8 padding[56];
+	};
+	std::vector<Slice> m_slices;
+	std::atomic<bool> m_inUse;
+	const std::function<void(s32, s32)>* m_func;
+	s32 m_grain;
+	std::atomic<bool> m_active;
+	std::atomic<s32> m_remaining;
+	std::atomic<s32> m_joined;
+	std::atomic<s32> m_busy;
+	bool RunSlices(size_t home);
+	ParallelForWorker();
+public:
+	static ParallelForWorker &Getinstance();
+	virtual ~ParallelForWorker();
+	bool NextTask() override;
+	void Run(s32 begin, s32 end, const std::function<void(s32, s32)>& func, s32 grain);
 };
 
 class AsyncWorker final: IWorker
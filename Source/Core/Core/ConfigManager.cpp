@@ -234,6 +234,7 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("Fastmem", bFastmem);
 	core->Set("CPUThread", bCPUThread);
 	core->Set("DSPHLE", bDSPHLE);
+	core->Set("DSPHLEParallelVoices", bDSPHLEParallelVoices);
 	core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
 	core->Set("SyncGPU", bSyncGPU);
 	core->Set("SyncGpuMaxDistance", iSyncGpuMaxDistance);
@@ -249,6 +250,7 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("OverrideGCLang", bOverrideGCLanguage);
 	core->Set("DPL2Decoder", bDPL2Decoder);
 	core->Set("TimeStretching", bTimeStretching);
+	core->Set("SincResampling", bSincResampling);
 	core->Set("RSHACK", bRSHACK);
 	core->Set("Latency", iLatency);
 	core->Set("MemcardAPath", m_strMemoryCardA);
@@ -271,6 +273,16 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("WiimoteEnableSpeaker", m_WiimoteEnableSpeaker);
 	core->Set("RunCompareServer", bRunCompareServer);
 	core->Set("RunCompareClient", bRunCompareClient);
+	core->Set("MemoryWatcherBinary", bMemoryWatcherBinary);
+	core->Set("MemoryWatcherRate", iMemoryWatcherRate);
+	core->Set("JITPersistentCache", bJITPersistentCache);
+	core->Set("JITBackgroundCompile", bJITBackgroundCompile);
+	core->Set("RewindEnabled", bRewindEnabled);
+	core->Set("RewindInterval", iRewindInterval);
+	core->Set("RewindBufferSize", iRewindBufferSize);
+	core->Set("NetPlayRollback", bNetPlayRollback);
+	core->Set("NetPlayRollbackFrames", iNetPlayRollbackFrames);
+	core->Set("NetPlayAdaptiveBuffer", bNetPlayAdaptiveBuffer);
 	core->Set("EmulationSpeed", m_EmulationSpeed);
 	core->Set("FrameSkip", m_FrameSkip);
 	core->Set("Overclock", m_OCFactor);
@@ -287,6 +299,7 @@ void SConfig::SaveMovieSettings(IniFile& ini)
 	IniFile::Section* movie = ini.GetOrCreateSection("Movie");
 
 	movie->Set("PauseMovie", m_PauseMovie);
+	movie->Set("StreamInput", m_StreamMovieInput);
 	movie->Set("Author", m_strMovieAuthor);
 	movie->Set("DumpFrames", m_DumpFrames);
 	movie->Set("DumpFramesSilent", m_DumpFramesSilent);
@@ -319,6 +332,7 @@ void SConfig::SaveFifoPlayerSettings(IniFile& ini)
 	IniFile::Section* fifoplayer = ini.GetOrCreateSection("FifoPlayer");
 
 	fifoplayer->Set("LoopReplay", bLoopFifoReplay);
+	fifoplayer->Set("CompressLogs", bCompressFifoLogs);
 }
 
 void SConfig::SaveNetworkSettings(IniFile& ini)
@@ -558,6 +572,7 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 #endif
 	core->Get("Fastmem", &bFastmem, true);
 	core->Get("DSPHLE", &bDSPHLE, true);
+	core->Get("DSPHLEParallelVoices", &bDSPHLEParallelVoices, false);
 	core->Get("TimingVariance", &iTimingVariance, 40);
 	core->Get("CPUThread", &bCPUThread, true);
 	core->Get("SyncOnSkipIdle", &bSyncGPUOnSkipIdleHack, true);
@@ -568,6 +583,7 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("SelectedLanguage", &SelectedLanguage, 0);
 	core->Get("OverrideGCLang", &bOverrideGCLanguage, false);
 	core->Get("DPL2Decoder", &bDPL2Decoder, false);
+	core->Get("SincResampling", &bSincResampling, false);
 	core->Get("Latency", &iLatency, 2);
 	core->Get("MemcardAPath", &m_strMemoryCardA);
 	core->Get("MemcardBPath", &m_strMemoryCardB);
@@ -592,6 +608,16 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("WiimoteEnableSpeaker", &m_WiimoteEnableSpeaker, false);
 	core->Get("RunCompareServer", &bRunCompareServer, false);
 	core->Get("RunCompareClient", &bRunCompareClient, false);
+	core->Get("MemoryWatcherBinary", &bMemoryWatcherBinary, false);
+	core->Get("MemoryWatcherRate", &iMemoryWatcherRate, 600);
+	core->Get("JITPersistentCache", &bJITPersistentCache, false);
+	core->Get("JITBackgroundCompile", &bJITBackgroundCompile, false);
+	core->Get("RewindEnabled", &bRewindEnabled, false);
+	core->Get("RewindInterval", &iRewindInterval, 60);
+	core->Get("RewindBufferSize", &iRewindBufferSize, 256);
+	core->Get("NetPlayRollback", &bNetPlayRollback, false);
+	core->Get("NetPlayRollbackFrames", &iNetPlayRollbackFrames, 7);
+	core->Get("NetPlayAdaptiveBuffer", &bNetPlayAdaptiveBuffer, false);
 	core->Get("MMU", &bMMU, false);
 	core->Get("BBDumpPort", &iBBDumpPort, -1);
 	core->Get("SyncGPU", &bSyncGPU, false);
@@ -620,6 +646,7 @@ void SConfig::LoadMovieSettings(IniFile& ini)
 	IniFile::Section* movie = ini.GetOrCreateSection("Movie");
 
 	movie->Get("PauseMovie", &m_PauseMovie, false);
+	movie->Get("StreamInput", &m_StreamMovieInput, false);
 	movie->Get("Author", &m_strMovieAuthor, "");
 	movie->Get("DumpFrames", &m_DumpFrames, false);
 	movie->Get("DumpFramesSilent", &m_DumpFramesSilent, false);
@@ -654,6 +681,7 @@ void SConfig::LoadFifoPlayerSettings(IniFile& ini)
 	IniFile::Section* fifoplayer = ini.GetOrCreateSection("FifoPlayer");
 
 	fifoplayer->Get("LoopReplay", &bLoopFifoReplay, true);
+	fifoplayer->Get("CompressLogs", &bCompressFifoLogs, false);
 }
 
 void SConfig::LoadNetworkSettings(IniFile& ini)
@@ -816,7 +844,18 @@ void SConfig::LoadDefaults()
 	bCPUThread = false;
 	bSyncGPUOnSkipIdleHack = true;
 	bRunCompareServer = false;
+	bMemoryWatcherBinary = false;
+	iMemoryWatcherRate = 600;
+	bJITPersistentCache = false;
+	bJITBackgroundCompile = false;
+	bRewindEnabled = false;
+	iRewindInterval = 60;
+	iRewindBufferSize = 256;
+	bNetPlayRollback = false;
+	iNetPlayRollbackFrames = 7;
+	bNetPlayAdaptiveBuffer = false;
 	bDSPHLE = true;
+	bDSPHLEParallelVoices = false;
 	bFastmem = true;
 	bFPRF = false;
 	bAccurateNaNs = false;
@@ -835,6 +874,7 @@ void SConfig::LoadDefaults()
 	bWii = false;
 	bDPL2Decoder = false;
 	bTimeStretching = false;
+	bSincResampling = false;
 	bRSHACK = false;
 	iLatency = 14;
 
@@ -848,6 +888,7 @@ void SConfig::LoadDefaults()
 	m_analytics_permission_asked = false;
 
 	bLoopFifoReplay = true;
+	bCompressFifoLogs = false;
 
 	bJITOff = false;  // debugger only settings
 	bJITLoadStoreOff = false;
@@ -94,6 +94,10 @@ struct SConfig : NonCopyable
 	bool bJITBranchOff = false;
 	bool bJITILTimeProfiling = false;
 	bool bJITILOutputIR = false;
+	// Compile the blocks of earlier sessions ahead of their first execution (Jit64 only)
+	bool bJITPersistentCache = false;
+	// Compile blocks on a separate thread and interpret them until they are ready (Jit64 only)
+	bool bJITBackgroundCompile = false;
 
 	bool bFastmem;
 	bool bFPRF = false;
@@ -103,6 +107,8 @@ struct SConfig : NonCopyable
 	bool bCPUThread = true;
 	bool bDSPThread = false;
 	bool bDSPHLE = true;
+	// Process the voices of the AX HLE ucodes on the thread pool
+	bool bDSPHLEParallelVoices = false;
 	bool bSyncGPUOnSkipIdleHack = true;
 	bool bForceNTSCJ = false;
 	bool bHLE_BS2 = true;
@@ -112,12 +118,24 @@ struct SConfig : NonCopyable
 
 	bool bDPL2Decoder = false;
 	bool bTimeStretching = false;
+	bool bSincResampling = false;
 	bool bRSHACK = false;
 	int iLatency = 14;
 
 	bool bRunCompareServer = false;
 	bool bRunCompareClient = false;
 
+	bool bMemoryWatcherBinary = false;
+	int iMemoryWatcherRate = 600;
+
+	bool bRewindEnabled = false;
+	int iRewindInterval = 60;
+	int iRewindBufferSize = 256;
+
+	bool bNetPlayRollback = false;
+	int iNetPlayRollbackFrames = 7;
+	bool bNetPlayAdaptiveBuffer = false;
+
 	bool bMMU = false;
 	bool bDCBZOFF = false;
 	bool bLowDCBZHack = false;
@@ -182,6 +200,8 @@ struct SConfig : NonCopyable
 
 	// Fifo Player related settings
 	bool bLoopFifoReplay = true;
+	// Stream recorded FIFO logs to disk, compressed
+	bool bCompressFifoLogs = false;
 
 	// Custom RTC
 	bool bEnableCustomRTC;
@@ -306,6 +326,7 @@ struct SConfig : NonCopyable
 
 	std::string m_WirelessMac;
 	bool m_PauseMovie;
+	bool m_StreamMovieInput;
 	bool m_ShowLag;
 	bool m_ShowFrameCount;
 	bool m_ShowRTC;
@@ -57,6 +57,7 @@
 #include "Core/PatchEngine.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 #include "Core/State.h"
 #include "Core/WiiRoot.h"
 
@@ -617,6 +618,9 @@ void EmuThread()
 
 	INFO_LOG(CONSOLE, "%s", StopMessage(true, "CPU thread stopped.").c_str());
 
+	// The samples are kept for the debugger, but the sampler thread can't outlive the emulation
+	Profiler::StopSampling();
+
 	if (core_parameter.bCPUThread)
 		video_backend->Video_Cleanup();
 
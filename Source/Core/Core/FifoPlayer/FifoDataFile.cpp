@@ -3,22 +3,38 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <string>
 
+#include <lzo/lzo1x.h>
+
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
 
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoFileStruct.h"
 
 using namespace FifoFileStruct;
 
-FifoDataFile::FifoDataFile() : m_Flags(0)
+// Identifies files in the decompressed frame caches, addresses may be reused
+static std::atomic<u64> s_next_id{1};
+
+FifoDataFile::FifoDataFile() : m_Flags(0), m_Id(s_next_id++)
 {
 }
 
 FifoDataFile::~FifoDataFile()
 {
+	const bool streaming = m_Writer.joinable();
+	StopWriter();
+	m_Mapping.Unmap();
+	m_BackingFile.Close();
+	if (streaming)
+		File::Delete(m_BackingFilename);
 }
 
 bool FifoDataFile::HasBrokenEFBCopies() const
@@ -36,13 +52,292 @@ bool FifoDataFile::GetIsWii() const
 	return GetFlag(FLAG_IS_WII);
 }
 
+bool FifoDataFile::IsCompressed() const
+{
+	return GetFlag(FLAG_COMPRESSED);
+}
+
+bool FifoDataFile::StartStreaming(const std::string& filename)
+{
+	if (IsCompressed() || m_FrameCount != 0)
+		return false;
+
+	// The header is written when saving, frame data starts right after it like in saved files
+	const FileHeader header = {};
+	if (!m_BackingFile.Open(filename, "w+b") || !m_BackingFile.WriteBytes(&header, sizeof(header)))
+	{
+		ERROR_LOG(VIDEO, "Failed to create the FIFO log stream %s", filename.c_str());
+		m_BackingFile.Close();
+		return false;
+	}
+
+	lzo_init();
+	SetFlag(FLAG_COMPRESSED, true);
+	m_BackingFilename = filename;
+	m_DataEnd = sizeof(FileHeader);
+	m_QuitWriter = false;
+	m_Writer = std::thread(&FifoDataFile::WriterThread, this);
+	return true;
+}
+
+void FifoDataFile::StopWriter()
+{
+	if (!m_Writer.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(m_WriterLock);
+		m_QuitWriter = true;
+	}
+	m_FrameQueued.notify_one();
+	m_Writer.join();
+}
+
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-	m_Frames.push_back(frameInfo);
+	++m_FrameCount;
+	m_FifoDataSize += frameInfo.fifoData.size();
+	for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+		m_MemoryUpdateSize += update.data.size();
+
+	if (!m_Writer.joinable())
+	{
+		m_Frames.push_back(frameInfo);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lk(m_WriterLock);
+		m_FrameWritten.wait(lk, [this] { return m_Queue.size() < QUEUE_LIMIT; });
+		m_Queue.push_back(frameInfo);
+	}
+	m_FrameQueued.notify_one();
+}
+
+void FifoDataFile::WriterThread()
+{
+	Common::SetCurrentThreadName("FIFO Log Writer");
+
+	std::unique_lock<std::mutex> lk(m_WriterLock);
+	while (true)
+	{
+		m_FrameQueued.wait(lk, [this] { return m_QuitWriter || !m_Queue.empty(); });
+		if (m_Queue.empty())
+			break;
+
+		// Stays queued until it's written, the recorder waits on the queue size
+		const FifoFrameInfo& frame = m_Queue.front();
+		lk.unlock();
+
+		CompressedFrameHeader frameHeader;
+		frameHeader.fifoDataSize = static_cast<u32>(frame.fifoData.size());
+		frameHeader.fifoStart = frame.fifoStart;
+		frameHeader.fifoEnd = frame.fifoEnd;
+		frameHeader.numMemoryUpdates = static_cast<u32>(frame.memoryUpdates.size());
+
+		const u8* headerBytes = reinterpret_cast<const u8*>(&frameHeader);
+		m_FrameBuffer.assign(headerBytes, headerBytes + sizeof(frameHeader));
+		m_FrameBuffer.insert(m_FrameBuffer.end(), frame.fifoData.begin(), frame.fifoData.end());
+		for (const MemoryUpdate& srcUpdate : frame.memoryUpdates)
+		{
+			CompressedMemoryUpdate dstUpdate;
+			dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+			dstUpdate.address = srcUpdate.address;
+			dstUpdate.data = WriteMemoryBlock(srcUpdate.data);
+			dstUpdate.type = srcUpdate.type;
+
+			const u8* updateBytes = reinterpret_cast<const u8*>(&dstUpdate);
+			m_FrameBuffer.insert(m_FrameBuffer.end(), updateBytes, updateBytes + sizeof(dstUpdate));
+		}
+		const CompressedBlock block = WriteBlock(m_FrameBuffer.data(),
+			static_cast<u32>(m_FrameBuffer.size()));
+
+		// Flushed so that it can be seen through the mapping
+		if (!m_BackingFile.Flush())
+			ERROR_LOG(VIDEO, "Failed to write to the FIFO log stream %s", m_BackingFilename.c_str());
+		const u64 dataEnd = m_BackingFile.Tell();
+
+		lk.lock();
+		m_Queue.pop_front();
+		m_CompressedFrames.push_back(block);
+		m_DataEnd = dataEnd;
+		m_FrameWritten.notify_all();
+	}
+}
+
+CompressedBlock FifoDataFile::WriteMemoryBlock(const std::vector<u8>& data)
+{
+	// Games upload the same textures and vertex data over and over
+	const u64 hash = GetXXHash64(data.data(), static_cast<u32>(data.size()), 0);
+	auto it = m_MemoryBlocks.find(hash);
+	if (it != m_MemoryBlocks.end() && BlockEquals(it->second, data))
+		return it->second;
+
+	const CompressedBlock block = WriteBlock(data.data(), static_cast<u32>(data.size()));
+	m_MemoryBlocks[hash] = block;
+	return block;
+}
+
+bool FifoDataFile::BlockEquals(const CompressedBlock& block, const std::vector<u8>& data)
+{
+	if (block.size != data.size())
+		return false;
+
+	// Read back through the writer's file, the block may not be flushed yet
+	const u64 end = m_BackingFile.Tell();
+	m_CompareBuffer.resize(block.compressedSize);
+	const bool read = m_BackingFile.Seek(block.offset, SEEK_SET) &&
+		m_BackingFile.ReadBytes(m_CompareBuffer.data(), block.compressedSize);
+	m_BackingFile.Seek(end, SEEK_SET);
+	if (!read)
+		return false;
+
+	if (block.compressedSize == block.size)
+		return std::memcmp(m_CompareBuffer.data(), data.data(), data.size()) == 0;
+
+	m_DecompressBuffer.resize(block.size);
+	lzo_uint size = block.size;
+	return lzo1x_decompress_safe(m_CompareBuffer.data(), block.compressedSize,
+		m_DecompressBuffer.data(), &size, nullptr) == LZO_E_OK && size == block.size &&
+		std::memcmp(m_DecompressBuffer.data(), data.data(), data.size()) == 0;
+}
+
+CompressedBlock FifoDataFile::WriteBlock(const u8* data, u32 size)
+{
+	thread_local std::vector<lzo_align_t> wrkmem(
+		(LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+
+	// Worst case expansion of LZO1X
+	m_CompressBuffer.resize(size + size / 16 + 64 + 3);
+	lzo_uint compressedSize = 0;
+	if (lzo1x_1_compress(data, size, m_CompressBuffer.data(), &compressedSize, wrkmem.data()) !=
+		LZO_E_OK || compressedSize >= size)
+	{
+		compressedSize = size;
+	}
+
+	CompressedBlock block;
+	block.offset = m_BackingFile.Tell();
+	block.compressedSize = static_cast<u32>(compressedSize);
+	block.size = size;
+	m_BackingFile.WriteBytes(compressedSize == size ? data : m_CompressBuffer.data(), compressedSize);
+	return block;
+}
+
+bool FifoDataFile::ReadBlock(const CompressedBlock& block, std::vector<u8>& data) const
+{
+	std::lock_guard<std::mutex> lk(m_MappingLock);
+	if (block.offset + block.compressedSize > m_Mapping.GetSize())
+	{
+		u64 dataEnd;
+		{
+			std::lock_guard<std::mutex> writerLock(m_WriterLock);
+			dataEnd = m_DataEnd;
+		}
+		if (block.offset + block.compressedSize > dataEnd || !m_Mapping.Map(m_BackingFile, dataEnd))
+			return false;
+	}
+
+	const u8* src = m_Mapping.GetData() + block.offset;
+	data.resize(block.size);
+	if (block.compressedSize == block.size)
+	{
+		std::memcpy(data.data(), src, block.size);
+		return true;
+	}
+
+	lzo_uint size = block.size;
+	return lzo1x_decompress_safe(src, block.compressedSize, data.data(), &size, nullptr) ==
+		LZO_E_OK && size == block.size;
+}
+
+bool FifoDataFile::DecompressFrame(u32 frame, FifoFrameInfo& frameInfo) const
+{
+	CompressedBlock block;
+	{
+		// A frame that was just recorded may still be waiting for the writer
+		std::unique_lock<std::mutex> lk(m_WriterLock);
+		m_FrameWritten.wait(lk, [this, frame] { return frame < m_CompressedFrames.size(); });
+		block = m_CompressedFrames[frame];
+	}
+
+	std::vector<u8> data;
+	if (!ReadBlock(block, data) || data.size() < sizeof(CompressedFrameHeader))
+		return false;
+
+	CompressedFrameHeader frameHeader;
+	std::memcpy(&frameHeader, data.data(), sizeof(frameHeader));
+	const u64 updatesOffset = sizeof(frameHeader) + u64(frameHeader.fifoDataSize);
+	if (updatesOffset + u64(frameHeader.numMemoryUpdates) * sizeof(CompressedMemoryUpdate) >
+		data.size())
+	{
+		return false;
+	}
+
+	const u8* fifoData = data.data() + sizeof(frameHeader);
+	frameInfo.fifoData.assign(fifoData, fifoData + frameHeader.fifoDataSize);
+	frameInfo.fifoStart = frameHeader.fifoStart;
+	frameInfo.fifoEnd = frameHeader.fifoEnd;
+
+	frameInfo.memoryUpdates.resize(frameHeader.numMemoryUpdates);
+	for (u32 i = 0; i < frameHeader.numMemoryUpdates; ++i)
+	{
+		CompressedMemoryUpdate srcUpdate;
+		std::memcpy(&srcUpdate, data.data() + updatesOffset + i * sizeof(srcUpdate),
+			sizeof(srcUpdate));
+
+		MemoryUpdate& dstUpdate = frameInfo.memoryUpdates[i];
+		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+		dstUpdate.address = srcUpdate.address;
+		dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
+		if (!ReadBlock(srcUpdate.data, dstUpdate.data))
+			return false;
+	}
+
+	return true;
+}
+
+const FifoFrameInfo& FifoDataFile::GetFrame(u32 frame) const
+{
+	if (!IsCompressed())
+		return m_Frames[frame];
+
+	struct CachedFrame
+	{
+		u64 fileId = 0;
+		u32 frame = 0;
+		FifoFrameInfo info;
+	};
+	// The player walks frames in order, and the dialog looks at one frame at a time
+	thread_local std::array<CachedFrame, FRAME_CACHE_SIZE> cache;
+	thread_local size_t nextSlot = 0;
+
+	for (const CachedFrame& cached : cache)
+	{
+		if (cached.fileId == m_Id && cached.frame == frame)
+			return cached.info;
+	}
+
+	CachedFrame& slot = cache[nextSlot];
+	nextSlot = (nextSlot + 1) % FRAME_CACHE_SIZE;
+	slot.fileId = 0;
+	if (frame >= m_FrameCount || !DecompressFrame(frame, slot.info))
+	{
+		ERROR_LOG(VIDEO, "Failed to read frame %u of a compressed FIFO log", frame);
+		slot.info = FifoFrameInfo();
+		return slot.info;
+	}
+
+	slot.fileId = m_Id;
+	slot.frame = frame;
+	return slot.info;
 }
 
 bool FifoDataFile::Save(const std::string& filename)
 {
+	if (IsCompressed())
+		return SaveCompressed(filename);
+
 	File::IOFile file;
 	if (!file.Open(filename, "wb"))
 		return false;
@@ -182,6 +477,22 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
 		file.ReadArray(dataFile->m_TexMem, size);
 	}
 
+	if (dataFile->IsCompressed())
+	{
+		// Frames are decompressed from the file when they are needed
+		dataFile->m_CompressedFrames.resize(header.frameCount);
+		file.Seek(header.frameListOffset, SEEK_SET);
+		if (!file.ReadArray(dataFile->m_CompressedFrames.data(), header.frameCount))
+			return nullptr;
+
+		lzo_init();
+		dataFile->m_FrameCount = header.frameCount;
+		dataFile->m_DataEnd = header.bpMemOffset;
+		dataFile->m_BackingFile = std::move(file);
+		dataFile->m_BackingFilename = filename;
+		return dataFile;
+	}
+
 	// Read frames
 	for (u32 i = 0; i < header.frameCount; ++i)
 	{
@@ -209,6 +520,70 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
 	return dataFile;
 }
 
+bool FifoDataFile::SaveCompressed(const std::string& filename)
+{
+	u64 dataEnd;
+	{
+		std::unique_lock<std::mutex> lk(m_WriterLock);
+		m_FrameWritten.wait(lk, [this] { return m_CompressedFrames.size() == m_FrameCount; });
+		dataEnd = m_DataEnd;
+	}
+
+	// A loaded log is saved over itself, its frames can't have changed
+	if (filename == m_BackingFilename && !m_Writer.joinable())
+		return true;
+
+	File::IOFile file;
+	if (!file.Open(filename, "wb"))
+		return false;
+
+	// The frame data is copied as it is, including the placeholder for the header, so that the
+	// block offsets stay valid
+	{
+		std::lock_guard<std::mutex> lk(m_MappingLock);
+		if (m_Mapping.GetSize() < dataEnd && !m_Mapping.Map(m_BackingFile, dataEnd))
+			return false;
+		if (!file.WriteBytes(m_Mapping.GetData(), dataEnd))
+			return false;
+	}
+
+	FileHeader header = {};
+	header.fileId = FILE_ID;
+	header.file_version = VERSION_NUMBER;
+	header.min_loader_version = MIN_COMPRESSED_LOADER_VERSION;
+
+	header.bpMemOffset = file.Tell();
+	header.bpMemSize = BP_MEM_SIZE;
+	file.WriteArray(m_BPMem, BP_MEM_SIZE);
+
+	header.cpMemOffset = file.Tell();
+	header.cpMemSize = CP_MEM_SIZE;
+	file.WriteArray(m_CPMem, CP_MEM_SIZE);
+
+	header.xfMemOffset = file.Tell();
+	header.xfMemSize = XF_MEM_SIZE;
+	file.WriteArray(m_XFMem, XF_MEM_SIZE);
+
+	header.xfRegsOffset = file.Tell();
+	header.xfRegsSize = XF_REGS_SIZE;
+	file.WriteArray(m_XFRegs, XF_REGS_SIZE);
+
+	header.texMemOffset = file.Tell();
+	header.texMemSize = TEX_MEM_SIZE;
+	file.WriteArray(m_TexMem, TEX_MEM_SIZE);
+
+	header.frameListOffset = file.Tell();
+	header.frameCount = m_FrameCount;
+	file.WriteArray(m_CompressedFrames.data(), m_CompressedFrames.size());
+
+	header.flags = m_Flags;
+
+	file.Seek(0, SEEK_SET);
+	file.WriteBytes(&header, sizeof(FileHeader));
+
+	return file.Close();
+}
+
 void FifoDataFile::PadFile(size_t numBytes, File::IOFile& file)
 {
 	for (size_t i = 0; i < numBytes; ++i)
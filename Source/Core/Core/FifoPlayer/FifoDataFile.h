@@ -4,16 +4,19 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
-
-namespace File
-{
-class IOFile;
-}
+#include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
+#include "Core/FifoPlayer/FifoFileStruct.h"
 
 struct MemoryUpdate
 {
@@ -54,12 +57,21 @@ public:
 		TEX_MEM_SIZE = 1024 * 1024,
 	};
 
+	// Frames a recording may be ahead of the writer, and decompressed frames cached per thread
+	static const size_t QUEUE_LIMIT = 8;
+	static const size_t FRAME_CACHE_SIZE = 2;
+
 	FifoDataFile();
 	~FifoDataFile();
 
 	void SetIsWii(bool isWii);
 	bool GetIsWii() const;
 	bool HasBrokenEFBCopies() const;
+	bool IsCompressed() const;
+
+	// Makes the file compressed. Added frames are compressed and written to filename by a worker
+	// thread instead of being kept in memory. Must be called before adding frames.
+	bool StartStreaming(const std::string& filename);
 
 	u32* GetBPMem() { return m_BPMem; }
 	u32* GetCPMem() { return m_CPMem; }
@@ -67,8 +79,13 @@ public:
 	u32* GetXFRegs() { return m_XFRegs; }
 	u8* GetTexMem() { return m_TexMem; }
 	void AddFrame(const FifoFrameInfo& frameInfo);
-	const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
-	u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
+	// Frames of compressed files are decompressed on demand. The result stays valid until the
+	// calling thread has got FRAME_CACHE_SIZE other frames of compressed files.
+	const FifoFrameInfo& GetFrame(u32 frame) const;
+	u32 GetFrameCount() const { return m_FrameCount; }
+	// Totals over the added frames
+	u64 GetFifoDataSize() const { return m_FifoDataSize; }
+	u64 GetMemoryUpdateSize() const { return m_MemoryUpdateSize; }
 	bool Save(const std::string& filename);
 
 	static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
@@ -76,7 +93,8 @@ public:
 private:
 	enum
 	{
-		FLAG_IS_WII = 1
+		FLAG_IS_WII = 1,
+		FLAG_COMPRESSED = 2,
 	};
 
 	void PadFile(size_t numBytes, File::IOFile& file);
@@ -88,6 +106,16 @@ private:
 	static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
 		std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
 
+	bool SaveCompressed(const std::string& filename);
+	void StopWriter();
+	void WriterThread();
+	FifoFileStruct::CompressedBlock WriteBlock(const u8* data, u32 size);
+	FifoFileStruct::CompressedBlock WriteMemoryBlock(const std::vector<u8>& data);
+	// Whether a block the writer wrote holds data
+	bool BlockEquals(const FifoFileStruct::CompressedBlock& block, const std::vector<u8>& data);
+	bool ReadBlock(const FifoFileStruct::CompressedBlock& block, std::vector<u8>& data) const;
+	bool DecompressFrame(u32 frame, FifoFrameInfo& frameInfo) const;
+
 	u32 m_BPMem[BP_MEM_SIZE];
 	u32 m_CPMem[CP_MEM_SIZE];
 	u32 m_XFMem[XF_MEM_SIZE];
@@ -98,4 +126,32 @@ private:
 	u32 m_Version;
 
 	std::vector<FifoFrameInfo> m_Frames;
+	u32 m_FrameCount = 0;
+	u64 m_FifoDataSize = 0;
+	u64 m_MemoryUpdateSize = 0;
+
+	// Compressed files keep their frames in m_BackingFile, see FifoFileStruct
+	const u64 m_Id;
+	mutable File::IOFile m_BackingFile;
+	std::string m_BackingFilename;
+	mutable std::mutex m_MappingLock;
+	mutable Common::MappedFile m_Mapping;
+
+	// Guarded by m_WriterLock once the writer is running
+	std::vector<FifoFileStruct::CompressedBlock> m_CompressedFrames;
+	u64 m_DataEnd = 0;
+
+	std::thread m_Writer;
+	mutable std::mutex m_WriterLock;
+	mutable std::condition_variable m_FrameWritten;
+	std::condition_variable m_FrameQueued;
+	std::deque<FifoFrameInfo> m_Queue;
+	bool m_QuitWriter = false;
+
+	// Only used by the writer
+	std::unordered_map<u64, FifoFileStruct::CompressedBlock> m_MemoryBlocks;
+	std::vector<u8> m_FrameBuffer;
+	std::vector<u8> m_CompressBuffer;
+	std::vector<u8> m_CompareBuffer;
+	std::vector<u8> m_DecompressBuffer;
 };
@@ -11,8 +11,10 @@ namespace FifoFileStruct
 enum
 {
 	FILE_ID = 0x0d01f1f0,
-	VERSION_NUMBER = 4,
+	VERSION_NUMBER = 5,
 	MIN_LOADER_VERSION = 1,
+	// Compressed files were added in version 5
+	MIN_COMPRESSED_LOADER_VERSION = 5,
 };
 
 #pragma pack(push, 4)
@@ -64,5 +66,33 @@ struct FileMemoryUpdate
 	u8 type;
 };
 
+// Compressed files have a list of frameCount CompressedBlocks at frameListOffset instead of
+// FileFrameInfos. Blocks are compressed with LZO1X, or stored as they are if that doesn't make them
+// smaller (compressedSize == size).
+struct CompressedBlock
+{
+	u64 offset;
+	u32 compressedSize;
+	u32 size;
+};
+
+// Start of a frame block, followed by the FIFO data and the memory updates
+struct CompressedFrameHeader
+{
+	u32 fifoDataSize;
+	u32 fifoStart;
+	u32 fifoEnd;
+	u32 numMemoryUpdates;
+};
+
+// Memory updates with identical data share the block
+struct CompressedMemoryUpdate
+{
+	u32 fifoPosition;
+	u32 address;
+	CompressedBlock data;
+	u8 type;
+};
+
 #pragma pack(pop)
 }
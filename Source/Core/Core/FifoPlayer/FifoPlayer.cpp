@@ -9,8 +9,12 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/FifoPlayer/FifoAnalyzer.h"
 #include "Core/FifoPlayer/FifoDataFile.h"
@@ -24,6 +28,7 @@
 #include "Core/PowerPC/PowerPC.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/PhaseProfiler.h"
 
 // We need to include TextureDecoder.h for the texMem array.
 // TODO: Move texMem somewhere else so this isn't an issue.
@@ -77,9 +82,17 @@ public:
 
 		m_parent->m_CurrentFrame = m_parent->m_FrameRangeStart;
 		m_parent->LoadMemory();
+
+		if (m_parent->m_BenchmarkLoops)
+			m_parent->StartBenchmark();
 	}
 
-	void Shutdown() override { IsPlayingBackFifologWithBrokenEFBCopies = false; }
+	void Shutdown() override
+	{
+		// Also reports a benchmark that was stopped early
+		m_parent->FinishBenchmark();
+		IsPlayingBackFifologWithBrokenEFBCopies = false;
+	}
 	void ClearCache() override
 	{
 		// Nothing to clear.
@@ -120,8 +133,18 @@ int FifoPlayer::AdvanceFrame()
 {
 	if (m_CurrentFrame >= m_FrameRangeEnd)
 	{
-		if (!m_Loop)
+		if (m_BenchmarkRunning)
+		{
+			if (++m_BenchmarkLoopsDone >= m_BenchmarkLoops)
+			{
+				FinishBenchmark();
+				return CPU::CPU_POWERDOWN;
+			}
+		}
+		else if (!m_Loop)
+		{
 			return CPU::CPU_POWERDOWN;
+		}
 		// If there are zero frames in the range then sleep instead of busy spinning
 		if (m_FrameRangeStart >= m_FrameRangeEnd)
 			return CPU::CPU_STEPPING;
@@ -144,9 +167,52 @@ int FifoPlayer::AdvanceFrame()
 	WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
 
 	++m_CurrentFrame;
+	if (m_BenchmarkRunning)
+		++m_BenchmarkFrames;
 	return CPU::CPU_RUNNING;
 }
 
+void FifoPlayer::StartBenchmark()
+{
+	m_BenchmarkLoopsDone = 0;
+	m_BenchmarkFrames = 0;
+	m_BenchmarkReport.clear();
+	m_BenchmarkRunning = true;
+
+	// Run as fast as possible instead of pacing frames to the VI rate
+	Core::SetIsThrottlerTempDisabled(true);
+
+	PhaseProfiler::Reset();
+	PhaseProfiler::SetEnabled(true);
+	m_BenchmarkStartUs = Common::Timer::GetTimeUs();
+}
+
+void FifoPlayer::FinishBenchmark()
+{
+	if (!m_BenchmarkRunning)
+		return;
+	m_BenchmarkRunning = false;
+
+	// WriteFrame() waits for the GPU to go idle, so all the work of the last frame is done here
+	const u64 elapsed_us = std::max<u64>(Common::Timer::GetTimeUs() - m_BenchmarkStartUs, 1);
+	PhaseProfiler::SetEnabled(false);
+	Core::SetIsThrottlerTempDisabled(false);
+
+	const double seconds = elapsed_us / 1000000.0;
+	const u32 frames = std::max<u32>(m_BenchmarkFrames, 1);
+	m_BenchmarkReport = StringFromFormat("FIFO benchmark: %u frames (%u loops) in %.3f s, %.2f FPS, %.3f ms/frame\n",
+		m_BenchmarkFrames, m_BenchmarkLoopsDone, seconds, m_BenchmarkFrames / seconds,
+		elapsed_us / 1000.0 / frames);
+	for (int i = 0; i < PhaseProfiler::NUM_PHASES; ++i)
+	{
+		const PhaseProfiler::Phase phase = static_cast<PhaseProfiler::Phase>(i);
+		const u64 phase_ns = PhaseProfiler::GetTimeNs(phase);
+		m_BenchmarkReport += StringFromFormat("  %-20s %9.3f ms/frame %6.2f%%\n", PhaseProfiler::GetName(phase),
+			phase_ns / 1000000.0 / frames, phase_ns / 10.0 / elapsed_us);
+	}
+	NOTICE_LOG(VIDEO, "%s", m_BenchmarkReport.c_str());
+}
+
 std::unique_ptr<CPUCoreBase> FifoPlayer::GetCPUCore()
 {
 	if (!m_File || m_File->GetFrameCount() == 0)
@@ -207,7 +273,9 @@ FifoPlayer& FifoPlayer::GetInstance()
 
 FifoPlayer::FifoPlayer()
 	: m_CurrentFrame(0), m_FrameRangeStart(0), m_FrameRangeEnd(0), m_ObjectRangeStart(0),
-	m_ObjectRangeEnd(10000), m_EarlyMemoryUpdates(false), m_FileLoadedCb(nullptr),
+	m_ObjectRangeEnd(10000), m_EarlyMemoryUpdates(false), m_BenchmarkLoops(0),
+	m_BenchmarkLoopsDone(0), m_BenchmarkFrames(0), m_BenchmarkStartUs(0), m_BenchmarkRunning(false),
+	m_FileLoadedCb(nullptr),
 	m_FrameWrittenCb(nullptr), m_File(nullptr)
 {
 	m_Loop = SConfig::GetInstance().bLoopFifoReplay;
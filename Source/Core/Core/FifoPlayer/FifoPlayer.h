@@ -84,6 +84,11 @@ public:
 	// If enabled then all memory updates happen at once before the first frame
 	// Default is disabled
 	void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+	// Benchmark mode: plays the frame range the given number of times with the frame limiter
+	// disabled, times the video pipeline and then stops emulation. 0 disables it.
+	void SetBenchmarkLoops(u32 loops) { m_BenchmarkLoops = loops; }
+	// Results of the last benchmark run, empty if none has completed
+	const std::string& GetBenchmarkReport() const { return m_BenchmarkReport; }
 	// Callbacks
 	void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
 	void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
@@ -96,6 +101,9 @@ private:
 
 	int AdvanceFrame();
 
+	void StartBenchmark();
+	void FinishBenchmark();
+
 	void WriteFrame(const FifoFrameInfo& frame, const AnalyzedFrameInfo& info);
 	void WriteFramePart(u32 dataStart, u32 dataEnd, u32& nextMemUpdate, const FifoFrameInfo& frame,
 		const AnalyzedFrameInfo& info);
@@ -139,6 +147,13 @@ private:
 
 	bool m_EarlyMemoryUpdates;
 
+	u32 m_BenchmarkLoops;
+	u32 m_BenchmarkLoopsDone;
+	u32 m_BenchmarkFrames;
+	u64 m_BenchmarkStartUs;
+	bool m_BenchmarkRunning;
+	std::string m_BenchmarkReport;
+
 	u64 m_CyclesPerFrame;
 	u32 m_ElapsedCycles;
 	u32 m_FrameFifoSize;
@@ -7,6 +7,7 @@
 
 #include "Core/FifoPlayer/FifoRecorder.h"
 
+#include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 #include "Core/ConfigManager.h"
@@ -20,8 +21,7 @@ static std::recursive_mutex sMutex;
 FifoRecorder::FifoRecorder()
 	: m_IsRecording(false), m_WasRecording(false), m_RequestedRecordingEnd(false),
 	m_RecordFramesRemaining(0), m_FinishedCb(nullptr), m_File(nullptr), m_SkipNextData(true),
-	m_SkipFutureData(true), m_FrameEnded(false), m_Ram(Memory::RAM_SIZE),
-	m_ExRam(Memory::EXRAM_SIZE)
+	m_SkipFutureData(true), m_FrameEnded(false)
 {
 }
 
@@ -39,10 +39,10 @@ void FifoRecorder::StartRecording(s32 numFrames, CallbackFunc finishedCb)
 	FifoAnalyzer::Init();
 
 	m_File = new FifoDataFile;
-	std::fill(m_Ram.begin(), m_Ram.end(), 0);
-	std::fill(m_ExRam.begin(), m_ExRam.end(), 0);
 
 	m_File->SetIsWii(SConfig::GetInstance().bWii);
+	if (SConfig::GetInstance().bCompressFifoLogs)
+		m_File->StartStreaming(File::GetUserPath(D_CACHE_IDX) + "FifoRecording.tmp");
 
 	if (!m_IsRecording)
 	{
@@ -100,6 +100,13 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
 	}
 
 	m_SkipNextData = m_SkipFutureData;
+
+	// Recording stopped, UseMemory won't be called until the next one starts in EndFrame
+	if (m_SkipNextData && !m_Ram.empty())
+	{
+		std::vector<u8>().swap(m_Ram);
+		std::vector<u8>().swap(m_ExRam);
+	}
 }
 
 void FifoRecorder::UseMemory(u32 address, u32 size, MemoryUpdate::Type type, bool dynamicUpdate)
@@ -171,6 +178,11 @@ void FifoRecorder::EndFrame(u32 fifoStart, u32 fifoEnd)
 
 		m_FifoData.reserve(1024 * 1024 * 4);
 		m_FifoData.clear();
+
+		// Shadow copies of the memory, which is all recorded as it's used. Only allocated while
+		// recording, and on the video thread like their use.
+		m_Ram.assign(Memory::RAM_SIZE, 0);
+		m_ExRam.assign(Memory::EXRAM_SIZE, 0);
 	}
 
 	if (m_RequestedRecordingEnd)
@@ -415,31 +415,50 @@ void AXUCode::ProcessPBList(u32 pb_addr)
 	// 32KHz to 48KHz, but AX always process at 32KHz.
 	const u32 spms = 32;
 
+	AXBuffers buffers = { { m_samples_left, m_samples_right, m_samples_surround, m_samples_auxA_left,
+		m_samples_auxA_right, m_samples_auxA_surround, m_samples_auxB_left,
+		m_samples_auxB_right, m_samples_auxB_surround } };
+
+	// A frame is processed in steps of one millisecond, each with its own updates
+	auto update_pb = [this](AXPB& pb, u32 curr_ms) {
+		u16* updates = (u16*)HLEMemory_Get_Pointer(HILO_TO_32(pb.updates.data));
+		ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
+	};
+	auto mix_pb = [this](AXPB& pb, AXBuffers voice_buffers, u32 curr_ms) {
+		// Forward the buffers
+		for (size_t i = 0; i < ArraySize(voice_buffers.ptrs); ++i)
+			voice_buffers.ptrs[i] += curr_ms * spms;
+
+		ProcessVoice(pb, voice_buffers, spms, ConvertMixerControl(pb.mixer_control),
+			m_coeffs_available ? m_coeffs : nullptr);
+	};
+
+	if (SConfig::GetInstance().bDSPHLEParallelVoices)
+	{
+		auto check_pb = [](const AXPB& pb) {
+			u32 updates_count = 0;
+			for (u16 num_updates : pb.updates.num_updates)
+				updates_count += num_updates;
+			u16* updates = (u16*)HLEMemory_Get_Pointer(HILO_TO_32(pb.updates.data));
+			return !UpdatesChangePBList(updates, updates_count);
+		};
+		static const u32 buffer_sizes[] = { 5 * spms, 5 * spms, 5 * spms, 5 * spms, 5 * spms,
+			5 * spms, 5 * spms, 5 * spms, 5 * spms };
+		if (ProcessPBListParallel(pb_addr, buffers, buffer_sizes, 5 * spms, 5, check_pb, update_pb,
+			mix_pb))
+			return;
+	}
+
 	AXPB pb;
 
 	while (pb_addr)
 	{
-		AXBuffers buffers = { { m_samples_left, m_samples_right, m_samples_surround, m_samples_auxA_left,
-			m_samples_auxA_right, m_samples_auxA_surround, m_samples_auxB_left,
-			m_samples_auxB_right, m_samples_auxB_surround } };
-
 		ReadPB(pb_addr, pb);
-
-		u32 updates_addr = HILO_TO_32(pb.updates.data);
-		u16* updates = (u16*)HLEMemory_Get_Pointer(updates_addr);
-
-		for (int curr_ms = 0; curr_ms < 5; ++curr_ms)
+		for (u32 curr_ms = 0; curr_ms < 5; ++curr_ms)
 		{
-			ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
-
-			ProcessVoice(pb, buffers, spms, ConvertMixerControl(pb.mixer_control),
-				m_coeffs_available ? m_coeffs : nullptr);
-
-			// Forward the buffers
-			for (size_t i = 0; i < ArraySize(buffers.ptrs); ++i)
-				buffers.ptrs[i] += spms;
+			update_pb(pb, curr_ms);
+			mix_pb(pb, buffers, curr_ms);
 		}
-
 		WritePB(pb_addr, pb);
 		pb_addr = HILO_TO_32(pb.next_pb);
 	}
@@ -12,10 +12,15 @@
 #error AXVoice.h included without specifying version
 #endif
 
-#include <functional>
+#include <algorithm>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+#include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
+#include "Common/Swap.h"
+#include "Common/ThreadPool.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
@@ -117,46 +122,50 @@ void DumpPB(const PB_TYPE& pb)
 }
 #endif
 
-// Simulated accelerator state.
-static u32 acc_loop_addr, acc_end_addr;
-static u32* acc_cur_addr;
-static PB_TYPE* acc_pb;
-static bool acc_end_reached;
+// Simulated accelerator state. Kept per voice so that voices can be processed
+// on several threads.
+struct Accelerator
+{
+	u32 loop_addr, end_addr;
+	u32* cur_addr;
+	PB_TYPE* pb;
+	bool end_reached;
+};
 
 // Sets up the simulated accelerator.
-void AcceleratorSetup(PB_TYPE* pb, u32* cur_addr)
+void AcceleratorSetup(Accelerator* acc, PB_TYPE* pb, u32* cur_addr)
 {
-	acc_pb = pb;
-	acc_loop_addr = HILO_TO_32(pb->audio_addr.loop_addr);
-	acc_end_addr = HILO_TO_32(pb->audio_addr.end_addr);
-	acc_cur_addr = cur_addr;
-	acc_end_reached = false;
+	acc->pb = pb;
+	acc->loop_addr = HILO_TO_32(pb->audio_addr.loop_addr);
+	acc->end_addr = HILO_TO_32(pb->audio_addr.end_addr);
+	acc->cur_addr = cur_addr;
+	acc->end_reached = false;
 }
 
 // Reads a sample from the simulated accelerator. Also handles looping and
 // disabling streams that reached the end (this is done by an exception raised
 // by the accelerator on real hardware).
-u16 AcceleratorGetSample()
+u16 AcceleratorGetSample(Accelerator* acc)
 {
 	u16 ret;
 	u8 step_size_bytes = 0;
 
-	// See below for explanations about acc_end_reached.
-	if (acc_end_reached)
+	// See below for explanations about end_reached.
+	if (acc->end_reached)
 		return 0;
 
-	switch (acc_pb->audio_addr.sample_format)
+	switch (acc->pb->audio_addr.sample_format)
 	{
 	case 0x00:  // ADPCM
 	{
 		// ADPCM decoding, not much to explain here.
-		if ((*acc_cur_addr & 15) == 0)
+		if ((*acc->cur_addr & 15) == 0)
 		{
-			acc_pb->adpcm.pred_scale = DSP::ReadARAM((*acc_cur_addr & ~15) >> 1);
-			*acc_cur_addr += 2;
+			acc->pb->adpcm.pred_scale = DSP::ReadARAM((*acc->cur_addr & ~15) >> 1);
+			*acc->cur_addr += 2;
 		}
 
-		switch (acc_end_addr & 15)
+		switch (acc->end_addr & 15)
 		{
 		case 0:  // Tom and Jerry
 			step_size_bytes = 1;
@@ -169,47 +178,47 @@ u16 AcceleratorGetSample()
 			break;
 		}
 
-		int scale = 1 << (acc_pb->adpcm.pred_scale & 0xF);
-		int coef_idx = (acc_pb->adpcm.pred_scale >> 4) & 0x7;
+		int scale = 1 << (acc->pb->adpcm.pred_scale & 0xF);
+		int coef_idx = (acc->pb->adpcm.pred_scale >> 4) & 0x7;
 
-		s32 coef1 = acc_pb->adpcm.coefs[coef_idx * 2 + 0];
-		s32 coef2 = acc_pb->adpcm.coefs[coef_idx * 2 + 1];
+		s32 coef1 = acc->pb->adpcm.coefs[coef_idx * 2 + 0];
+		s32 coef2 = acc->pb->adpcm.coefs[coef_idx * 2 + 1];
 
-		int temp = (*acc_cur_addr & 1) ? (DSP::ReadARAM(*acc_cur_addr >> 1) & 0xF) :
-			(DSP::ReadARAM(*acc_cur_addr >> 1) >> 4);
+		int temp = (*acc->cur_addr & 1) ? (DSP::ReadARAM(*acc->cur_addr >> 1) & 0xF) :
+			(DSP::ReadARAM(*acc->cur_addr >> 1) >> 4);
 
 		if (temp >= 8)
 			temp -= 16;
 
 		int val =
-			(scale * temp) + ((0x400 + coef1 * acc_pb->adpcm.yn1 + coef2 * acc_pb->adpcm.yn2) >> 11);
+			(scale * temp) + ((0x400 + coef1 * acc->pb->adpcm.yn1 + coef2 * acc->pb->adpcm.yn2) >> 11);
 		val = MathUtil::Clamp(val, -0x7FFF, 0x7FFF);
 
-		acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
-		acc_pb->adpcm.yn1 = val;
-		*acc_cur_addr += 1;
+		acc->pb->adpcm.yn2 = acc->pb->adpcm.yn1;
+		acc->pb->adpcm.yn1 = val;
+		*acc->cur_addr += 1;
 		ret = val;
 		break;
 	}
 
 	case 0x0A:  // 16-bit PCM audio
-		ret = (DSP::ReadARAM(*acc_cur_addr * 2) << 8) | DSP::ReadARAM(*acc_cur_addr * 2 + 1);
-		acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
-		acc_pb->adpcm.yn1 = ret;
+		ret = (DSP::ReadARAM(*acc->cur_addr * 2) << 8) | DSP::ReadARAM(*acc->cur_addr * 2 + 1);
+		acc->pb->adpcm.yn2 = acc->pb->adpcm.yn1;
+		acc->pb->adpcm.yn1 = ret;
 		step_size_bytes = 2;
-		*acc_cur_addr += 1;
+		*acc->cur_addr += 1;
 		break;
 
 	case 0x19:  // 8-bit PCM audio
-		ret = DSP::ReadARAM(*acc_cur_addr) << 8;
-		acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
-		acc_pb->adpcm.yn1 = ret;
+		ret = DSP::ReadARAM(*acc->cur_addr) << 8;
+		acc->pb->adpcm.yn2 = acc->pb->adpcm.yn1;
+		acc->pb->adpcm.yn1 = ret;
 		step_size_bytes = 2;
-		*acc_cur_addr += 1;
+		*acc->cur_addr += 1;
 		break;
 
 	default:
-		ERROR_LOG(DSPHLE, "Unknown sample format: %d", acc_pb->audio_addr.sample_format);
+		ERROR_LOG(DSPHLE, "Unknown sample format: %d", acc->pb->audio_addr.sample_format);
 		return 0;
 	}
 
@@ -217,47 +226,47 @@ u16 AcceleratorGetSample()
 	//
 	// On real hardware, this would raise an interrupt that is handled by the
 	// UCode. We simulate what this interrupt does here.
-	if (*acc_cur_addr == (acc_end_addr + step_size_bytes - 1))
+	if (*acc->cur_addr == (acc->end_addr + step_size_bytes - 1))
 	{
 		// loop back to loop_addr.
-		*acc_cur_addr = acc_loop_addr;
+		*acc->cur_addr = acc->loop_addr;
 
-		if (acc_pb->audio_addr.looping)
+		if (acc->pb->audio_addr.looping)
 		{
 			// Set the ADPCM infos to continue processing at loop_addr.
 			//
 			// For some reason, yn1 and yn2 aren't set if the voice is not of
 			// stream type. This is what the AX UCode does and I don't really
 			// know why.
-			acc_pb->adpcm.pred_scale = acc_pb->adpcm_loop_info.pred_scale;
+			acc->pb->adpcm.pred_scale = acc->pb->adpcm_loop_info.pred_scale;
 			if (SConfig::GetInstance().bRSHACK)
 			{
-				acc_pb->adpcm.yn1 = acc_pb->adpcm_loop_info.yn1;
-				acc_pb->adpcm.yn2 = acc_pb->adpcm_loop_info.yn2;
-				if (acc_pb->is_stream)
+				acc->pb->adpcm.yn1 = acc->pb->adpcm_loop_info.yn1;
+				acc->pb->adpcm.yn2 = acc->pb->adpcm_loop_info.yn2;
+				if (acc->pb->is_stream)
 				{
 					// HORRIBLE HACK: this behavior changed between versions at some point; needs some sort
 					// of branch. delroth says anyone who submits this code as a serious PR will be banned
 					// from Dolphin.
 					// needed for RS2
-					acc_pb->lpf.enabled += 1;
+					acc->pb->lpf.enabled += 1;
 					// needed for RS3
-					acc_pb->padding[0] += 1;
+					acc->pb->padding[0] += 1;
 				}
 			}
 			else
 			{
-				if (!acc_pb->is_stream)
+				if (!acc->pb->is_stream)
 				{
-					acc_pb->adpcm.yn1 = acc_pb->adpcm_loop_info.yn1;
-					acc_pb->adpcm.yn2 = acc_pb->adpcm_loop_info.yn2;
+					acc->pb->adpcm.yn1 = acc->pb->adpcm_loop_info.yn1;
+					acc->pb->adpcm.yn2 = acc->pb->adpcm_loop_info.yn2;
 				}
 			}
 		}
 		else
 		{
 			// Non looping voice reached the end -> running = 0.
-			acc_pb->running = 0;
+			acc->pb->running = 0;
 
 #ifdef AX_WII
 			// One of the few meaningful differences between AXGC and AXWii:
@@ -265,7 +274,7 @@ u16 AcceleratorGetSample()
 			// samples at the loop address, AXWii has the 0000 samples
 			// internally in DRAM and use an internal pointer to it (loop addr
 			// does not contain 0000 samples on AXWii!).
-			acc_end_reached = true;
+			acc->end_reached = true;
 #endif
 		}
 	}
@@ -293,7 +302,10 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
+//
+// The callback is a template parameter so that it gets inlined in the loops.
+template <typename InputCallback>
+u32 ResampleAudio(InputCallback input_callback, s16* output, u32 count, s16* last_samples,
 	u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
 {
 	int read_samples_count = 0;
@@ -413,12 +425,13 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
 void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 {
 	u32 cur_addr = HILO_TO_32(pb.audio_addr.cur_addr);
-	AcceleratorSetup(&pb, &cur_addr);
+	Accelerator acc;
+	AcceleratorSetup(&acc, &pb, &cur_addr);
 
 	if (coeffs)
 		coeffs += pb.coef_select * 0x200;
 	u32 curr_pos =
-		ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count, pb.src.last_samples,
+		ResampleAudio([&acc](u32) { return AcceleratorGetSample(&acc); }, samples, count, pb.src.last_samples,
 			pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type, coeffs);
 	pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
@@ -427,30 +440,67 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 	pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
 }
 
+#ifdef _M_X86
+// Multiplies eight samples by eight unsigned 1.15 volumes, clamping the
+// results the same way as the scalar code does.
+inline __m128i ScaleSamples(__m128i samples, __m128i volumes)
+{
+	// pmulhw treats the volumes as signed: add the missing samples * 0x10000
+	// back to the high half for volumes >= 0x8000.
+	const __m128i lo = _mm_mullo_epi16(samples, volumes);
+	const __m128i hi = _mm_add_epi16(_mm_mulhi_epi16(samples, volumes),
+		_mm_and_si128(samples, _mm_srai_epi16(volumes, 15)));
+	const __m128i prod_lo = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+	const __m128i prod_hi = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+	return _mm_max_epi16(_mm_packs_epi32(prod_lo, prod_hi), _mm_set1_epi16(-32767));
+}
+#endif
+
+// Multiplies samples by a volume which changes by <volume_delta> after each
+// sample. Returns the volume after the last sample.
+u16 ApplyVolume(s16* out, const s16* input, u32 count, u16 volume, u16 volume_delta)
+{
+	u32 i = 0;
+
+#ifdef _M_X86
+	__m128i volumes = _mm_add_epi16(_mm_set1_epi16((s16)volume),
+		_mm_mullo_epi16(_mm_set1_epi16((s16)volume_delta), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7)));
+	const __m128i volumes_step = _mm_set1_epi16((s16)(volume_delta * 8));
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i samples = _mm_loadu_si128((const __m128i*)(input + i));
+		_mm_storeu_si128((__m128i*)(out + i), ScaleSamples(samples, volumes));
+		volumes = _mm_add_epi16(volumes, volumes_step);
+	}
+	volume += volume_delta * i;
+#endif
+
+	for (; i < count; ++i)
+	{
+		s32 sample = ((s32)input[i] * volume) >> 15;
+		out[i] = MathUtil::Clamp(sample, -32767, 32767);  // -32768 ?
+		volume += volume_delta;
+	}
+
+	return volume;
+}
+
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
-	u16& volume = pvol[0];
-	u16 volume_delta = pvol[1];
-
 	// If volume ramping is disabled, set volume_delta to 0. That way, the
-	// mixing loop can avoid testing if volume ramping is enabled at each step,
+	// volume code can avoid testing if volume ramping is enabled at each step,
 	// and just add volume_delta.
-	if (!ramp)
-		volume_delta = 0;
+	u16 volume_delta = ramp ? pvol[1] : 0;
 
-	for (u32 i = 0; i < count; ++i)
-	{
-		s64 sample = input[i];
-		sample *= volume;
-		sample >>= 15;
-		sample = MathUtil::Clamp((s32)sample, -32767, 32767);  // -32768 ?
+	s16 samples[MAX_SAMPLES_PER_FRAME];
+	pvol[0] = ApplyVolume(samples, input, count, pvol[0], volume_delta);
 
-		out[i] += (s16)sample;
-		volume += volume_delta;
+	for (u32 i = 0; i < count; ++i)
+		out[i] += samples[i];
 
-		*dpop = (s16)sample;
-	}
+	if (count)
+		*dpop = samples[count - 1];
 }
 
 // Execute a low pass filter on the samples using one history value. Returns
@@ -476,12 +526,8 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	GetInputSamples(pb, samples, count, coeffs);
 
 	// Apply a global volume ramp using the volume envelope parameters.
-	for (u32 i = 0; i < count; ++i)
-	{
-		samples[i] = MathUtil::Clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767,
-			32767);  // -32768 ?
-		pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-	}
+	pb.vol_env.cur_volume =
+		ApplyVolume(samples, samples, count, pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
 
 	// Optionally, execute a low pass filter
 	// TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -596,6 +642,122 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 #endif
 }
 
+#ifdef AX_WII
+// Moves the buffers past the samples of one millisecond, for the old AXWii
+// versions which process voices ms per ms. The Wii Remote buffers, which come
+// after the 12 main and aux ones, only get 6 samples per millisecond.
+void ForwardBuffersOneMs(AXBuffers& buffers)
+{
+	for (size_t i = 0; i < ArraySize(buffers.ptrs); ++i)
+		buffers.ptrs[i] += i < 12 ? 32 : 6;
+}
+#endif
+
+// Voice lists longer than this are processed serially. This also stops
+// ProcessPBListParallel on lists which loop back to an earlier PB.
+const size_t MAX_PARALLEL_VOICES = 256;
+
+// Whether updates applied with ApplyUpdatesForMs would write to the link to
+// the next PB, or outside of the PB.
+inline bool UpdatesChangePBList(const u16* updates, u32 count)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		u16 update_off = Common::swap16(updates[2 * i]);
+		if (update_off < 2 || update_off >= sizeof(PB_TYPE) / sizeof(u16))
+			return true;
+	}
+	return false;
+}
+
+// Processes the voices of a PB list on the thread pool, one step of the frame
+// at a time. Before each step the updates of that step are applied to all PBs
+// on the calling thread. The voices are then split between the threads, which
+// mix them to their own buffers. Those are added to <buffers> in order once the
+// frame is done, which gives the same integer sums as mixing all voices
+// serially.
+//
+// <buffer_sizes> has the number of samples in each of <buffers>, at most
+// <samples_per_frame>.
+// <check_pb> returns false for a PB which can't be processed out of order.
+// <update_pb>(pb, step) applies the updates of a step to one PB.
+// <mix_pb>(pb, buffers, step) mixes a step of one PB to the given buffers,
+// which point at the start of the frame and are <samples_per_frame> samples
+// long.
+//
+// Returns false without writing anything if the list has to be processed
+// serially instead.
+template <typename CheckPB, typename UpdatePB, typename MixPB>
+bool ProcessPBListParallel(u32 pb_addr, const AXBuffers& buffers, const u32* buffer_sizes,
+	u32 samples_per_frame, u32 num_steps, CheckPB check_pb, UpdatePB update_pb, MixPB mix_pb)
+{
+	// Only used from the DSP thread.
+	static std::vector<u32> addresses;
+	static std::vector<PB_TYPE> pbs;
+	static std::vector<int> voice_samples;
+
+	addresses.clear();
+	pbs.clear();
+	while (pb_addr)
+	{
+		if (pbs.size() == MAX_PARALLEL_VOICES)
+			return false;
+
+		pbs.emplace_back();
+		ReadPB(pb_addr, pbs.back());
+		if (!check_pb(pbs.back()))
+			return false;
+
+		addresses.push_back(pb_addr);
+		pb_addr = HILO_TO_32(pbs.back().next_pb);
+	}
+
+	const size_t num_voices = pbs.size();
+	if (num_voices < 2)
+		return false;
+
+	const size_t num_buffers = ArraySize(buffers.ptrs);
+	const size_t num_chunks =
+		std::min(num_voices, Common::ThreadPool::GetWorkerThreadCount() + 1);
+	const size_t chunk_size = num_buffers * samples_per_frame;
+	voice_samples.assign(num_chunks * chunk_size, 0);
+
+	for (u32 step = 0; step < num_steps; ++step)
+	{
+		for (PB_TYPE& pb : pbs)
+			update_pb(pb, step);
+
+		Common::ThreadPool::ParallelFor(0, (s32)num_chunks, [&](s32 begin, s32 end) {
+			for (size_t chunk = begin; chunk < (size_t)end; ++chunk)
+			{
+				AXBuffers chunk_buffers;
+				for (size_t i = 0; i < num_buffers; ++i)
+					chunk_buffers.ptrs[i] = &voice_samples[chunk * chunk_size + i * samples_per_frame];
+
+				const size_t first_voice = chunk * num_voices / num_chunks;
+				const size_t last_voice = (chunk + 1) * num_voices / num_chunks;
+				for (size_t voice = first_voice; voice < last_voice; ++voice)
+					mix_pb(pbs[voice], chunk_buffers, step);
+			}
+		});
+	}
+
+	for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+	{
+		for (size_t i = 0; i < num_buffers; ++i)
+		{
+			const int* samples = &voice_samples[chunk * chunk_size + i * samples_per_frame];
+			for (u32 j = 0; j < buffer_sizes[i]; ++j)
+				buffers.ptrs[i][j] += samples[j];
+		}
+	}
+
+	for (size_t voice = 0; voice < num_voices; ++voice)
+		WritePB(addresses[voice], pbs[voice]);
+
+	return true;
+}
+
 }  // namespace
 }  // namespace HLE
 }  // namespace DSP
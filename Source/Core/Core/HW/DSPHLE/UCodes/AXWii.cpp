@@ -441,43 +441,74 @@ void AXWiiUCode::ReinjectUpdatesFields(AXPBWii& pb, u16* num_updates, u32 update
 
 void AXWiiUCode::ProcessPBList(u32 pb_addr)
 {
-	AXPBWii pb;
-
-	while (pb_addr)
-	{
-		AXBuffers buffers = { {m_samples_left,      m_samples_right,      m_samples_surround,
-													m_samples_auxA_left, m_samples_auxA_right, m_samples_auxA_surround,
-													m_samples_auxB_left, m_samples_auxB_right, m_samples_auxB_surround,
-													m_samples_auxC_left, m_samples_auxC_right, m_samples_auxC_surround,
-													m_samples_wm0,       m_samples_aux0,       m_samples_wm1,
-													m_samples_aux1,      m_samples_wm2,        m_samples_aux2,
-													m_samples_wm3,       m_samples_aux3} };
-
-		ReadPB(pb_addr, pb);
-
+	AXBuffers buffers = { {m_samples_left,      m_samples_right,      m_samples_surround,
+												m_samples_auxA_left, m_samples_auxA_right, m_samples_auxA_surround,
+												m_samples_auxB_left, m_samples_auxB_right, m_samples_auxB_surround,
+												m_samples_auxC_left, m_samples_auxC_right, m_samples_auxC_surround,
+												m_samples_wm0,       m_samples_aux0,       m_samples_wm1,
+												m_samples_aux1,      m_samples_wm2,        m_samples_aux2,
+												m_samples_wm3,       m_samples_aux3} };
+
+	// Old AXWii versions process voices ms per ms, applying the updates of each
+	// ms before mixing it. The updates data is moved out of their PBs meanwhile.
+	const u32 num_steps = m_old_axwii ? 3 : 1;
+	auto update_pb = [this](AXPBWii& pb, u32 curr_ms) {
 		u16 num_updates[3];
 		u16 updates[1024];
 		u32 updates_addr;
 		if (ExtractUpdatesFields(pb, num_updates, updates, &updates_addr))
 		{
-			for (int curr_ms = 0; curr_ms < 3; ++curr_ms)
-			{
-				ApplyUpdatesForMs(curr_ms, (u16*)&pb, num_updates, updates);
-				ProcessVoice(pb, buffers, 32, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
-					m_coeffs_available ? m_coeffs : nullptr);
-
-				// Forward the buffers
-				for (size_t i = 0; i < ArraySize(buffers.ptrs); ++i)
-					buffers.ptrs[i] += 32;
-			}
+			ApplyUpdatesForMs(curr_ms, (u16*)&pb, num_updates, updates);
+			ReinjectUpdatesFields(pb, num_updates, updates_addr);
+		}
+	};
+	auto mix_pb = [this](AXPBWii& pb, AXBuffers voice_buffers, u32 curr_ms) {
+		u16 num_updates[3];
+		u16 updates[1024];
+		u32 updates_addr;
+		if (ExtractUpdatesFields(pb, num_updates, updates, &updates_addr))
+		{
+			for (u32 i = 0; i < curr_ms; ++i)
+				ForwardBuffersOneMs(voice_buffers);
+			ProcessVoice(pb, voice_buffers, 32, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
+				m_coeffs_available ? m_coeffs : nullptr);
 			ReinjectUpdatesFields(pb, num_updates, updates_addr);
 		}
 		else
 		{
-			ProcessVoice(pb, buffers, 96, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
+			ProcessVoice(pb, voice_buffers, 96, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
 				m_coeffs_available ? m_coeffs : nullptr);
 		}
+	};
+
+	if (SConfig::GetInstance().bDSPHLEParallelVoices)
+	{
+		auto check_pb = [this](const AXPBWii& pb) {
+			AXPBWii extracted = pb;
+			u16 num_updates[3];
+			u16 updates[1024];
+			u32 updates_addr;
+			if (!ExtractUpdatesFields(extracted, num_updates, updates, &updates_addr))
+				return true;
+			return !UpdatesChangePBList(updates, num_updates[0] + num_updates[1] + num_updates[2]);
+		};
+		static const u32 buffer_sizes[] = { 96, 96, 96, 96, 96, 96, 96, 96, 96, 96,
+			96, 96, 18, 18, 18, 18, 18, 18, 18, 18 };
+		if (ProcessPBListParallel(pb_addr, buffers, buffer_sizes, 96, num_steps, check_pb, update_pb,
+			mix_pb))
+			return;
+	}
 
+	AXPBWii pb;
+
+	while (pb_addr)
+	{
+		ReadPB(pb_addr, pb);
+		for (u32 curr_ms = 0; curr_ms < num_steps; ++curr_ms)
+		{
+			update_pb(pb, curr_ms);
+			mix_pb(pb, buffers, curr_ms);
+		}
 		WritePB(pb_addr, pb);
 		pb_addr = HILO_TO_32(pb.next_pb);
 	}
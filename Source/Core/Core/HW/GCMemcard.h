@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/NandPaths.h"
@@ -291,7 +292,11 @@ public:
 	std::vector<GCMBlock> m_save_data;
 	std::vector<u16> m_used_blocks;
 	int UsesBlock(u16 blocknum);
+	void MarkBlockDirty(int index);
+	bool HasDirtyBlocks() const;
+	// The whole file needs to be written, m_dirty_blocks only has the changed m_save_data blocks
 	bool m_dirty;
+	std::vector<bool> m_dirty_blocks;
 	std::string m_filename;
 };
 
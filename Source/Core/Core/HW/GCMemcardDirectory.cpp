@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include <memory>
@@ -133,6 +134,7 @@ int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Region card
 GCMemcardDirectory::GCMemcardDirectory(const std::string& directory, int slot, u16 sizeMb,
 	bool shift_jis, DiscIO::Region card_region, int gameId)
 	: MemoryCardBase(slot, sizeMb), m_GameId(gameId), m_LastBlock(-1),
+	m_LastSave(-1), m_LastSaveBlock(-1),
 	m_hdr(slot, sizeMb, shift_jis), m_bat1(sizeMb), m_saves(0), m_SaveDirectory(directory),
 	m_exiting(false)
 {
@@ -329,6 +331,9 @@ s32 GCMemcardDirectory::Write(u32 destaddress, s32 length, const u8* srcaddress)
 	}
 
 	memcpy(m_LastBlockAddress + offset, srcaddress, length);
+	// The block may have been cached by a read, or by a write before the last flush
+	if (block >= MC_FST_BLOCKS)
+		m_saves[m_LastSave].MarkBlockDirty(m_LastSaveBlock);
 
 	l.unlock();
 	if (extra)
@@ -340,6 +345,7 @@ s32 GCMemcardDirectory::Write(u32 destaddress, s32 length, const u8* srcaddress)
 
 void GCMemcardDirectory::ClearBlock(u32 address)
 {
+	std::unique_lock<std::mutex> l(m_write_mutex);
 	if (address % BLOCK_SIZE)
 	{
 		PanicAlertT("GCMemcardDirectory: ClearBlock called with invalid block address");
@@ -463,11 +469,13 @@ inline s32 GCMemcardDirectory::SaveAreaRW(u32 block, bool writing)
 
 				if (writing)
 				{
-					m_saves[i].m_dirty = true;
+					m_saves[i].MarkBlockDirty(idx);
 				}
 
 				m_LastBlock = block;
 				m_LastBlockAddress = m_saves[i].m_save_data[idx].block;
+				m_LastSave = i;
+				m_LastSaveBlock = idx;
 				return m_LastBlock;
 			}
 		}
@@ -531,17 +539,36 @@ bool GCMemcardDirectory::SetUsedBlocks(int saveIndex)
 
 void GCMemcardDirectory::FlushToFile()
 {
-	std::unique_lock<std::mutex> l(m_write_mutex);
+	std::lock_guard<std::mutex> flush_lock(m_flush_mutex);
 	int errors = 0;
-	DEntry invalid;
+	for (const SaveFileWrite& write : GatherWrites())
+	{
+		if (!WriteSaveFile(write))
+			++errors;
+	}
+#if _WRITE_MC_HEADER
+	u8 mc[BLOCK_SIZE * MC_FST_BLOCKS];
+	Read(0, BLOCK_SIZE * MC_FST_BLOCKS, mc);
+	File::IOFile hdrfile(m_SaveDirectory + MC_HDR, "wb");
+	hdrfile.WriteBytes(mc, BLOCK_SIZE * MC_FST_BLOCKS);
+#endif
+}
+
+std::vector<GCMemcardDirectory::SaveFileWrite> GCMemcardDirectory::GatherWrites()
+{
+	std::unique_lock<std::mutex> l(m_write_mutex);
+
+	std::vector<SaveFileWrite> writes;
 	for (u16 i = 0; i < m_saves.size(); ++i)
 	{
-		if (m_saves[i].m_dirty)
+		GCIFile& save = m_saves[i];
+		if (save.m_dirty)
 		{
-			if (BE32(m_saves[i].m_gci_header.Gamecode) != 0xFFFFFFFF)
+			if (BE32(save.m_gci_header.Gamecode) != 0xFFFFFFFF)
 			{
-				m_saves[i].m_dirty = false;
-				if (m_saves[i].m_save_data.size() == 0)
+				save.m_dirty = false;
+				save.m_dirty_blocks.clear();
+				if (save.m_save_data.size() == 0)
 				{
 					// The save's header has been changed but the actual save blocks haven't been read/written
 					// to
@@ -550,9 +577,9 @@ void GCMemcardDirectory::FlushToFile()
 						"GCI header modified without corresponding save data changes");
 					continue;
 				}
-				if (m_saves[i].m_filename.empty())
+				if (save.m_filename.empty())
 				{
-					std::string defaultSaveName = m_SaveDirectory + m_saves[i].m_gci_header.GCI_FileName();
+					std::string defaultSaveName = m_SaveDirectory + save.m_gci_header.GCI_FileName();
 
 					// Check to see if another file is using the same name
 					// This seems unlikely except in the case of file corruption
@@ -564,42 +591,53 @@ void GCMemcardDirectory::FlushToFile()
 					if (File::Exists(defaultSaveName))
 						PanicAlertT("Failed to find new filename.\n%s\n will be overwritten",
 							defaultSaveName.c_str());
-					m_saves[i].m_filename = defaultSaveName;
+					save.m_filename = defaultSaveName;
 				}
-				File::IOFile GCI(m_saves[i].m_filename, "wb");
-				if (GCI)
-				{
-					GCI.WriteBytes(&m_saves[i].m_gci_header, DENTRY_SIZE);
-					GCI.WriteBytes(m_saves[i].m_save_data.data(), BLOCK_SIZE * m_saves[i].m_save_data.size());
 
-					if (GCI.IsGood())
-					{
-						Core::DisplayMessage(
-							StringFromFormat("Wrote save contents to %s", m_saves[i].m_filename.c_str()), 4000);
-					}
-					else
-					{
-						++errors;
-						Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
-							m_saves[i].m_filename.c_str()),
-							4000);
-						ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s",
-							m_saves[i].m_filename.c_str());
-					}
-				}
+				SaveFileWrite write;
+				write.type = SaveFileWrite::Type::Rewrite;
+				write.filename = save.m_filename;
+				write.header = save.m_gci_header;
+				write.ranges.emplace_back(0, save.m_save_data);
+				writes.push_back(std::move(write));
+			}
+			else if (save.m_filename.length() != 0)
+			{
+				save.m_dirty = false;
+				save.m_dirty_blocks.clear();
+
+				SaveFileWrite write;
+				write.type = SaveFileWrite::Type::Delete;
+				write.filename = save.m_filename;
+				writes.push_back(std::move(write));
+
+				save.m_filename.clear();
+				save.m_save_data.clear();
+				save.m_used_blocks.clear();
 			}
-			else if (m_saves[i].m_filename.length() != 0)
+		}
+		else if (save.HasDirtyBlocks())
+		{
+			// Only the blocks the game wrote, in as few writes as possible
+			SaveFileWrite write;
+			write.type = SaveFileWrite::Type::Update;
+			write.filename = save.m_filename;
+			const size_t num_blocks = std::min(save.m_dirty_blocks.size(), save.m_save_data.size());
+			for (size_t first = 0; first < num_blocks; ++first)
 			{
-				m_saves[i].m_dirty = false;
-				std::string& oldname = m_saves[i].m_filename;
-				std::string deletedname = oldname + ".deleted";
-				if (File::Exists(deletedname))
-					File::Delete(deletedname);
-				File::Rename(oldname, deletedname);
-				m_saves[i].m_filename.clear();
-				m_saves[i].m_save_data.clear();
-				m_saves[i].m_used_blocks.clear();
+				if (!save.m_dirty_blocks[first])
+					continue;
+				size_t last = first + 1;
+				while (last < num_blocks && save.m_dirty_blocks[last])
+					++last;
+				write.ranges.emplace_back(static_cast<u16>(first),
+					std::vector<GCMBlock>(save.m_save_data.begin() + first,
+						save.m_save_data.begin() + last));
+				first = last;
 			}
+			save.m_dirty_blocks.clear();
+			if (!write.filename.empty() && !write.ranges.empty())
+				writes.push_back(std::move(write));
 		}
 
 		// Unload the save data for any game that is not running
@@ -607,20 +645,52 @@ void GCMemcardDirectory::FlushToFile()
 		// simultaneously
 		// this ensures that the save data for all of the current games gci files are stored in the
 		// savestate
-		u32 gamecode = BE32(m_saves[i].m_gci_header.Gamecode);
-		if (gamecode != m_GameId && gamecode != 0xFFFFFFFF && m_saves[i].m_save_data.size())
+		u32 gamecode = BE32(save.m_gci_header.Gamecode);
+		if (gamecode != m_GameId && gamecode != 0xFFFFFFFF && save.m_save_data.size())
 		{
-			INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s",
-				m_saves[i].m_filename.c_str());
-			m_saves[i].m_save_data.clear();
+			INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s", save.m_filename.c_str());
+			save.m_save_data.clear();
 		}
 	}
-#if _WRITE_MC_HEADER
-	u8 mc[BLOCK_SIZE * MC_FST_BLOCKS];
-	Read(0, BLOCK_SIZE * MC_FST_BLOCKS, mc);
-	File::IOFile hdrfile(m_SaveDirectory + MC_HDR, "wb");
-	hdrfile.WriteBytes(mc, BLOCK_SIZE * MC_FST_BLOCKS);
-#endif
+	return writes;
+}
+
+bool GCMemcardDirectory::WriteSaveFile(const SaveFileWrite& write)
+{
+	if (write.type == SaveFileWrite::Type::Delete)
+	{
+		std::string deletedname = write.filename + ".deleted";
+		if (File::Exists(deletedname))
+			File::Delete(deletedname);
+		File::Rename(write.filename, deletedname);
+		return true;
+	}
+
+	// Updates rewrite blocks in place, the header and the size of the file are unchanged
+	File::IOFile GCI(write.filename, write.type == SaveFileWrite::Type::Rewrite ? "wb" : "r+b");
+	if (GCI)
+	{
+		if (write.type == SaveFileWrite::Type::Rewrite)
+			GCI.WriteBytes(&write.header, DENTRY_SIZE);
+		for (const auto& range : write.ranges)
+		{
+			GCI.Seek(DENTRY_SIZE + range.first * BLOCK_SIZE, SEEK_SET);
+			GCI.WriteBytes(range.second.data(), BLOCK_SIZE * range.second.size());
+		}
+
+		if (GCI.IsGood())
+		{
+			Core::DisplayMessage(StringFromFormat("Wrote save contents to %s", write.filename.c_str()),
+				4000);
+			return true;
+		}
+	}
+
+	Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
+		write.filename.c_str()),
+		4000);
+	ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s", write.filename.c_str());
+	return false;
 }
 
 void GCMemcardDirectory::DoState(PointerWrap& p)
@@ -678,10 +748,29 @@ int GCIFile::UsesBlock(u16 blocknum)
 	return -1;
 }
 
+void GCIFile::MarkBlockDirty(int index)
+{
+	if (m_dirty_blocks.size() <= static_cast<size_t>(index))
+		m_dirty_blocks.resize(index + 1);
+	m_dirty_blocks[index] = true;
+}
+
+bool GCIFile::HasDirtyBlocks() const
+{
+	return std::find(m_dirty_blocks.begin(), m_dirty_blocks.end(), true) != m_dirty_blocks.end();
+}
+
 void GCIFile::DoState(PointerWrap& p)
 {
 	p.DoPOD<DEntry>(m_gci_header);
-	p.Do(m_dirty);
+	// States only know whole files, changed blocks are rewritten with the file after loading
+	bool dirty = m_dirty || HasDirtyBlocks();
+	p.Do(dirty);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		m_dirty = dirty;
+		m_dirty_blocks.clear();
+	}
 	p.Do(m_filename);
 	int numBlocks = (int)m_save_data.size();
 	p.Do(numBlocks);
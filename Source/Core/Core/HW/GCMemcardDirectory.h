@@ -8,6 +8,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "Common/Event.h"
@@ -34,6 +35,24 @@ public:
 	void DoState(PointerWrap& p) override;
 
 private:
+	// A change to a save file, gathered under m_write_mutex and written to disk without it
+	struct SaveFileWrite
+	{
+		enum class Type
+		{
+			Rewrite,
+			Update,
+			Delete,
+		};
+		Type type;
+		std::string filename;
+		DEntry header;
+		// Runs of consecutive blocks, with the index of their first block in the save
+		std::vector<std::pair<u16, std::vector<GCMBlock>>> ranges;
+	};
+
+	std::vector<SaveFileWrite> GatherWrites();
+	bool WriteSaveFile(const SaveFileWrite& write);
 	int LoadGCI(const std::string& fileName, DiscIO::Region card_region, bool currentGameOnly);
 	inline s32 SaveAreaRW(u32 block, bool writing = false);
 	// s32 DirectoryRead(u32 offset, u32 length, u8* destaddress);
@@ -44,6 +63,9 @@ private:
 	u32 m_GameId;
 	s32 m_LastBlock;
 	u8* m_LastBlockAddress;
+	// Save and index in it of m_LastBlock when it's a save block, so every write can mark it dirty
+	s32 m_LastSave;
+	s32 m_LastSaveBlock;
 
 	Header m_hdr;
 	Directory m_dir1, m_dir2;
@@ -55,6 +77,8 @@ private:
 	const std::chrono::seconds flush_interval = std::chrono::seconds(1);
 	Common::Event m_flush_trigger;
 	std::mutex m_write_mutex;
+	// Keeps flushes in order
+	std::mutex m_flush_mutex;
 	Common::Flag m_exiting;
 	std::thread m_flush_thread;
 };
@@ -23,6 +23,8 @@
 #include "Core/HW/WII_IPC.h"
 #include "Core/IOS/IPC.h"
 #include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 #include "Core/WiiRoot.h"
 
@@ -34,6 +36,8 @@ void Init()
 	SystemTimers::PreInit();
 
 	State::Init();
+	Rewind::Init();
+	NetPlay::Init();
 
 	// Init the whole Hardware
 	AudioInterface::Init();
@@ -73,6 +77,7 @@ void Shutdown()
 	SerialInterface::Shutdown();
 	AudioInterface::Shutdown();
 
+	Rewind::Shutdown();
 	State::Shutdown();
 	CoreTiming::Shutdown();
 }
@@ -20,6 +20,8 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/SI/SI.h"
 #include "Core/HW/SystemTimers.h"
+#include "Core/NetPlayProto.h"
+#include "Core/Rewind.h"
 
 #include "DiscIO/Enums.h"
 
@@ -722,6 +724,7 @@ static void BeginField(FieldType field, u64 ticks)
 static void EndField()
 {
 	Core::VideoThrottle();
+	Rewind::FrameUpdate();
 }
 
 // Purpose: Send VI interrupt when triggered
@@ -731,6 +734,8 @@ void Update(u64 ticks)
 	if (s_half_line_of_next_si_poll == s_half_line_count)
 	{
 		SerialInterface::UpdateDevices();
+		if (NetPlay::IsNetPlayRunning())
+			NetPlay::OnSIPoll();
 		s_half_line_of_next_si_poll += SerialInterface::GetPollXLines();
 	}
 	if (s_half_line_count == s_even_field_first_hl)
@@ -146,6 +146,7 @@ const std::string hotkey_labels[] = {
 		_trans("Save Oldest State"),
 		_trans("Undo Load State"),
 		_trans("Undo Save State"),
+		_trans("Rewind"),
 		_trans("Save State"),
 		_trans("Load State"),
 		_trans("Reload Post-Processing Shaders"),
@@ -147,6 +147,7 @@ enum Hotkey
 	HK_SAVE_FIRST_STATE,
 	HK_UNDO_LOAD_STATE,
 	HK_UNDO_SAVE_STATE,
+	HK_REWIND,
 	HK_SAVE_STATE_FILE,
 	HK_LOAD_STATE_FILE,
 	HK_RELOAD_POSTPROCESS_SHADERS,
@@ -2,13 +2,17 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <iostream>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <unistd.h>
 
 #include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
@@ -16,16 +20,17 @@
 
 static std::unique_ptr<MemoryWatcher> s_memory_watcher;
 static CoreTiming::EventType* s_event;
-static const int MW_RATE = 600;  // Steps per second
+static int s_rate = 600;  // Steps per second
 
 static void MWCallback(u64 userdata, s64 cyclesLate)
 {
 	s_memory_watcher->Step();
-	CoreTiming::ScheduleEvent(SystemTimers::GetTicksPerSecond() / MW_RATE - cyclesLate, s_event);
+	CoreTiming::ScheduleEvent(SystemTimers::GetTicksPerSecond() / s_rate - cyclesLate, s_event);
 }
 
 void MemoryWatcher::Init()
 {
+	s_rate = std::max(SConfig::GetInstance().iMemoryWatcherRate, 1);
 	s_memory_watcher = std::make_unique<MemoryWatcher>();
 	s_event = CoreTiming::RegisterEvent("MemoryWatcher", MWCallback);
 	CoreTiming::ScheduleEvent(0, s_event);
@@ -38,11 +43,19 @@ void MemoryWatcher::Shutdown()
 }
 
 MemoryWatcher::MemoryWatcher()
+	: MemoryWatcher(File::GetUserPath(F_MEMORYWATCHERLOCATIONS_IDX),
+		File::GetUserPath(F_MEMORYWATCHERSOCKET_IDX),
+		SConfig::GetInstance().bMemoryWatcherBinary ? Mode::Binary : Mode::Text)
 {
-	m_running = false;
-	if (!LoadAddresses(File::GetUserPath(F_MEMORYWATCHERLOCATIONS_IDX)))
+}
+
+MemoryWatcher::MemoryWatcher(const std::string& locations_path, const std::string& socket_path,
+	Mode mode)
+	: m_mode(mode)
+{
+	if (!LoadAddresses(locations_path))
 		return;
-	if (!OpenSocket(File::GetUserPath(F_MEMORYWATCHERSOCKET_IDX)))
+	if (!OpenSocket(socket_path))
 		return;
 	m_running = true;
 }
@@ -62,23 +75,47 @@ bool MemoryWatcher::LoadAddresses(const std::string& path)
 	if (!locations)
 		return false;
 
+	std::vector<std::string> lines;
 	std::string line;
 	while (std::getline(locations, line))
-		ParseLine(line);
+		lines.push_back(line);
+
+	if (m_mode == Mode::Text)
+	{
+		// Sorted and each line once, empty ones included, like the address map text mode used to
+		// keep, so clients see the values in the same order as before
+		std::sort(lines.begin(), lines.end());
+		lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+	}
+	else
+	{
+		// Binary indices follow the file, without empty and repeated lines
+		std::set<std::string> seen;
+		auto skip = [&seen](const std::string& entry) {
+			return entry.empty() || !seen.insert(entry).second;
+		};
+		lines.erase(std::remove_if(lines.begin(), lines.end(), skip), lines.end());
+	}
 
+	m_chain_starts.push_back(0);
+	for (const std::string& entry : lines)
+		ParseLine(entry);
+
+	m_values.assign(m_lines.size(), 0);
+	m_packet.resize(2 + 2 * std::min(m_lines.size(), MAX_BINARY_ENTRIES));
 	return m_values.size() > 0;
 }
 
 void MemoryWatcher::ParseLine(const std::string& line)
 {
-	m_values[line] = 0;
-	m_addresses[line] = std::vector<u32>();
+	m_lines.push_back(line);
 
 	std::stringstream offsets(line);
 	offsets >> std::hex;
 	u32 offset;
 	while (offsets >> offset)
-		m_addresses[line].push_back(offset);
+		m_offsets.push_back(offset);
+	m_chain_starts.push_back(static_cast<u32>(m_offsets.size()));
 }
 
 bool MemoryWatcher::OpenSocket(const std::string& path)
@@ -91,19 +128,36 @@ bool MemoryWatcher::OpenSocket(const std::string& path)
 	return m_fd >= 0;
 }
 
-u32 MemoryWatcher::ChasePointer(const std::string& line)
+u32 MemoryWatcher::ChasePointer(size_t index) const
 {
 	u32 value = 0;
-	for (u32 offset : m_addresses[line])
-		value = Memory::Read_U32(value + offset);
+	const u32* offset = m_offsets.data() + m_chain_starts[index];
+	const u32* end = m_offsets.data() + m_chain_starts[index + 1];
+	for (; offset != end; ++offset)
+		value = Memory::Read_U32(value + *offset);
 	return value;
 }
 
-std::string MemoryWatcher::ComposeMessage(const std::string& line, u32 value)
+void MemoryWatcher::SendText(size_t index, u32 value)
+{
+	char hex_value[16];
+	snprintf(hex_value, sizeof(hex_value), "%x", value);
+	// Reuse the buffer so steady state steps don't allocate
+	m_text_message.assign(m_lines[index]);
+	m_text_message.push_back('\n');
+	m_text_message.append(hex_value);
+	sendto(m_fd, m_text_message.c_str(), m_text_message.size() + 1, 0,
+		reinterpret_cast<sockaddr*>(&m_addr), sizeof(m_addr));
+}
+
+void MemoryWatcher::SendBinary(u32 count)
 {
-	std::stringstream message_stream;
-	message_stream << line << '\n' << std::hex << value;
-	return message_stream.str();
+	m_packet[0] = m_step;
+	m_packet[1] = count;
+	// Don't stall the CPU thread if the reader falls behind, the step counter
+	// tells it that it missed an update.
+	sendto(m_fd, m_packet.data(), (2 + 2 * count) * sizeof(u32), MSG_DONTWAIT,
+		reinterpret_cast<sockaddr*>(&m_addr), sizeof(m_addr));
 }
 
 void MemoryWatcher::Step()
@@ -111,19 +165,31 @@ void MemoryWatcher::Step()
 	if (!m_running)
 		return;
 
-	for (auto& entry : m_values)
+	m_step++;
+	u32 count = 0;
+	for (size_t i = 0; i < m_values.size(); i++)
 	{
-		std::string address = entry.first;
-		u32& current_value = entry.second;
+		u32 new_value = ChasePointer(i);
+		if (new_value == m_values[i])
+			continue;
 
-		u32 new_value = ChasePointer(address);
-		if (new_value != current_value)
+		// Update the value
+		m_values[i] = new_value;
+		if (m_mode == Mode::Text)
 		{
-			// Update the value
-			current_value = new_value;
-			std::string message = ComposeMessage(address, new_value);
-			sendto(m_fd, message.c_str(), message.size() + 1, 0, reinterpret_cast<sockaddr*>(&m_addr),
-				sizeof(m_addr));
+			SendText(i, new_value);
+			continue;
+		}
+
+		m_packet[2 + 2 * count] = static_cast<u32>(i);
+		m_packet[3 + 2 * count] = new_value;
+		if (++count == MAX_BINARY_ENTRIES)
+		{
+			SendBinary(count);
+			count = 0;
 		}
 	}
+
+	if (count != 0)
+		SendBinary(count);
 }
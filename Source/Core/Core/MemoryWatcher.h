@@ -4,26 +4,53 @@
 
 #pragma once
 
-#include <map>
+#include <string>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <vector>
 
+#include "Common/CommonTypes.h"
+
 // MemoryWatcher reads a file containing in-game memory addresses and outputs
 // changes to those memory addresses to a unix domain socket as the game runs.
 //
 // The input file is a newline-separated list of hex memory addresses, without
 // the "0x". To follow pointers, separate addresses with a space. For example,
 // "ABCD EF" will watch the address at (*0xABCD) + 0xEF.
-// The output to the socket is two lines. The first is the address from the
-// input file, and the second is the new value in hex.
+//
+// In text mode the output to the socket is one datagram per changed value with
+// two lines. The first is the address from the input file, and the second is the
+// new value in hex. Values are sent in the sorted order of the addresses.
+//
+// In binary mode every step sends a single datagram with all the values that
+// changed, in host byte order:
+//   u32 step      incremented on every step, lets the reader detect dropped packets
+//   u32 count     number of entries that follow
+//   count times:
+//     u32 index   zero based index of the address among the watched ones, which are
+//                 the lines of the input file in order, without empty and repeated lines
+//     u32 value
+// Steps with more than MAX_BINARY_ENTRIES changes are split into several datagrams
+// with the same step number.
 class MemoryWatcher final
 {
 public:
+	enum class Mode
+	{
+		Text,
+		Binary
+	};
+
+	static constexpr size_t MAX_BINARY_ENTRIES = 4096;
+
 	MemoryWatcher();
+	MemoryWatcher(const std::string& locations_path, const std::string& socket_path, Mode mode);
 	~MemoryWatcher();
 	void Step();
 
+	bool IsRunning() const { return m_running; }
+	size_t GetWatchCount() const { return m_lines.size(); }
+
 	static void Init();
 	static void Shutdown();
 
@@ -32,16 +59,28 @@ private:
 	bool OpenSocket(const std::string& path);
 
 	void ParseLine(const std::string& line);
-	u32 ChasePointer(const std::string& line);
-	std::string ComposeMessage(const std::string& line, u32 value);
+	u32 ChasePointer(size_t index) const;
+	void SendText(size_t index, u32 value);
+	void SendBinary(u32 count);
 
-	bool m_running;
+	bool m_running = false;
+	Mode m_mode;
 
-	int m_fd;
+	int m_fd = -1;
 	sockaddr_un m_addr;
 
-	// Address as stored in the file -> list of offsets to follow
-	std::map<std::string, std::vector<u32>> m_addresses;
-	// Address as stored in the file -> current value
-	std::map<std::string, u32> m_values;
+	// Address as stored in the file, by index
+	std::vector<std::string> m_lines;
+	// Offsets of every pointer chain, stored back to back.
+	// The chain of index i is m_offsets[m_chain_starts[i]] .. m_offsets[m_chain_starts[i + 1]]
+	std::vector<u32> m_offsets;
+	std::vector<u32> m_chain_starts;
+	// Current value, by index
+	std::vector<u32> m_values;
+
+	u32 m_step = 0;
+	// Binary mode datagram, reused across steps
+	std::vector<u32> m_packet;
+	// Text mode message, reused across values
+	std::string m_text_message;
 };
@@ -9,6 +9,7 @@
 #include <mbedtls/config.h>
 #include <mbedtls/md.h>
 #include <mutex>
+#include <random>
 #include <thread>
 #include <vector>
 
@@ -35,6 +36,7 @@
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/USB/Bluetooth/WiimoteDevice.h"
 #include "Core/Movie.h"
+#include "Core/MovieStream.h"
 #include "Core/NetPlayProto.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/State.h"
@@ -59,6 +61,9 @@ static ControllerState s_padState;
 static DTMHeader tmpHeader;
 static u8* tmpInput = nullptr;
 static size_t tmpInputAllocated = 0;
+// Replaces tmpInput if m_StreamMovieInput was set when the movie started
+static bool s_bStreaming = false;
+static InputStream s_stream;
 static u64 s_currentByte = 0, s_totalBytes = 0;
 static u64 s_currentFrame = 0, s_totalFrames = 0;  // VI
 static u64 s_currentLagCount = 0;
@@ -116,6 +121,83 @@ static void EnsureTmpInputSize(size_t bound)
 	tmpInput = newTmpInput;
 }
 
+static void FreeTmpInput()
+{
+	delete[] tmpInput;
+	tmpInput = nullptr;
+	tmpInputAllocated = 0;
+}
+
+static std::string GetStreamFilename()
+{
+	return File::GetUserPath(D_STATESAVES_IDX) + "dtm.stream";
+}
+
+// Savestates of a streamed recording are only valid while it's open, so each one gets a new ID
+static u64 NewStreamID()
+{
+	std::random_device rd;
+	return (static_cast<u64>(rd()) << 32) | rd();
+}
+
+static bool HasInput()
+{
+	return s_bStreaming ? s_stream.IsOpen() : tmpInput != nullptr;
+}
+
+// NOTE: Host / CPU Thread
+// Writes input at s_currentByte, which becomes the end of the movie
+static void WriteInput(const void* data, size_t size)
+{
+	if (s_bStreaming)
+	{
+		// Recording continues in a copy of a played movie
+		if (s_stream.IsReadOnly() && !s_stream.MakeWritable(GetStreamFilename()))
+			PanicAlertT("Failed to create %s, the input will be lost.", GetStreamFilename().c_str());
+		s_stream.Write(s_currentByte, data, size);
+	}
+	else
+	{
+		EnsureTmpInputSize((size_t)(s_currentByte + size));
+		memcpy(&tmpInput[s_currentByte], data, size);
+	}
+	s_currentByte += size;
+	s_totalBytes = s_currentByte;
+}
+
+// NOTE: Host / CPU Thread
+static bool ReadInput(u64 offset, void* data, size_t size)
+{
+	if (offset + size > s_totalBytes)
+		return false;
+
+	if (s_bStreaming)
+		return s_stream.Read(offset, data, size);
+
+	memcpy(data, &tmpInput[offset], size);
+	return true;
+}
+
+// NOTE: Host Thread
+// Replaces the streamed input with the input of the movie file
+static void ReadStreamFromFile(File::IOFile& file, u64 size)
+{
+	if (s_stream.IsReadOnly() && !s_stream.MakeWritable(GetStreamFilename()))
+	{
+		PanicAlertT("Failed to create %s, the input will be lost.", GetStreamFilename().c_str());
+		return;
+	}
+
+	s_stream.Truncate(0);
+	std::vector<u8> buffer(InputStream::CHUNK_SIZE);
+	for (u64 offset = 0; offset < size; offset += buffer.size())
+	{
+		buffer.resize((size_t)std::min<u64>(size - offset, InputStream::CHUNK_SIZE));
+		file.ReadBytes(buffer.data(), buffer.size());
+		s_stream.Write(offset, buffer.data(), buffer.size());
+	}
+}
+
 static bool IsMovieHeader(u8 magic[4])
 {
 	return magic[0] == 'D' && magic[1] == 'T' && magic[2] == 'M' && magic[3] == 0x1A;
@@ -590,7 +672,17 @@ bool BeginRecordingInput(int controllers)
 
 	s_playMode = MODE_RECORDING;
 	s_author = SConfig::GetInstance().m_strMovieAuthor;
-	EnsureTmpInputSize(1);
+	s_bStreaming = SConfig::GetInstance().m_StreamMovieInput &&
+		s_stream.Create(GetStreamFilename(), NewStreamID());
+	if (s_bStreaming)
+	{
+		FreeTmpInput();
+	}
+	else
+	{
+		s_stream.Close();
+		EnsureTmpInputSize(1);
+	}
 
 	s_currentByte = s_totalBytes = 0;
 
@@ -855,10 +947,7 @@ void RecordInput(GCPadStatus* PadStatus, int controllerID)
 
 	CheckPadStatus(PadStatus, controllerID);
 
-	EnsureTmpInputSize((size_t)(s_currentByte + sizeof(ControllerState)));
-	memcpy(&tmpInput[s_currentByte], &s_padState, sizeof(ControllerState));
-	s_currentByte += sizeof(ControllerState);
-	s_totalBytes = s_currentByte;
+	WriteInput(&s_padState, sizeof(ControllerState));
 }
 
 // NOTE: CPU Thread
@@ -877,11 +966,8 @@ void RecordWiimote(int wiimote, u8* data, u8 size)
 		return;
 
 	InputUpdate();
-	EnsureTmpInputSize((size_t)(s_currentByte + size + 1));
-	tmpInput[s_currentByte++] = size;
-	memcpy(&(tmpInput[s_currentByte]), data, size);
-	s_currentByte += size;
-	s_totalBytes = s_currentByte;
+	WriteInput(&size, 1);
+	WriteInput(data, size);
 }
 
 // NOTE: EmuThread / Host Thread
@@ -962,8 +1048,18 @@ bool PlayInput(const std::string& filename)
 	Core::UpdateWantDeterminism();
 
 	s_totalBytes = g_recordfd.GetSize() - 256;
-	EnsureTmpInputSize((size_t)s_totalBytes);
-	g_recordfd.ReadArray(tmpInput, (size_t)s_totalBytes);
+	s_bStreaming =
+		SConfig::GetInstance().m_StreamMovieInput && s_stream.Open(filename, NewStreamID());
+	if (s_bStreaming)
+	{
+		FreeTmpInput();
+	}
+	else
+	{
+		s_stream.Close();
+		EnsureTmpInputSize((size_t)s_totalBytes);
+		g_recordfd.ReadArray(tmpInput, (size_t)s_totalBytes);
+	}
 	s_currentByte = 0;
 	g_recordfd.Close();
 
@@ -993,6 +1089,93 @@ void DoState(PointerWrap& p)
 	// other variables (such as s_totalBytes and s_totalFrames) are set in LoadInput
 }
 
+// NOTE: Host Thread
+static void SwitchModeAfterLoad(bool afterEnd)
+{
+	s_bSaveConfig = tmpHeader.bSaveConfig;
+
+	if (!afterEnd)
+	{
+		if (s_bReadOnly)
+		{
+			if (s_playMode != MODE_PLAYING)
+			{
+				s_playMode = MODE_PLAYING;
+				Core::UpdateWantDeterminism();
+				Core::DisplayMessage("Switched to playback", 2000);
+			}
+		}
+		else
+		{
+			if (s_playMode != MODE_RECORDING)
+			{
+				s_playMode = MODE_RECORDING;
+				Core::UpdateWantDeterminism();
+				Core::DisplayMessage("Switched to recording", 2000);
+			}
+		}
+	}
+	else
+	{
+		EndPlayInput(false);
+	}
+}
+
+// NOTE: Host Thread
+// Loads a savestate movie that refers to the start of the streamed input instead of copying it
+static void LoadInputReference(const std::string& filename)
+{
+	if (!s_bStreaming || tmpHeader.uniqueID != s_stream.GetID())
+	{
+		if (!s_bReadOnly || !HasInput())
+		{
+			PanicAlertT("Savestate movie %s refers to the input of a streamed recording that isn't "
+				"open anymore, movie recording stopping...",
+				filename.c_str());
+			EndPlayInput(false);
+			return;
+		}
+		Core::DisplayMessage("Savestate movie input is from another recording, it can't be verified",
+			4000);
+	}
+	else if (!s_stream.IsUnchangedSince(tmpHeader.inputGeneration, s_currentByte))
+	{
+		if (!s_bReadOnly)
+		{
+			PanicAlertT("The input of savestate movie %s was overwritten by a later rerecord, movie "
+				"recording stopping...",
+				filename.c_str());
+			EndPlayInput(false);
+			return;
+		}
+		PanicAlertT("Warning: You loaded a save whose movie input was overwritten by a later "
+			"rerecord. You should load another save before continuing. Otherwise you'll probably "
+			"get a desync.");
+	}
+
+	bool afterEnd = false;
+	if (!s_bReadOnly)
+	{
+		s_totalFrames = tmpHeader.frameCount;
+		s_totalLagCount = tmpHeader.lagCount;
+		s_totalInputCount = tmpHeader.inputCount;
+		s_totalTickCount = s_tickCountAtLastInput = tmpHeader.tickCount;
+		// The streamed input after the save is discarded as soon as recording continues
+		s_totalBytes = s_currentByte;
+	}
+	else if (s_currentByte > s_totalBytes)
+	{
+		afterEnd = true;
+		PanicAlertT("Warning: You loaded a save that's after the end of the current movie. (byte %u "
+			"> %u) (input %u > %u). You should load another save before continuing, or load "
+			"this state with read-only mode off.",
+			(u32)s_currentByte + 256, (u32)s_totalBytes + 256, (u32)s_currentInputCount,
+			(u32)s_totalInputCount);
+	}
+
+	SwitchModeAfterLoad(afterEnd);
+}
+
 // NOTE: Host Thread
 void LoadInput(const std::string& filename)
 {
@@ -1025,6 +1208,13 @@ void LoadInput(const std::string& filename)
 	if (SConfig::GetInstance().bWii)
 		ChangeWiiPads(true);
 
+	if (tmpHeader.bInputReference)
+	{
+		t_record.Close();
+		LoadInputReference(filename);
+		return;
+	}
+
 	u64 totalSavedBytes = t_record.GetSize() - 256;
 
 	bool afterEnd = false;
@@ -1038,16 +1228,23 @@ void LoadInput(const std::string& filename)
 		afterEnd = true;
 	}
 
-	if (!s_bReadOnly || tmpInput == nullptr)
+	if (!s_bReadOnly || !HasInput())
 	{
 		s_totalFrames = tmpHeader.frameCount;
 		s_totalLagCount = tmpHeader.lagCount;
 		s_totalInputCount = tmpHeader.inputCount;
 		s_totalTickCount = s_tickCountAtLastInput = tmpHeader.tickCount;
 
-		EnsureTmpInputSize((size_t)totalSavedBytes);
 		s_totalBytes = totalSavedBytes;
-		t_record.ReadArray(tmpInput, (size_t)s_totalBytes);
+		if (s_bStreaming)
+		{
+			ReadStreamFromFile(t_record, s_totalBytes);
+		}
+		else
+		{
+			EnsureTmpInputSize((size_t)totalSavedBytes);
+			t_record.ReadArray(tmpInput, (size_t)s_totalBytes);
+		}
 	}
 	else if (s_currentByte > 0)
 	{
@@ -1068,8 +1265,10 @@ void LoadInput(const std::string& filename)
 			// verify identical from movie start to the save's current frame
 			std::vector<u8> movInput(s_currentByte);
 			t_record.ReadArray(movInput.data(), movInput.size());
+			std::vector<u8> curInput(s_currentByte);
+			ReadInput(0, curInput.data(), curInput.size());
 
-			const auto result = std::mismatch(movInput.begin(), movInput.end(), tmpInput);
+			const auto result = std::mismatch(movInput.begin(), movInput.end(), curInput.begin());
 
 			if (result.first != movInput.end())
 			{
@@ -1088,13 +1287,15 @@ void LoadInput(const std::string& filename)
 						"read-only mode off. Otherwise you'll probably get a desync.",
 						byte_offset, byte_offset);
 
-					std::copy(movInput.begin(), movInput.end(), tmpInput);
+					// Streamed input can't be rewritten without discarding the rest of it
+					if (!s_bStreaming)
+						std::copy(movInput.begin(), movInput.end(), tmpInput);
 				}
 				else
 				{
 					const ptrdiff_t frame = mismatch_index / sizeof(ControllerState);
 					ControllerState curPadState;
-					memcpy(&curPadState, &tmpInput[frame * sizeof(ControllerState)], sizeof(ControllerState));
+					memcpy(&curPadState, &curInput[frame * sizeof(ControllerState)], sizeof(ControllerState));
 					ControllerState movPadState;
 					memcpy(&movPadState, &movInput[frame * sizeof(ControllerState)], sizeof(ControllerState));
 					PanicAlertT(
@@ -1129,33 +1330,7 @@ void LoadInput(const std::string& filename)
 	}
 	t_record.Close();
 
-	s_bSaveConfig = tmpHeader.bSaveConfig;
-
-	if (!afterEnd)
-	{
-		if (s_bReadOnly)
-		{
-			if (s_playMode != MODE_PLAYING)
-			{
-				s_playMode = MODE_PLAYING;
-				Core::UpdateWantDeterminism();
-				Core::DisplayMessage("Switched to playback", 2000);
-			}
-		}
-		else
-		{
-			if (s_playMode != MODE_RECORDING)
-			{
-				s_playMode = MODE_RECORDING;
-				Core::UpdateWantDeterminism();
-				Core::DisplayMessage("Switched to recording", 2000);
-			}
-		}
-	}
-	else
-	{
-		EndPlayInput(false);
-	}
+	SwitchModeAfterLoad(afterEnd);
 }
 
 // NOTE: CPU Thread
@@ -1173,7 +1348,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 {
 	// Correct playback is entirely dependent on the emulator polling the controllers
 	// in the same order done during recording
-	if (!IsPlayingInput() || !IsUsingPad(controllerID) || tmpInput == nullptr)
+	if (!IsPlayingInput() || !IsUsingPad(controllerID) || !HasInput())
 		return;
 
 	if (s_currentByte + sizeof(ControllerState) > s_totalBytes)
@@ -1190,7 +1365,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 	memset(PadStatus, 0, sizeof(GCPadStatus));
 	PadStatus->err = e;
 
-	memcpy(&s_padState, &tmpInput[s_currentByte], sizeof(ControllerState));
+	ReadInput(s_currentByte, &s_padState, sizeof(ControllerState));
 	s_currentByte += sizeof(ControllerState);
 
 	PadStatus->triggerLeft = s_padState.TriggerL;
@@ -1274,7 +1449,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf, int ext,
 	const wiimote_key key)
 {
-	if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || tmpInput == nullptr)
+	if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || !HasInput())
 		return false;
 
 	if (s_currentByte > s_totalBytes)
@@ -1287,7 +1462,8 @@ bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf,
 
 	u8 size = rptf.size;
 
-	u8 sizeInMovie = tmpInput[s_currentByte];
+	u8 sizeInMovie = 0;
+	ReadInput(s_currentByte, &sizeInMovie, 1);
 
 	if (size != sizeInMovie)
 	{
@@ -1311,7 +1487,7 @@ bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf,
 		return false;
 	}
 
-	memcpy(data, &(tmpInput[s_currentByte]), size);
+	ReadInput(s_currentByte, data, size);
 	s_currentByte += size;
 
 	s_currentInputCount++;
@@ -1356,12 +1532,8 @@ void EndPlayInput(bool cont)
 	}
 }
 
-// NOTE: Save State + Host Thread
-void SaveRecording(const std::string& filename)
+static void FillHeader(DTMHeader& header)
 {
-	File::IOFile save_record(filename, "wb");
-	// Create the real header now and write it
-	DTMHeader header;
 	memset(&header, 0, sizeof(DTMHeader));
 
 	header.filetype[0] = 'D';
@@ -1412,10 +1584,26 @@ void SaveRecording(const std::string& filename)
 	// TODO
 	header.uniqueID = 0;
 	// header.audioEmulator;
+}
 
-	save_record.WriteArray(&header, 1);
+// NOTE: Save State + Host Thread
+void SaveRecording(const std::string& filename)
+{
+	// Create the real header now and write it
+	DTMHeader header;
+	FillHeader(header);
 
-	bool success = save_record.WriteArray(tmpInput, (size_t)s_totalBytes);
+	bool success;
+	if (s_bStreaming)
+	{
+		success = s_stream.Save(filename, &header, s_totalBytes);
+	}
+	else
+	{
+		File::IOFile save_record(filename, "wb");
+		save_record.WriteArray(&header, 1);
+		success = save_record.WriteArray(tmpInput, (size_t)s_totalBytes);
+	}
 
 	if (success && s_bRecordingFromSaveState)
 	{
@@ -1429,6 +1617,27 @@ void SaveRecording(const std::string& filename)
 		Core::DisplayMessage(StringFromFormat("Failed to save %s", filename.c_str()), 2000);
 }
 
+// NOTE: Save State
+void SaveStateRecording(const std::string& filename)
+{
+	if (!s_bStreaming)
+	{
+		SaveRecording(filename);
+		return;
+	}
+
+	// Refer to the streamed input instead of copying it
+	DTMHeader header;
+	FillHeader(header);
+	header.uniqueID = s_stream.GetID();
+	header.bInputReference = true;
+	header.inputGeneration = s_stream.GetGeneration();
+
+	File::IOFile save_record(filename, "wb");
+	if (!save_record.WriteArray(&header, 1))
+		Core::DisplayMessage(StringFromFormat("Failed to save %s", filename.c_str()), 2000);
+}
+
 void SetGCInputManip(GCManipFunction func)
 {
 	gcmfunc = func;
@@ -1569,8 +1778,8 @@ void Shutdown()
 {
 	s_currentInputCount = s_totalInputCount = s_totalFrames = s_totalBytes = s_tickCountAtLastInput =
 		0;
-	delete[] tmpInput;
-	tmpInput = nullptr;
-	tmpInputAllocated = 0;
+	FreeTmpInput();
+	s_stream.Close();
+	s_bStreaming = false;
 }
 };
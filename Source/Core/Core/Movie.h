@@ -100,8 +100,10 @@ struct DTMHeader
 	u8 revision[20];    // Git hash
 	u32 DSPiromHash;
 	u32 DSPcoefHash;
-	u64 tickCount;     // Number of ticks in the recording
-	u8 reserved2[11];  // Make heading 256 bytes, just because we can
+	u64 tickCount;         // Number of ticks in the recording
+	bool bInputReference;  // Savestate movie whose input is in the streamed recording uniqueID
+	u32 inputGeneration;   // Generation of that recording's input when the savestate was made
+	u8 reserved2[6];       // Make heading 256 bytes, just because we can
 };
 static_assert(sizeof(DTMHeader) == 256, "DTMHeader should be 256 bytes");
 
@@ -169,6 +171,7 @@ bool PlayWiimote(int wiimote, u8* data, const struct WiimoteEmu::ReportFeatures&
 	const wiimote_key key);
 void EndPlayInput(bool cont);
 void SaveRecording(const std::string& filename);
+void SaveStateRecording(const std::string& filename);
 void DoState(PointerWrap& p);
 void CheckMD5();
 void GetMD5();
@@ -0,0 +1,319 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/MovieStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+
+namespace Movie
+{
+InputStream::~InputStream()
+{
+	Close();
+}
+
+bool InputStream::Create(const std::string& filename, u64 id)
+{
+	Close();
+
+	const u8 header[HEADER_SIZE] = {};
+	if (!m_file.Open(filename, "w+b") || !m_file.WriteArray(header, HEADER_SIZE) ||
+		!m_file.Flush())
+	{
+		ERROR_LOG(COMMON, "Failed to create the movie input stream %s", filename.c_str());
+		m_file.Close();
+		return false;
+	}
+
+	m_filename = filename;
+	m_read_only = false;
+	m_id = id;
+	m_size = m_written = 0;
+	StartWriter();
+	return true;
+}
+
+bool InputStream::Open(const std::string& filename, u64 id)
+{
+	Close();
+
+	if (!m_file.Open(filename, "rb") || m_file.GetSize() < HEADER_SIZE)
+	{
+		ERROR_LOG(COMMON, "Failed to open the movie input stream %s", filename.c_str());
+		m_file.Close();
+		return false;
+	}
+
+	m_filename = filename;
+	m_read_only = true;
+	m_id = id;
+	m_size = m_written = m_file.GetSize() - HEADER_SIZE;
+	return true;
+}
+
+bool InputStream::MakeWritable(const std::string& filename)
+{
+	if (!m_read_only)
+		return true;
+
+	File::IOFile copy;
+	if (!copy.Open(filename, "w+b") || !CopyTo(copy, nullptr, m_size) || !copy.Flush())
+	{
+		ERROR_LOG(COMMON, "Failed to copy the movie input stream to %s", filename.c_str());
+		return false;
+	}
+
+	m_mapping.Unmap();
+	m_file.Swap(copy);
+	m_filename = filename;
+	m_read_only = false;
+	StartWriter();
+	return true;
+}
+
+bool InputStream::Save(const std::string& filename, const void* header, u64 size)
+{
+	if (size > m_size)
+		return false;
+
+	Flush();
+	if (filename == m_filename)
+	{
+		// Rewrites the header of the movie being played, and drops the input after size. The mapping
+		// goes first, like in Truncate.
+		m_mapping.Unmap();
+		File::IOFile file(filename, "r+b");
+		if (!file.WriteBytes(header, HEADER_SIZE) || !file.Resize(HEADER_SIZE + size))
+			return false;
+		if (size < m_size)
+			Truncated(size);
+		return true;
+	}
+
+	File::IOFile file(filename, "wb");
+	return file && CopyTo(file, header, size);
+}
+
+bool InputStream::CopyTo(File::IOFile& file, const void* header, u64 size)
+{
+	if (m_mapping.GetSize() < HEADER_SIZE + size && !Map(m_size))
+		return false;
+
+	const u8* data = m_mapping.GetData();
+	if (!file.WriteBytes(header ? header : data, HEADER_SIZE))
+		return false;
+	for (u64 offset = 0; offset < size; offset += CHUNK_SIZE)
+	{
+		const size_t count = (size_t)std::min<u64>(size - offset, CHUNK_SIZE);
+		if (!file.WriteBytes(data + HEADER_SIZE + offset, count))
+			return false;
+	}
+	return true;
+}
+
+void InputStream::Close()
+{
+	StopWriter();
+	m_mapping.Unmap();
+	m_file.Close();
+	m_filename.clear();
+	m_read_only = true;
+	m_generation = 0;
+	m_size = m_written = 0;
+	m_truncations.clear();
+	m_chunk.clear();
+}
+
+void InputStream::StartWriter()
+{
+	m_quit = false;
+	m_writer = std::thread(&InputStream::WriterThread, this);
+}
+
+void InputStream::StopWriter()
+{
+	if (!m_writer.joinable())
+		return;
+
+	SubmitChunk();
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_quit = true;
+	}
+	m_work_available.notify_one();
+	m_writer.join();
+}
+
+void InputStream::WriterThread()
+{
+	Common::SetCurrentThreadName("Movie Input Writer");
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true)
+	{
+		// Drain the queue before quitting, nothing may be lost
+		m_work_available.wait(lk, [this] { return m_quit || !m_queue.empty(); });
+		if (m_queue.empty())
+			break;
+
+		std::vector<u8> chunk = std::move(m_queue.front());
+		m_queue.pop_front();
+		const u64 offset = m_written;
+		m_busy = true;
+		lk.unlock();
+
+		// Flushed too, so that it can be seen through the mapping
+		const bool success = m_file.Seek(HEADER_SIZE + offset, SEEK_SET) &&
+			m_file.WriteBytes(chunk.data(), chunk.size()) && m_file.Flush();
+		if (!success)
+			ERROR_LOG(COMMON, "Failed to write to the movie input stream %s", m_filename.c_str());
+
+		lk.lock();
+		m_written += chunk.size();
+		chunk.clear();
+		m_spare_chunks.push_back(std::move(chunk));
+		m_busy = false;
+		m_work_done.notify_all();
+	}
+}
+
+void InputStream::SubmitChunk()
+{
+	if (m_chunk.empty())
+		return;
+
+	std::vector<u8> next;
+	{
+		std::unique_lock<std::mutex> lk(m_mutex);
+		m_work_done.wait(lk, [this] { return m_queue.size() < QUEUE_LIMIT; });
+		m_queue.push_back(std::move(m_chunk));
+		if (!m_spare_chunks.empty())
+		{
+			next = std::move(m_spare_chunks.back());
+			m_spare_chunks.pop_back();
+		}
+	}
+	m_work_available.notify_one();
+
+	m_chunk = std::move(next);
+	m_chunk.reserve(CHUNK_SIZE);
+}
+
+void InputStream::Flush()
+{
+	if (!m_writer.joinable())
+		return;
+
+	SubmitChunk();
+	std::unique_lock<std::mutex> lk(m_mutex);
+	m_work_done.wait(lk, [this] { return m_queue.empty() && !m_busy; });
+}
+
+void InputStream::Write(u64 offset, const void* data, size_t size)
+{
+	if (m_read_only)
+		return;
+
+	if (offset < m_size)
+	{
+		Truncate(offset);
+	}
+	else if (offset > m_size)
+	{
+		WARN_LOG(COMMON, "Movie input written at %llu, past its end at %llu, filling the gap with zeros",
+			(unsigned long long)offset, (unsigned long long)m_size);
+		const std::vector<u8> zeros(CHUNK_SIZE);
+		while (m_size < offset)
+			Append(zeros.data(), (size_t)std::min<u64>(offset - m_size, CHUNK_SIZE));
+	}
+
+	Append(static_cast<const u8*>(data), size);
+}
+
+void InputStream::Append(const u8* bytes, size_t size)
+{
+	while (size > 0)
+	{
+		const size_t count = std::min(size, CHUNK_SIZE - m_chunk.size());
+		m_chunk.insert(m_chunk.end(), bytes, bytes + count);
+		if (m_chunk.size() == CHUNK_SIZE)
+			SubmitChunk();
+		bytes += count;
+		size -= count;
+		m_size += count;
+	}
+}
+
+void InputStream::Truncate(u64 size)
+{
+	if (m_read_only || size > m_size)
+		return;
+
+	Flush();
+	// Windows can't shrink a mapped file, and anything else would fault on access past the end
+	m_mapping.Unmap();
+	if (!m_file.Resize(HEADER_SIZE + size))
+		ERROR_LOG(COMMON, "Failed to truncate the movie input stream %s", m_filename.c_str());
+	Truncated(size);
+}
+
+void InputStream::Truncated(u64 size)
+{
+	m_truncations.emplace_back(m_generation++, size);
+	m_size = size;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_written = size;
+}
+
+bool InputStream::Read(u64 offset, void* data, size_t size)
+{
+	if (offset + size > m_size)
+		return false;
+
+	if (HEADER_SIZE + offset + size > m_mapping.GetSize())
+	{
+		u64 written;
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			written = m_written;
+		}
+		if (offset + size > written)
+		{
+			Flush();
+			written = m_size;
+		}
+		if (!Map(written))
+			return false;
+	}
+
+	std::memcpy(data, m_mapping.GetData() + HEADER_SIZE + offset, size);
+	return true;
+}
+
+bool InputStream::IsUnchangedSince(u32 generation, u64 size) const
+{
+	if (size > m_size)
+		return false;
+
+	return std::none_of(m_truncations.begin(), m_truncations.end(),
+		[generation, size](const std::pair<u32, u64>& truncation) {
+		return truncation.first >= generation && truncation.second < size;
+	});
+}
+
+bool InputStream::Map(u64 size)
+{
+	if (m_mapping.Map(m_file, HEADER_SIZE + size))
+		return true;
+
+	ERROR_LOG(COMMON, "Failed to map the movie input stream %s", m_filename.c_str());
+	return false;
+}
+}
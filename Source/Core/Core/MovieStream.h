@@ -0,0 +1,112 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Movie input that lives in a .dtm file instead of memory.
+//
+// Appended input is gathered into chunks, which a writer thread appends to the file, so the CPU
+// thread only waits on the disk if the writer falls QUEUE_LIMIT chunks behind. Input is read back
+// through a read only mapping of the file that is extended as the file grows.
+//
+// Rewriting input (a rerecord) discards everything after it. Each time that happens the generation
+// is bumped, so savestates that refer to a prefix of the input can tell whether it is still there.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
+
+namespace Movie
+{
+class InputStream final
+{
+public:
+	// Size of the DTMHeader in front of the input
+	static const u64 HEADER_SIZE = 256;
+	static const size_t CHUNK_SIZE = 64 * 1024;
+	static const size_t QUEUE_LIMIT = 16;
+
+	InputStream() = default;
+	~InputStream();
+	InputStream(const InputStream&) = delete;
+	InputStream& operator=(const InputStream&) = delete;
+
+	// Starts an empty log in filename, behind a zeroed header.
+	bool Create(const std::string& filename, u64 id);
+	// Opens the .dtm filename for reading only.
+	bool Open(const std::string& filename, u64 id);
+	// Continues a read only log in a copy of its file, unless it's writable already.
+	bool MakeWritable(const std::string& filename);
+	// Writes a movie with header (HEADER_SIZE bytes) and the first size bytes of input. Saving to the
+	// stream's own file discards the input after size.
+	bool Save(const std::string& filename, const void* header, u64 size);
+	void Close();
+
+	bool IsOpen() const { return m_file.IsOpen(); }
+	bool IsReadOnly() const { return m_read_only; }
+	u64 GetID() const { return m_id; }
+	u32 GetGeneration() const { return m_generation; }
+	// Bytes of input, including those still waiting for the writer
+	u64 GetSize() const { return m_size; }
+	const std::string& GetFilename() const { return m_filename; }
+
+	// Writes size bytes at offset. Input after offset is discarded, a gap before it is filled with
+	// zeros.
+	void Write(u64 offset, const void* data, size_t size);
+	// Discards the input after size bytes.
+	void Truncate(u64 size);
+	bool Read(u64 offset, void* data, size_t size);
+	// Whether the first size bytes are the same as at generation.
+	bool IsUnchangedSince(u32 generation, u64 size) const;
+	// Returns once the writer has written all input to the file.
+	void Flush();
+
+private:
+	void StartWriter();
+	void StopWriter();
+	void WriterThread();
+	void SubmitChunk();
+	void Append(const u8* bytes, size_t size);
+	// Records that the input after size was discarded
+	void Truncated(u64 size);
+	// Needs all input to be in the file
+	bool CopyTo(File::IOFile& file, const void* header, u64 size);
+	// Maps the header and size bytes of input
+	bool Map(u64 size);
+
+	File::IOFile m_file;
+	std::string m_filename;
+	bool m_read_only = true;
+	u64 m_id = 0;
+	u32 m_generation = 0;
+	u64 m_size = 0;
+	// Generation each truncation started, and the size it truncated to
+	std::vector<std::pair<u32, u64>> m_truncations;
+
+	// Input that isn't queued for the writer yet
+	std::vector<u8> m_chunk;
+	// Chunks the writer is done with, reused to avoid allocations
+	std::vector<std::vector<u8>> m_spare_chunks;
+
+	std::thread m_writer;
+	std::mutex m_mutex;
+	std::condition_variable m_work_available;
+	std::condition_variable m_work_done;
+	std::deque<std::vector<u8>> m_queue;
+	bool m_quit = false;
+	bool m_busy = false;
+	// Bytes of input in the file, guarded by m_mutex
+	u64 m_written = 0;
+
+	Common::MappedFile m_mapping;
+};
+}
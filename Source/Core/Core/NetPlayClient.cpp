@@ -5,6 +5,7 @@
 #include "Core/NetPlayClient.h"
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <mbedtls/md5.h>
 #include <memory>
 #include <thread>
@@ -17,6 +18,8 @@
 #include "Common/StringUtil.h"
 #include "Common/Timer.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
 #include "Core/HW/EXI/EXI_DeviceIPL.h"
 #include "Core/HW/SI/SI.h"
 #include "Core/HW/SI/SI_DeviceGCController.h"
@@ -25,6 +28,7 @@
 #include "Core/HW/WiimoteReal/WiimoteReal.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/Movie.h"
+#include "Core/State.h"
 #include "InputCommon/GCAdapter.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
@@ -32,6 +36,7 @@
 
 static std::mutex crit_netplay_client;
 static NetPlayClient* netplay_client = nullptr;
+static CoreTiming::EventType* s_rollback_event;
 NetSettings g_NetPlaySettings;
 
 // called from ---GUI--- thread
@@ -809,6 +814,7 @@ bool NetPlayClient::StartGame(const std::string& path)
 	NetPlay_Enable(this);
 
 	ClearBuffers();
+	StartRollback();
 
 	if (m_dialog->IsRecording())
 	{
@@ -961,6 +967,9 @@ bool NetPlayClient::GetNetPads(const int pad_nb, GCPadStatus* pad_status)
 	// The slot number is the "local" pad number, and what player
 	// it actually means is the "in-game" pad number.
 
+	if (IsRollbackActive())
+		return GetRollbackPad(pad_nb, pad_status);
+
 	// When the 1st in-game pad is polled, we assume the others will
 	// will be polled as well. To reduce latency, we poll all local
 	// controllers at once and then send the status to the other
@@ -1023,6 +1032,336 @@ bool NetPlayClient::GetNetPads(const int pad_nb, GCPadStatus* pad_status)
 	return true;
 }
 
+static const u32 NO_MISPREDICTION = std::numeric_limits<u32>::max();
+
+static bool PadStatusMatches(const GCPadStatus& a, const GCPadStatus& b)
+{
+	// Only the fields that are sent over the network
+	return a.button == b.button && a.analogA == b.analogA && a.analogB == b.analogB &&
+		a.stickX == b.stickX && a.stickY == b.stickY && a.substickX == b.substickX &&
+		a.substickY == b.substickY && a.triggerLeft == b.triggerLeft &&
+		a.triggerRight == b.triggerRight;
+}
+
+// called from ---GUI--- thread, before the game boots
+void NetPlayClient::StartRollback()
+{
+	// Movies record every poll, resimulated ones included, so they don't mix with rollback
+	m_rollback = SConfig::GetInstance().bNetPlayRollback &&
+		SConfig::GetInstance().iNetPlayRollbackFrames > 0 && !m_dialog->IsRecording();
+	m_rollback_frames = std::max(SConfig::GetInstance().iNetPlayRollbackFrames, 1);
+
+	m_si_polls = 0;
+	m_resimulate_until = 0;
+	m_resimulating = false;
+	m_pad_polls.fill(0);
+	m_local_pads_sent.fill(0);
+	m_mispredicted_poll.fill(NO_MISPREDICTION);
+	m_history_base.fill(0);
+	for (int i = 0; i < 4; i++)
+	{
+		m_confirmed_pads[i].clear();
+		m_used_pads[i].clear();
+	}
+	m_snapshots.clear();
+	m_snapshots.resize(m_rollback ? m_rollback_frames + 1 : 0);
+	m_next_snapshot = 0;
+	m_pending_timebases.clear();
+}
+
+bool NetPlayClient::IsRollbackActive() const
+{
+	// Wii Remote data still goes through the blocking path, which can't be rolled back
+	return m_rollback && !SConfig::GetInstance().bWii;
+}
+
+// called from ---CPU--- thread
+// Local inputs are sent m_target_buffer_size polls ahead, once per poll. Resimulated polls reuse
+// what was sent back then.
+void NetPlayClient::PollLocalPads()
+{
+	const int num_local_pads = NumLocalPads();
+	for (int local_pad = 0; local_pad < num_local_pads; local_pad++)
+	{
+		const int ingame_pad = LocalPadToInGamePad(local_pad);
+		if (m_local_pads_sent[ingame_pad] > m_pad_polls[ingame_pad] + m_target_buffer_size)
+			continue;
+
+		GCPadStatus pad_status;
+		switch (SConfig::GetInstance().m_SIDevice[local_pad])
+		{
+		case SIDEVICE_WIIU_ADAPTER:
+			pad_status = GCAdapter::Input(local_pad);
+			break;
+		case SIDEVICE_GC_CONTROLLER:
+		default:
+			pad_status = Pad::GetStatus(local_pad);
+			break;
+		}
+
+		while (m_local_pads_sent[ingame_pad] <= m_pad_polls[ingame_pad] + m_target_buffer_size)
+		{
+			m_pad_buffer[ingame_pad].Push(pad_status);
+			SendPadState(ingame_pad, pad_status);
+			m_local_pads_sent[ingame_pad]++;
+		}
+	}
+}
+
+// called from ---CPU--- thread
+// Moves the received inputs into the history, checking them against the predictions that were
+// used for polls that already happened.
+void NetPlayClient::DrainPadBuffers()
+{
+	for (int pad = 0; pad < 4; pad++)
+	{
+		std::deque<GCPadStatus>& confirmed = m_confirmed_pads[pad];
+		const std::deque<GCPadStatus>& used = m_used_pads[pad];
+		GCPadStatus pad_status;
+		while (m_pad_buffer[pad].Pop(pad_status))
+		{
+			const size_t index = confirmed.size();
+			if (index < used.size() && !PadStatusMatches(used[index], pad_status))
+			{
+				m_mispredicted_poll[pad] =
+					std::min<u32>(m_mispredicted_poll[pad], m_history_base[pad] + static_cast<u32>(index));
+			}
+			confirmed.push_back(pad_status);
+		}
+	}
+}
+
+// called from ---CPU--- thread
+bool NetPlayClient::GetRollbackPad(const int pad_nb, GCPadStatus* pad_status)
+{
+	if (IsFirstInGamePad(pad_nb))
+		PollLocalPads();
+
+	DrainPadBuffers();
+
+	const u32 poll = m_pad_polls[pad_nb];
+	std::deque<GCPadStatus>& confirmed = m_confirmed_pads[pad_nb];
+	std::deque<GCPadStatus>& used = m_used_pads[pad_nb];
+
+	// Wait when there is nothing to predict from, or when predicting any further ahead would leave
+	// no snapshot to roll back to
+	while (confirmed.empty() || poll >= m_history_base[pad_nb] + confirmed.size() + m_rollback_frames)
+	{
+		if (!m_is_running.IsSet())
+			return false;
+
+		m_gc_pad_event.Wait();
+		DrainPadBuffers();
+	}
+
+	// Predict that the player keeps doing what they did last
+	const size_t index = poll - m_history_base[pad_nb];
+	*pad_status = index < confirmed.size() ? confirmed[index] : confirmed.back();
+
+	used.resize(index);
+	used.push_back(*pad_status);
+	m_pad_polls[pad_nb]++;
+
+	Movie::CheckPadStatus(pad_status, pad_nb);
+
+	return true;
+}
+
+// called from ---CPU--- thread
+// Loads the newest snapshot from before every mispredicted poll.
+void NetPlayClient::Rollback()
+{
+	RollbackSnapshot* target = nullptr;
+	for (RollbackSnapshot& snapshot : m_snapshots)
+	{
+		if (!snapshot.valid || (target && snapshot.si_poll < target->si_poll))
+			continue;
+
+		bool before_mispredictions = true;
+		for (int pad = 0; pad < 4; pad++)
+			before_mispredictions &= snapshot.pad_polls[pad] <= m_mispredicted_poll[pad];
+		if (before_mispredictions)
+			target = &snapshot;
+	}
+	m_mispredicted_poll.fill(NO_MISPREDICTION);
+
+	if (!target)
+	{
+		// GetRollbackPad never predicts further than the snapshots reach, but if it happens anyway
+		// this client has desynced for good, so end the game for everyone.
+		ERROR_LOG(NETPLAY, "Rollback: no snapshot before the mispredicted input");
+		OSD::AddMessage("Netplay rollback failed, stopping the game", 10000);
+		m_rollback = false;
+		SendStopGamePacket();
+		return;
+	}
+
+	State::LoadFromBufferOnCPUThread(target->state);
+
+	m_resimulate_until = std::max(m_resimulate_until, m_si_polls);
+	m_si_polls = target->si_poll + 1;
+	m_pad_polls = target->pad_polls;
+	for (int pad = 0; pad < 4; pad++)
+		m_used_pads[pad].resize(m_pad_polls[pad] - m_history_base[pad]);
+
+	// The frames after the snapshot are run again and report their timebases again
+	m_timebase_frame = target->timebase_frame;
+	m_pending_timebases.erase(
+		std::remove_if(m_pending_timebases.begin(), m_pending_timebases.end(),
+			[&](const std::pair<u32, u64>& entry) { return entry.first >= m_timebase_frame; }),
+		m_pending_timebases.end());
+
+	// Newer snapshots belong to the mispredicted timeline
+	for (RollbackSnapshot& snapshot : m_snapshots)
+	{
+		if (snapshot.si_poll > target->si_poll)
+			snapshot.valid = false;
+	}
+	m_next_snapshot = (target - m_snapshots.data() + 1) % m_snapshots.size();
+
+	if (!m_resimulating)
+	{
+		m_resimulating = true;
+		Core::SetIsThrottlerTempDisabled(true);
+	}
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::TrimRollbackHistory()
+{
+	for (int pad = 0; pad < 4; pad++)
+	{
+		std::deque<GCPadStatus>& confirmed = m_confirmed_pads[pad];
+		std::deque<GCPadStatus>& used = m_used_pads[pad];
+		if (confirmed.empty())
+			continue;
+
+		// Keep what the oldest snapshot may need, the inputs of the coming polls, and the last
+		// input to predict from
+		u32 keep = std::min(m_pad_polls[pad],
+			m_history_base[pad] + static_cast<u32>(confirmed.size()) - 1);
+		for (const RollbackSnapshot& snapshot : m_snapshots)
+		{
+			if (snapshot.valid)
+				keep = std::min(keep, snapshot.pad_polls[pad]);
+		}
+
+		while (m_history_base[pad] < keep)
+		{
+			confirmed.pop_front();
+			if (!used.empty())
+				used.pop_front();
+			m_history_base[pad]++;
+		}
+	}
+}
+
+// called from ---CPU--- thread
+bool NetPlayClient::HasUnconfirmedInputs() const
+{
+	for (int pad = 0; pad < 4; pad++)
+	{
+		if (m_used_pads[pad].size() > m_confirmed_pads[pad].size())
+			return true;
+	}
+	return false;
+}
+
+// called from ---CPU--- thread
+// Whether the input of a remote player for the next poll still has to be predicted. Only then can
+// the poll be rolled back, and a snapshot is needed before it.
+bool NetPlayClient::IsNextPollPredicted() const
+{
+	for (int pad = 0; pad < 4; pad++)
+	{
+		if (m_pad_map[pad] <= 0 || m_pad_map[pad] == m_local_player->pid)
+			continue;
+		if (m_pad_polls[pad] - m_history_base[pad] >= m_confirmed_pads[pad].size())
+			return true;
+	}
+	return false;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::QueueTimeBase(u64 timebase)
+{
+	m_pending_timebases.emplace_back(m_timebase_frame++, timebase);
+	if (!HasUnconfirmedInputs())
+		SendConfirmedTimeBases();
+}
+
+// called from ---CPU--- thread
+// Every input used so far is confirmed, so the queued timebases are final
+void NetPlayClient::SendConfirmedTimeBases()
+{
+	for (const std::pair<u32, u64>& entry : m_pending_timebases)
+	{
+		auto spac = std::make_unique<sf::Packet>();
+		*spac << static_cast<MessageId>(NP_MSG_TIMEBASE);
+		*spac << static_cast<u32>(entry.second);
+		*spac << static_cast<u32>(entry.second << 32);
+		*spac << entry.first;
+		SendAsync(std::move(spac));
+	}
+	m_pending_timebases.clear();
+}
+
+// called from ---CPU--- thread, right after the SI polled the controllers
+// The work is done from an event of its own rather than from the VI event, so that loading a
+// snapshot doesn't leave the VI in the middle of an update.
+void NetPlayClient::OnSIPoll()
+{
+	if (IsRollbackActive())
+		CoreTiming::ScheduleEvent(0, s_rollback_event, 0, CoreTiming::FromThread::CPU);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::OnRollbackEvent()
+{
+	if (!IsRollbackActive())
+		return;
+
+	DrainPadBuffers();
+
+	if (std::any_of(m_mispredicted_poll.begin(), m_mispredicted_poll.end(),
+		[](u32 poll) { return poll != NO_MISPREDICTION; }))
+	{
+		Rollback();
+		// The loaded snapshot was taken right here, nothing else to do for this poll
+		return;
+	}
+
+	if (!HasUnconfirmedInputs())
+	{
+		// Nothing that ran so far can be rolled back anymore
+		SendConfirmedTimeBases();
+		for (RollbackSnapshot& snapshot : m_snapshots)
+			snapshot.valid = false;
+	}
+
+	if (m_resimulating && m_si_polls >= m_resimulate_until)
+	{
+		m_resimulating = false;
+		Core::SetIsThrottlerTempDisabled(false);
+	}
+
+	// Snapshots pause the GPU and DSP threads, so they are only taken when the next poll can be
+	// rolled back. Most of the time the pad buffer gets the remote inputs here in time.
+	if (IsNextPollPredicted())
+	{
+		RollbackSnapshot& snapshot = m_snapshots[m_next_snapshot];
+		State::SaveToBufferOnCPUThread(snapshot.state);
+		snapshot.si_poll = m_si_polls;
+		snapshot.pad_polls = m_pad_polls;
+		snapshot.timebase_frame = m_timebase_frame;
+		snapshot.valid = true;
+		m_next_snapshot = (m_next_snapshot + 1) % m_snapshots.size();
+	}
+	m_si_polls++;
+
+	TrimRollbackHistory();
+}
+
 // called from ---CPU--- thread
 bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size, u8 reporting_mode)
 {
@@ -1198,6 +1537,14 @@ void NetPlayClient::SendTimeBase()
 
 	u64 timebase = SystemTimers::GetFakeTimeBase();
 
+	// Frames run on mispredicted inputs are rolled back, so they are only reported once they are
+	// known to be right
+	if (netplay_client->IsRollbackActive())
+	{
+		netplay_client->QueueTimeBase(timebase);
+		return;
+	}
+
 	auto spac = std::make_unique<sf::Packet>();
 	*spac << static_cast<MessageId>(NP_MSG_TIMEBASE);
 	*spac << static_cast<u32>(timebase);
@@ -1311,6 +1658,28 @@ bool NetPlay::IsNetPlayRunning()
 	return netplay_client != nullptr;
 }
 
+static void RollbackCallback(u64 userdata, s64 cycles_late)
+{
+	std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+	if (netplay_client)
+		netplay_client->OnRollbackEvent();
+}
+
+void NetPlay::Init()
+{
+	s_rollback_event = CoreTiming::RegisterEvent("NetPlayRollback", RollbackCallback);
+}
+
+// called from ---CPU--- thread
+void NetPlay::OnSIPoll()
+{
+	std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+	if (netplay_client)
+		netplay_client->OnSIPoll();
+}
+
 void NetPlay_Enable(NetPlayClient* const np)
 {
 	std::lock_guard<std::mutex> lk(crit_netplay_client);
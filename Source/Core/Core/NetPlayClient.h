@@ -6,11 +6,13 @@
 
 #include <SFML/Network/Packet.hpp>
 #include <array>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
@@ -86,6 +88,8 @@ public:
 	// Send and receive pads values
 	bool WiimoteUpdate(int _number, u8* data, const u8 size, u8 reporting_mode);
 	bool GetNetPads(int pad_nb, GCPadStatus* pad_status);
+	void OnSIPoll();
+	void OnRollbackEvent();
 
 	void OnTraversalStateChanged() override;
 	void OnConnectReady(ENetAddress addr) override;
@@ -164,6 +168,18 @@ private:
 	void DisplayPlayersPing();
 	u32 GetPlayersMaxPing() const;
 
+	bool IsRollbackActive() const;
+	void StartRollback();
+	bool GetRollbackPad(int pad_nb, GCPadStatus* pad_status);
+	void PollLocalPads();
+	void DrainPadBuffers();
+	bool HasUnconfirmedInputs() const;
+	bool IsNextPollPredicted() const;
+	void Rollback();
+	void TrimRollbackHistory();
+	void QueueTimeBase(u64 timebase);
+	void SendConfirmedTimeBases();
+
 	bool m_is_connected = false;
 	ConnectionState m_connection_state = ConnectionState::Failure;
 
@@ -179,6 +195,39 @@ private:
 	Common::Event m_wii_pad_event;
 
 	u32 m_timebase_frame = 0;
+
+	// Rollback mode: inputs of remote players that haven't arrived yet are predicted instead of
+	// waited for, and when a prediction turns out wrong the game is rolled back to a snapshot and
+	// resimulated. Inputs are counted per in-game pad poll, like the pad buffers.
+	// Only touched on the CPU thread.
+	struct RollbackSnapshot
+	{
+		std::vector<u8> state;
+		u32 si_poll = 0;
+		std::array<u32, 4> pad_polls{};
+		u32 timebase_frame = 0;
+		bool valid = false;
+	};
+
+	bool m_rollback = false;
+	u32 m_rollback_frames = 0;
+	u32 m_si_polls = 0;
+	// Emulation runs unthrottled until m_si_polls is back at this value
+	u32 m_resimulate_until = 0;
+	bool m_resimulating = false;
+	std::array<u32, 4> m_pad_polls{};
+	std::array<u32, 4> m_local_pads_sent{};
+	std::array<u32, 4> m_mispredicted_poll{};
+	// Received and used inputs, indexed by poll - m_history_base
+	std::array<u32, 4> m_history_base{};
+	std::array<std::deque<GCPadStatus>, 4> m_confirmed_pads;
+	std::array<std::deque<GCPadStatus>, 4> m_used_pads;
+	// Taken after the SI polls that are followed by a predicted one, the last
+	// m_rollback_frames + 1 are kept
+	std::vector<RollbackSnapshot> m_snapshots;
+	size_t m_next_snapshot = 0;
+	// Timebases of frames that may still be rolled back, sent once their inputs are confirmed
+	std::vector<std::pair<u32, u64>> m_pending_timebases;
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
@@ -92,4 +92,8 @@ using PadMappingArray = std::array<PadMapping, 4>;
 namespace NetPlay
 {
 bool IsNetPlayRunning();
+// Registers the CoreTiming event used by rollback. Called on boot, after CoreTiming::Init.
+void Init();
+// Called on the CPU thread right after the SI polled the controllers.
+void OnSIPoll();
 }
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include "Core/NetPlayServer.h"
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,6 +15,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/EXI/EXI_DeviceIPL.h"
 #include "Core/HW/Sram.h"
@@ -31,6 +34,18 @@
 
 u64 g_netplay_initial_rtc = 1272737767;
 
+// Adaptive pad buffer: while a game runs, clients are pinged every ADAPTIVE_PING_INTERVAL ms and
+// the buffer follows the worst path between two players, in pads of BUFFER_MS_PER_PAD ms.
+static const u32 ADAPTIVE_PING_INTERVAL = 250;
+static const float BUFFER_MS_PER_PAD = 1000.0f / 120.0f;
+static const u32 ADAPTIVE_BUFFER_MIN = 1;
+static const u32 ADAPTIVE_BUFFER_MAX = 40;
+// The buffer grows as soon as the link needs it, but only shrinks after this many consecutive
+// evaluations asked for less
+static const u32 ADAPTIVE_DECREASE_VOTES = 20;
+// Every change is announced to all players, so they are at least this many ms apart
+static const u32 ADAPTIVE_CHANGE_INTERVAL = 2000;
+
 NetPlayServer::~NetPlayServer()
 {
 	std::cout << "Stopping Server" << std::endl;
@@ -110,9 +125,15 @@ void NetPlayServer::ThreadFunc()
 {
 	while (m_do_loop)
 	{
-		// update pings every so many seconds
-		if ((m_ping_timer.GetTimeElapsed() > 1000) || m_update_pings)
+		const bool adaptive_buffer = m_is_running && SConfig::GetInstance().bNetPlayAdaptiveBuffer;
+
+		// update pings every so many seconds, more often when they drive the pad buffer
+		if ((m_ping_timer.GetTimeElapsed() > (adaptive_buffer ? ADAPTIVE_PING_INTERVAL : 1000)) ||
+			m_update_pings)
 		{
+			if (adaptive_buffer)
+				UpdateAdaptiveBufferSize();
+
 			m_ping_key = Common::Timer::GetTimeMs();
 
 			sf::Packet spac;
@@ -466,6 +487,106 @@ void NetPlayServer::AdjustPadBufferSize(unsigned int size)
 	SendAsyncToClients(std::move(spac));
 }
 
+// called from ---NETPLAY--- thread
+void NetPlayServer::UpdateLinkEstimate(Client& player, u32 rtt)
+{
+	const float sample = static_cast<float>(rtt);
+	if (player.rtt == 0.0f)
+	{
+		player.rtt = sample;
+		return;
+	}
+
+	// Smoothed like RFC 3550 interarrival jitter
+	player.rtt_jitter += (std::abs(sample - player.rtt) - player.rtt_jitter) / 8.0f;
+	player.rtt += (sample - player.rtt) / 8.0f;
+}
+
+// called from ---NETPLAY--- thread
+// Pad states are sent once per poll, so the spread of their arrival times shows how unevenly the
+// link (and the sender's emulation) delivers them.
+void NetPlayServer::UpdatePadArrival(Client& player)
+{
+	const u64 now = Common::Timer::GetTimeUs();
+	const u64 last = player.last_pad_time_us;
+	player.last_pad_time_us = now;
+	if (last == 0)
+		return;
+
+	const float interval = (now - last) / 1000.0f;
+	// States pushed in a burst when the buffer grows, or gaps from pausing, say nothing about the
+	// link
+	if (interval < 1.0f || interval > 100.0f)
+		return;
+
+	if (player.pad_interval == 0.0f)
+	{
+		player.pad_interval = interval;
+		return;
+	}
+
+	player.pad_jitter += (std::abs(interval - player.pad_interval) - player.pad_jitter) / 16.0f;
+	player.pad_interval += (interval - player.pad_interval) / 16.0f;
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::UpdateAdaptiveBufferSize()
+{
+	// the buffer size is also changed from the GUI thread
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+
+	// Pad states travel from one client to the server and on to another, so the buffer has to
+	// cover the two slowest one-way delays, with some margin for their jitter
+	float slowest = 0.0f;
+	float second_slowest = 0.0f;
+	{
+		std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+		for (const auto& entry : m_players)
+		{
+			const Client& player = entry.second;
+			const float delay =
+				player.rtt / 2.0f + 2.0f * std::max(player.rtt_jitter, player.pad_jitter);
+			if (delay > slowest)
+			{
+				second_slowest = slowest;
+				slowest = delay;
+			}
+			else if (delay > second_slowest)
+			{
+				second_slowest = delay;
+			}
+		}
+	}
+
+	// One extra pad absorbs the frame pacing of the receiving client
+	u32 wanted = static_cast<u32>(std::ceil((slowest + second_slowest) / BUFFER_MS_PER_PAD)) + 1;
+	wanted = std::min(std::max(wanted, ADAPTIVE_BUFFER_MIN), ADAPTIVE_BUFFER_MAX);
+
+	u32 new_size = m_target_buffer_size;
+	if (wanted > m_target_buffer_size)
+	{
+		m_buffer_decrease_votes = 0;
+		new_size = wanted;
+	}
+	else if (wanted < m_target_buffer_size)
+	{
+		if (++m_buffer_decrease_votes >= ADAPTIVE_DECREASE_VOTES)
+			new_size = m_target_buffer_size - 1;
+	}
+	else
+	{
+		m_buffer_decrease_votes = 0;
+	}
+
+	const u64 now = Common::Timer::GetTimeMs();
+	if (new_size == m_target_buffer_size || now - m_last_buffer_change < ADAPTIVE_CHANGE_INTERVAL)
+		return;
+
+	m_buffer_decrease_votes = 0;
+	m_last_buffer_change = now;
+	AdjustPadBufferSize(new_size);
+}
+
 void NetPlayServer::SendAsyncToClients(std::unique_ptr<sf::Packet> packet)
 {
 	{
@@ -519,6 +640,8 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 			return 1;
 		}
 
+		UpdatePadArrival(player);
+
 		// Relay to clients
 		sf::Packet spac;
 		spac << (MessageId)NP_MSG_PAD_DATA;
@@ -572,6 +695,9 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 			player.ping = ping;
 		}
 
+		// The key is the send time, so late answers to older pings still give a valid sample
+		UpdateLinkEstimate(player, Common::Timer::GetTimeMs() - ping_key);
+
 		sf::Packet spac;
 		spac << (MessageId)NP_MSG_PLAYER_PING_DATA;
 		spac << player.pid;
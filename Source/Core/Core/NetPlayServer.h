@@ -75,6 +75,13 @@ private:
 		u32 ping;
 		u32 current_game;
 
+		// Link estimates for the adaptive pad buffer, in ms
+		float rtt = 0.0f;
+		float rtt_jitter = 0.0f;
+		float pad_interval = 0.0f;
+		float pad_jitter = 0.0f;
+		u64 last_pad_time_us = 0;
+
 		bool operator==(const Client& other) const { return this == &other; }
 	};
 
@@ -89,6 +96,9 @@ private:
 	void OnConnectFailed(u8) override {}
 	void UpdatePadMapping();
 	void UpdateWiimoteMapping();
+	void UpdateLinkEstimate(Client& player, u32 rtt);
+	void UpdatePadArrival(Client& player);
+	void UpdateAdaptiveBufferSize();
 	std::vector<std::pair<std::string, std::string>> GetInterfaceListInternal();
 
 	NetSettings m_settings;
@@ -100,6 +110,8 @@ private:
 	bool m_update_pings = false;
 	u32 m_current_game = 0;
 	unsigned int m_target_buffer_size = 0;
+	u32 m_buffer_decrease_votes = 0;
+	u64 m_last_buffer_change = 0;
 	PadMappingArray m_pad_map;
 	PadMappingArray m_wiimote_map;
 
@@ -17,6 +17,8 @@ public:
 	void Shutdown() override;
 	void SingleStep() override;
 	int SingleStepInner();
+	// Runs instructions up to the end of the current block, returns the cycles they took.
+	int RunBlock();
 
 	void Run() override;
 	void ClearCache() override;
@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 
@@ -17,6 +18,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Common/x64ABI.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -25,6 +27,7 @@
 #include "Core/HW/GPFifo.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/PatchEngine.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/FarCodeCache.h"
@@ -212,6 +215,11 @@ bool Jit64::HandleFault(uintptr_t access_address, SContext* ctx)
 	if (m_enable_blr_optimization && diff >= GUARD_OFFSET && diff < GUARD_OFFSET + GUARD_SIZE)
 		return HandleStackFault();
 
+	// The backpatcher reads what DoJit records about fastmem accesses, and emits trampolines.
+	// Faults on other threads aren't in JIT code, so don't risk waiting on the lock there.
+	std::unique_lock<std::recursive_mutex> lk(m_compile_lock, std::defer_lock);
+	if (Core::IsCPUThread())
+		lk.lock();
 	return Jitx86Base::HandleFault(access_address, ctx);
 }
 
@@ -242,8 +250,12 @@ void Jit64::Init()
 	if (m_enable_blr_optimization)
 		AllocStack();
 
+	// The debugger steps and breaks within blocks, which needs them compiled right away
+	const bool background_compile = SConfig::GetInstance().bJITBackgroundCompile &&
+		!SConfig::GetInstance().bEnableDebugging && !SConfig::GetInstance().bJITNoBlockCache;
+
 	blocks.Init();
-	asm_routines.Init(m_stack ? (m_stack + STACK_SIZE) : nullptr);
+	asm_routines.Init(m_stack ? (m_stack + STACK_SIZE) : nullptr, background_compile);
 
 	// important: do this *after* generating the global asm routines, because we can't use farcode in
 	// them.
@@ -255,10 +267,27 @@ void Jit64::Init()
 	code_block.m_gpa = &js.gpa;
 	code_block.m_fpa = &js.fpa;
 	EnableOptimization();
+
+	// Blocks compiled for the debugger or without a block cache aren't worth remembering
+	m_use_persistent_cache = SConfig::GetInstance().bJITPersistentCache &&
+		!SConfig::GetInstance().bEnableDebugging && !SConfig::GetInstance().bJITNoBlockCache;
+	if (m_use_persistent_cache)
+		m_persistent_cache.Init(SConfig::GetInstance().GetGameID());
+
+	// The other settings DoJit and the instructions read are set at boot, before this thread starts.
+	// The JIT debugging options are only changed from the debugger, which turns this off.
+	if (background_compile)
+	{
+		m_compile_thread_quit = false;
+		m_compile_thread = std::thread(&Jit64::CompileThread, this);
+	}
 }
 
 void Jit64::ClearCache()
 {
+	std::lock_guard<std::recursive_mutex> lk(m_compile_lock);
+	DiscardCompileJobs();
+
 	blocks.Clear();
 	trampolines.ClearCodeSpace();
 	m_far_code.ClearCodeSpace();
@@ -269,6 +298,10 @@ void Jit64::ClearCache()
 
 void Jit64::Shutdown()
 {
+	StopCompileThread();
+	m_persistent_cache.Shutdown();
+	m_use_persistent_cache = false;
+
 	FreeStack();
 	FreeCodeSpace();
 
@@ -547,8 +580,46 @@ void Jit64::Trace()
 		PowerPC::ppcState.spr[8], regs.c_str(), fregs.c_str());
 }
 
+bool Jit64::s_ran_block_in_interpreter = false;
+
 void Jit64::Jit(u32 em_address)
 {
+	s_ran_block_in_interpreter = false;
+	if (m_compile_thread.joinable() && !m_cleanup_after_stackfault)
+	{
+		PublishCompiledBlocks();
+		if (!m_code_space_full && !SConfig::GetInstance().bJITNoBlockCache)
+		{
+			if (m_use_persistent_cache)
+				PreloadBlocks(em_address);
+
+			// Compiled by the compile thread in the meantime
+			if (blocks.GetBlockFromStartAddress(em_address, MSR))
+				return;
+
+			bool queued = m_queued_blocks.count(
+				BlockKey(em_address, MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK)) != 0;
+			if (!queued)
+			{
+				std::unique_ptr<CompileJob> job = AnalyzeForCompileThread(em_address);
+				if (job)
+				{
+					QueueCompileJob(std::move(job));
+					queued = true;
+				}
+			}
+			if (queued)
+			{
+				// The dispatcher checks the downcount after this
+				PowerPC::ppcState.downcount -= Interpreter::getInstance()->RunBlock();
+				s_ran_block_in_interpreter = true;
+				return;
+			}
+		}
+	}
+
+	std::lock_guard<std::recursive_mutex> lk(m_compile_lock);
+
 	if (m_cleanup_after_stackfault)
 	{
 		ClearCache();
@@ -565,6 +636,14 @@ void Jit64::Jit(u32 em_address)
 		ClearCache();
 	}
 
+	if (m_use_persistent_cache && !m_compile_thread.joinable())
+	{
+		PreloadBlocks(em_address);
+		// The preloaded blocks may have used up the space kept for this one
+		if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull())
+			ClearCache();
+	}
+
 	int blockSize = code_buffer.GetSize();
 
 	if (SConfig::GetInstance().bEnableDebugging)
@@ -607,9 +686,324 @@ void Jit64::Jit(u32 em_address)
 		return;
 	}
 
+	m_block_inputs = CaptureBlockInputs(code_block, code_buffer);
 	JitBlock* b = blocks.AllocateBlock(em_address);
 	DoJit(em_address, &code_buffer, b, nextPC);
 	blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+
+	if (m_use_persistent_cache)
+	{
+		m_persistent_cache.Record(em_address, b->msrBits,
+			JitPersistentCache::HashBlock(code_buffer, code_block.m_num_instructions));
+	}
+}
+
+void Jit64::PreloadBlocks(u32 em_address)
+{
+	const u32 msr_bits = MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+	m_preloading = true;
+	for (const JitPersistentCache::Entry& entry : m_persistent_cache.TakeRegion(em_address))
+	{
+		// The block at em_address is compiled right after this anyway
+		if (entry.effective_address == em_address || entry.msr_bits != msr_bits)
+			continue;
+		if (blocks.GetBlockFromStartAddress(entry.effective_address, MSR))
+			continue;
+
+		if (m_compile_thread.joinable())
+		{
+			if (m_queued_blocks.count(BlockKey(entry.effective_address, msr_bits)))
+				continue;
+			std::unique_ptr<CompileJob> job = AnalyzeForCompileThread(entry.effective_address);
+			if (!job)
+				break;
+			if (JitPersistentCache::HashBlock(job->code_buffer, job->code_block.m_num_instructions) !=
+				entry.hash)
+			{
+				m_persistent_cache.Reject(entry);
+				std::lock_guard<std::mutex> lk(m_job_lock);
+				m_free_jobs.push_back(std::move(job));
+				continue;
+			}
+			QueueCompileJob(std::move(job));
+			continue;
+		}
+
+		if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull())
+			break;
+
+		const u32 nextPC =
+			analyzer.Analyze(entry.effective_address, &code_block, &code_buffer, code_buffer.GetSize());
+		if (code_block.m_memory_exception ||
+			JitPersistentCache::HashBlock(code_buffer, code_block.m_num_instructions) != entry.hash)
+		{
+			// Different code lives at this address now
+			m_persistent_cache.Reject(entry);
+			continue;
+		}
+
+		m_block_inputs = CaptureBlockInputs(code_block, code_buffer);
+		JitBlock* b = blocks.AllocateBlock(entry.effective_address);
+		DoJit(entry.effective_address, &code_buffer, b, nextPC);
+		blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+	}
+	m_preloading = false;
+}
+
+Jit64::BlockInputs Jit64::CaptureBlockInputs(const PPCAnalyst::CodeBlock& block,
+	const PPCAnalyst::CodeBuffer& buffer) const
+{
+	BlockInputs inputs;
+	for (int i = 0; i < 32; i++)
+		inputs.gprs[i] = PowerPC::ppcState.gpr[i];
+	for (int i = 0; i < 8; i++)
+		inputs.gqrs[i] = GQR(i);
+	inputs.constant_gqrs =
+		js.pairedQuantizeAddresses.find(block.m_address) == js.pairedQuantizeAddresses.end();
+	// The register state is unrelated to blocks compiled ahead of time
+	inputs.speculative_constants = !m_preloading &&
+		js.noSpeculativeConstantsAddresses.find(block.m_address) ==
+		js.noSpeculativeConstantsAddresses.end();
+	inputs.profile = Profiler::g_ProfileBlocks;
+	inputs.sample = Profiler::g_SampleBlocks;
+	inputs.debugging = SConfig::GetInstance().bEnableDebugging;
+	inputs.hle_functions.resize(block.m_num_instructions);
+	inputs.speedhack_cycles.resize(block.m_num_instructions);
+	for (u32 i = 0; i < block.m_num_instructions; i++)
+	{
+		const u32 address = buffer.codebuffer[i].address;
+		if (js.fifoWriteAddresses.find(address) != js.fifoWriteAddresses.end())
+			inputs.fifo_writes.push_back(address);
+
+		const u32 function = HLE::GetFunctionIndex(address);
+		if (function != 0)
+		{
+			const int type = HLE::GetFunctionTypeByIndex(function);
+			if ((type == HLE::HLE_HOOK_START || type == HLE::HLE_HOOK_REPLACE) &&
+				HLE::IsEnabled(HLE::GetFunctionFlagsByIndex(function)))
+			{
+				inputs.hle_functions[i] = function;
+			}
+		}
+		if (!inputs.debugging)
+			inputs.speedhack_cycles[i] = PatchEngine::GetSpeedhackCycles(address);
+	}
+	return inputs;
+}
+
+void Jit64::CompileThread()
+{
+	Common::SetCurrentThreadName("JIT Compile");
+
+	while (true)
+	{
+		std::unique_ptr<CompileJob> job;
+		{
+			std::unique_lock<std::mutex> lk(m_job_lock);
+			m_job_available.wait(lk, [this] { return m_compile_thread_quit || !m_queued_jobs.empty(); });
+			if (m_compile_thread_quit)
+				return;
+			job = std::move(m_queued_jobs.front());
+			m_queued_jobs.pop_front();
+		}
+
+		std::lock_guard<std::recursive_mutex> lk(m_compile_lock);
+		// The CPU thread clears the cache when it runs out of space, and only it may
+		job->compiled = !IsAlmostFull() && !m_far_code.IsAlmostFull();
+		if (job->compiled)
+		{
+			code_block = job->code_block;
+			code_block.m_stats = &js.st;
+			code_block.m_gpa = &js.gpa;
+			code_block.m_fpa = &js.fpa;
+			js.st = job->stats;
+			js.gpa = job->gpa;
+			js.fpa = job->fpa;
+			m_block_inputs = job->inputs;
+			DoJit(job->em_address, &job->code_buffer, &job->block, job->next_pc);
+		}
+
+		std::lock_guard<std::mutex> job_lk(m_job_lock);
+		m_compiled_jobs.push_back(std::move(job));
+	}
+}
+
+void Jit64::StopCompileThread()
+{
+	if (!m_compile_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(m_job_lock);
+		m_compile_thread_quit = true;
+	}
+	m_job_available.notify_one();
+	m_compile_thread.join();
+
+	m_queued_jobs.clear();
+	m_compiled_jobs.clear();
+	m_free_jobs.clear();
+	m_queued_blocks.clear();
+}
+
+std::unique_ptr<Jit64::CompileJob> Jit64::AnalyzeForCompileThread(u32 em_address)
+{
+	// Profiled blocks point at their JitBlock, which only exists once the block is published
+	if (Profiler::g_ProfileBlocks)
+		return nullptr;
+
+	std::unique_ptr<CompileJob> job;
+	{
+		std::lock_guard<std::mutex> lk(m_job_lock);
+		if (!m_free_jobs.empty())
+		{
+			job = std::move(m_free_jobs.back());
+			m_free_jobs.pop_back();
+		}
+	}
+	if (!job)
+	{
+		// Every job ever allocated is either free or in flight
+		if (m_queued_blocks.size() >= MAX_QUEUED_BLOCKS)
+			return nullptr;
+		job = std::make_unique<CompileJob>();
+	}
+
+	job->code_block.m_stats = &job->stats;
+	job->code_block.m_gpa = &job->gpa;
+	job->code_block.m_fpa = &job->fpa;
+	job->next_pc =
+		analyzer.Analyze(em_address, &job->code_block, &job->code_buffer, BACKGROUND_BLOCK_SIZE);
+	if (job->code_block.m_memory_exception)
+	{
+		std::lock_guard<std::mutex> lk(m_job_lock);
+		m_free_jobs.push_back(std::move(job));
+		return nullptr;
+	}
+
+	job->em_address = em_address;
+	job->msr_bits = MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+	job->physical_address = JitCache_TranslateAddress(em_address).address;
+	job->clear_count = blocks.GetClearCount();
+	job->inputs = CaptureBlockInputs(job->code_block, job->code_buffer);
+	job->block.linkData.clear();
+	return job;
+}
+
+void Jit64::QueueCompileJob(std::unique_ptr<CompileJob> job)
+{
+	m_queued_blocks.insert(BlockKey(job->em_address, job->msr_bits));
+	{
+		std::lock_guard<std::mutex> lk(m_job_lock);
+		m_queued_jobs.push_back(std::move(job));
+	}
+	m_job_available.notify_one();
+}
+
+void Jit64::PublishCompiledBlocks()
+{
+	std::vector<std::unique_ptr<CompileJob>> compiled_jobs;
+	{
+		std::lock_guard<std::mutex> lk(m_job_lock);
+		if (m_compiled_jobs.empty())
+			return;
+		compiled_jobs.swap(m_compiled_jobs);
+	}
+
+	for (std::unique_ptr<CompileJob>& job : compiled_jobs)
+	{
+		m_queued_blocks.erase(BlockKey(job->em_address, job->msr_bits));
+		if (!job->compiled)
+		{
+			// Compiled on the CPU thread from now on, which clears the cache first
+			m_code_space_full = true;
+		}
+		else if (!IsCompileJobStale(*job))
+		{
+			JitBlock* b = blocks.AllocateBlock(job->em_address);
+			b->checkedEntry = job->block.checkedEntry;
+			b->normalEntry = job->block.normalEntry;
+			b->codeSize = job->block.codeSize;
+			b->originalSize = job->block.originalSize;
+			b->runCount = 0;
+			b->ticCounter = 0;
+			b->ticStart = 0;
+			b->ticStop = 0;
+			b->linkData = std::move(job->block.linkData);
+			blocks.FinalizeBlock(*b, jo.enableBlocklink, job->code_block.m_physical_addresses);
+
+			if (m_use_persistent_cache)
+			{
+				m_persistent_cache.Record(job->em_address, job->msr_bits,
+					JitPersistentCache::HashBlock(job->code_buffer, job->code_block.m_num_instructions));
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lk(m_job_lock);
+	for (std::unique_ptr<CompileJob>& job : compiled_jobs)
+		m_free_jobs.push_back(std::move(job));
+}
+
+bool Jit64::IsCompileJobStale(const CompileJob& job)
+{
+	// The code of a stale job is left in the code space until the next clear
+	if (job.clear_count != blocks.GetClearCount())
+		return true;
+	if (job.msr_bits != (MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK))
+		return true;
+	if (blocks.GetBlockFromStartAddress(job.em_address, job.msr_bits))
+		return true;
+	if (JitCache_TranslateAddress(job.em_address).address != job.physical_address)
+		return true;
+
+	// Catches code invalidated while the block was compiling
+	for (u32 i = 0; i < job.code_block.m_num_instructions; i++)
+	{
+		const PPCAnalyst::CodeOp& op = job.code_buffer.codebuffer[i];
+		const auto read = PowerPC::TryReadInstruction(op.address);
+		if (!read.valid || read.hex != op.inst.hex)
+			return true;
+	}
+
+	// Exception checks that fired since the job was queued, else the block would keep failing them
+	if (job.inputs.constant_gqrs &&
+		js.pairedQuantizeAddresses.find(job.em_address) != js.pairedQuantizeAddresses.end())
+	{
+		return true;
+	}
+	if (job.inputs.speculative_constants &&
+		js.noSpeculativeConstantsAddresses.find(job.em_address) !=
+		js.noSpeculativeConstantsAddresses.end())
+	{
+		return true;
+	}
+	for (u32 i = 0; i < job.code_block.m_num_instructions; i++)
+	{
+		const u32 address = job.code_buffer.codebuffer[i].address;
+		if (js.fifoWriteAddresses.find(address) != js.fifoWriteAddresses.end() &&
+			std::find(job.inputs.fifo_writes.begin(), job.inputs.fifo_writes.end(), address) ==
+			job.inputs.fifo_writes.end())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void Jit64::DiscardCompileJobs()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_job_lock);
+		for (std::unique_ptr<CompileJob>& job : m_queued_jobs)
+			m_free_jobs.push_back(std::move(job));
+		m_queued_jobs.clear();
+		for (std::unique_ptr<CompileJob>& job : m_compiled_jobs)
+			m_free_jobs.push_back(std::move(job));
+		m_compiled_jobs.clear();
+	}
+	m_queued_blocks.clear();
+	m_code_space_full = false;
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBlock* b, u32 nextPC)
@@ -648,8 +1042,11 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 		ABI_PopRegistersAndAdjustStack({}, 0);
 	}
 
+	if (m_block_inputs.sample)
+		MOV(32, M(&Profiler::g_current_block), Imm32(js.blockStart));
+
 	// Conditionally add profiling code.
-	if (Profiler::g_ProfileBlocks)
+	if (m_block_inputs.profile)
 	{
 		MOV(64, R(RSCRATCH), ImmPtr(&b->runCount));
 		ADD(32, MatR(RSCRATCH), Imm8(1));
@@ -679,7 +1076,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 	// loads and stores,
 	// which are significantly faster when inlined (especially in MMU mode, where this lets them use
 	// fastmem).
-	if (js.pairedQuantizeAddresses.find(js.blockStart) == js.pairedQuantizeAddresses.end())
+	if (m_block_inputs.constant_gqrs)
 	{
 		// If there are GQRs used but not set, we'll treat those as constant and optimize them
 		BitSet8 gqr_static = ComputeStaticGQRs(code_block);
@@ -699,7 +1096,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 			// the start of the block in case our guess turns out wrong.
 			for (int gqr : gqr_static)
 			{
-				u32 value = GQR(gqr);
+				u32 value = m_block_inputs.gqrs[gqr];
 				js.constantGqr[gqr] = value;
 				CMP_or_TEST(32, PPCSTATE(spr[SPR_GQR0 + gqr]), Imm32(value));
 				J_CC(CC_NZ, target);
@@ -707,11 +1104,8 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 		}
 	}
 
-	if (js.noSpeculativeConstantsAddresses.find(js.blockStart) ==
-		js.noSpeculativeConstantsAddresses.end())
-	{
+	if (m_block_inputs.speculative_constants)
 		IntializeSpeculativeConstants();
-	}
 
 	// Translate instructions
 	for (u32 i = 0; i < code_block.m_num_instructions; i++)
@@ -727,12 +1121,11 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 		js.revertGprLoad = -1;
 		js.revertFprLoad = -1;
 
-		if (!SConfig::GetInstance().bEnableDebugging)
-			js.downcountAmount += PatchEngine::GetSpeedhackCycles(js.compilerPC);
+		js.downcountAmount += m_block_inputs.speedhack_cycles[i];
 
 		if (i == (code_block.m_num_instructions - 1))
 		{
-			if (Profiler::g_ProfileBlocks)
+			if (m_block_inputs.profile)
 			{
 				// WARNING - cmp->branch merging will screw this up.
 				PROFILER_VPUSH;
@@ -747,7 +1140,8 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 
 		// Gather pipe writes using a non-immediate address are discovered by profiling.
 		bool gatherPipeIntCheck =
-			js.fifoWriteAddresses.find(ops[i].address) != js.fifoWriteAddresses.end();
+			std::find(m_block_inputs.fifo_writes.begin(), m_block_inputs.fifo_writes.end(),
+				ops[i].address) != m_block_inputs.fifo_writes.end();
 
 		// Gather pipe writes using an immediate address are explicitly tracked.
 		if (jo.optimizeGatherPipe && (js.fifoBytesSinceCheck >= 32 || js.mustCheckFifo))
@@ -789,24 +1183,16 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 			SetJumpTarget(noExtIntEnable);
 		}
 
-		u32 function = HLE::GetFunctionIndex(ops[i].address);
+		const u32 function = m_block_inputs.hle_functions[i];
 		if (function != 0)
 		{
-			int type = HLE::GetFunctionTypeByIndex(function);
-			if (type == HLE::HLE_HOOK_START || type == HLE::HLE_HOOK_REPLACE)
+			HLEFunction(function);
+			if (HLE::GetFunctionTypeByIndex(function) == HLE::HLE_HOOK_REPLACE)
 			{
-				int flags = HLE::GetFunctionFlagsByIndex(function);
-				if (HLE::IsEnabled(flags))
-				{
-					HLEFunction(function);
-					if (type == HLE::HLE_HOOK_REPLACE)
-					{
-						MOV(32, R(RSCRATCH), PPCSTATE(npc));
-						js.downcountAmount += js.st.numCycles;
-						WriteExitDestInRSCRATCH();
-						break;
-					}
-				}
+				MOV(32, R(RSCRATCH), PPCSTATE(npc));
+				js.downcountAmount += js.st.numCycles;
+				WriteExitDestInRSCRATCH();
+				break;
 			}
 		}
 
@@ -833,8 +1219,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 				js.firstFPInstructionFound = true;
 			}
 
-			if (SConfig::GetInstance().bEnableDebugging &&
-				breakpoints.IsAddressBreakPoint(ops[i].address) && CPU::GetState() != CPU::CPU_STEPPING)
+			if (m_block_inputs.debugging && breakpoints.IsAddressBreakPoint(ops[i].address) && CPU::GetState() != CPU::CPU_STEPPING)
 			{
 				// Turn off block linking if there are breakpoints so that the Step Over command does not
 				// link this block.
@@ -1005,7 +1390,7 @@ void Jit64::IntializeSpeculativeConstants()
 	const u8* target = nullptr;
 	for (auto i : code_block.m_gpr_inputs)
 	{
-		u32 compileTimeValue = PowerPC::ppcState.gpr[i];
+		u32 compileTimeValue = m_block_inputs.gprs[i];
 		if (PowerPC::IsOptimizableGatherPipeWrite(compileTimeValue) ||
 			PowerPC::IsOptimizableGatherPipeWrite(compileTimeValue - 0x8000) ||
 			compileTimeValue == 0xCC000000)
@@ -18,6 +18,15 @@
 // ----------
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
@@ -27,6 +36,7 @@
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64Base.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
 class Jit64 : public Jitx86Base
@@ -230,6 +240,10 @@ public:
 
 	void eieio(UGeckoInstruction inst);
 
+	// Set when Jit ran the missed block in the interpreter instead of compiling it, which uses up
+	// downcount. The dispatcher then checks the downcount before looking up the next block.
+	static bool s_ran_block_in_interpreter;
+
 private:
 	static void InitializeInstructionTables();
 	void CompileInstruction(PPCAnalyst::CodeOp& op);
@@ -237,6 +251,77 @@ private:
 	void AllocStack();
 	void FreeStack();
 
+	// Compiles the blocks the persistent cache knows in the region of em_address
+	void PreloadBlocks(u32 em_address);
+
+	// What DoJit specializes a block for besides its instructions. Captured on the CPU thread right
+	// after the analysis, so the compile thread never reads state the CPU thread is changing.
+	struct BlockInputs
+	{
+		std::array<u32, 32> gprs;
+		std::array<u32, 8> gqrs;
+		// Assume the GQRs the block uses but doesn't set keep their current values
+		bool constant_gqrs;
+		bool speculative_constants;
+		bool profile;
+		// Store the block address for the sampling profiler
+		bool sample;
+		// The addresses in the block that write to the gather pipe through a register
+		std::vector<u32> fifo_writes;
+		// Per instruction: the HLE function hooked before it (0 for none) and the cycles added by
+		// speed hacks. Symbols and patches are loaded while the block waits for the compile thread.
+		std::vector<u32> hle_functions;
+		std::vector<int> speedhack_cycles;
+		bool debugging;
+	};
+	BlockInputs CaptureBlockInputs(const PPCAnalyst::CodeBlock& block,
+		const PPCAnalyst::CodeBuffer& buffer) const;
+
+	// Blocks missed by the dispatcher can be compiled on a separate thread, while the CPU thread
+	// runs them in the interpreter. The CPU thread analyzes the block, the compile thread emits the
+	// code, and the CPU thread adds it to the block cache on its next miss, after checking the
+	// instructions in memory are still the ones that were compiled.
+	struct CompileJob
+	{
+		CompileJob() : code_buffer(BACKGROUND_BLOCK_SIZE) {}
+
+		u32 em_address;
+		u32 physical_address;
+		u32 msr_bits;
+		u32 next_pc;
+		u32 clear_count;
+		PPCAnalyst::CodeBlock code_block;
+		PPCAnalyst::BlockStats stats;
+		PPCAnalyst::BlockRegStats gpa;
+		PPCAnalyst::BlockRegStats fpa;
+		PPCAnalyst::CodeBuffer code_buffer;
+		BlockInputs inputs;
+
+		// Filled by the compile thread
+		JitBlock block;
+		bool compiled;
+	};
+
+	// Blocks analyzed for the compile thread are cut at this many instructions
+	static const int BACKGROUND_BLOCK_SIZE = 4096;
+	// Blocks waiting for or going through the compile thread; beyond this blocks are compiled on
+	// the CPU thread
+	static const size_t MAX_QUEUED_BLOCKS = 16;
+
+	static u64 BlockKey(u32 em_address, u32 msr_bits)
+	{
+		return static_cast<u64>(msr_bits) << 32 | em_address;
+	}
+
+	void CompileThread();
+	void StopCompileThread();
+	// Returns nullptr if the instructions can't be fetched or too many blocks are queued
+	std::unique_ptr<CompileJob> AnalyzeForCompileThread(u32 em_address);
+	void QueueCompileJob(std::unique_ptr<CompileJob> job);
+	void PublishCompiledBlocks();
+	bool IsCompileJobStale(const CompileJob& job);
+	void DiscardCompileJobs();
+
 	GPRRegCache gpr{ *this };
 	FPURegCache fpr{ *this };
 
@@ -248,4 +333,26 @@ private:
 	bool m_enable_blr_optimization;
 	bool m_cleanup_after_stackfault;
 	u8* m_stack;
+
+	JitPersistentCache m_persistent_cache;
+	bool m_use_persistent_cache = false;
+	// Set while compiling blocks ahead of time, when the register state is unrelated to them
+	bool m_preloading = false;
+
+	// The inputs of the block DoJit is compiling
+	BlockInputs m_block_inputs;
+
+	// Held by whichever thread emits code or reads what DoJit records for the backpatcher
+	std::recursive_mutex m_compile_lock;
+	std::thread m_compile_thread;
+	std::mutex m_job_lock;
+	std::condition_variable m_job_available;
+	bool m_compile_thread_quit = false;
+	std::deque<std::unique_ptr<CompileJob>> m_queued_jobs;
+	std::vector<std::unique_ptr<CompileJob>> m_compiled_jobs;
+	std::vector<std::unique_ptr<CompileJob>> m_free_jobs;
+	// Blocks the CPU thread queued and hasn't published yet
+	std::unordered_set<u64> m_queued_blocks;
+	// Set when the compile thread gave up on a block because the code space is full
+	bool m_code_space_full = false;
 };
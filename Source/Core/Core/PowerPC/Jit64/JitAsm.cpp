@@ -14,6 +14,7 @@
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 
 using namespace Gen;
 
@@ -50,6 +51,8 @@ void Jit64AsmRoutineManager::Generate()
 	MOV(64, R(RPPCSTATE), Imm64((u64)&PowerPC::ppcState + 0x80));
 
 	const u8* outerLoop = GetCodePtr();
+	// Time outside of compiled code isn't attributed to a block by the sampling profiler
+	MOV(32, M(&Profiler::g_current_block), Imm32(0));
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	ABI_CallFunction(CoreTiming::Advance);
 	ABI_PopRegistersAndAdjustStack({}, 0);
@@ -165,11 +168,21 @@ void Jit64AsmRoutineManager::Generate()
 	// otherwise we will generate a second stack overflow exception during DoJit()
 	ResetStack(*this);
 
+	MOV(32, M(&Profiler::g_current_block), Imm32(0));
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	MOV(32, R(ABI_PARAM1), PPCSTATE(pc));
 	ABI_CallFunction(JitTrampoline);
 	ABI_PopRegistersAndAdjustStack({}, 0);
 
+	if (m_background_compile)
+	{
+		// Jit may have run the block in the interpreter while it compiles in the background
+		CMP(8, M(&Jit64::s_ran_block_in_interpreter), Imm8(0));
+		FixupBranch compiled = J_CC(CC_Z);
+		CMP(32, PPCSTATE(downcount), Imm8(0));
+		JMP(dispatcher, true);
+		SetJumpTarget(compiled);
+	}
 	JMP(dispatcherNoCheck, true);
 
 	SetJumpTarget(bail);
@@ -27,11 +27,13 @@ private:
 	void Generate();
 	void GenerateCommon();
 	u8* m_stack_top;
+	bool m_background_compile;
 
 public:
-	void Init(u8* stack_top)
+	void Init(u8* stack_top, bool background_compile)
 	{
 		m_stack_top = stack_top;
+		m_background_compile = background_compile;
 		// NOTE: When making large additions to the AsmCommon code, you might
 		// want to ensure this number is big enough.
 		AllocCodeSpace(16384);
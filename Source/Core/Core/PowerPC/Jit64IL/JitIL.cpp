@@ -265,7 +265,7 @@ void JitIL::Init()
 	trampolines.Init(jo.memcheck ? TRAMPOLINE_CODE_SIZE_MMU : TRAMPOLINE_CODE_SIZE);
 	AllocCodeSpace(CODE_SIZE);
 	blocks.Init();
-	asm_routines.Init(nullptr);
+	asm_routines.Init(nullptr, false);
 
 	m_far_code.Init(jo.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE);
 	Clear();
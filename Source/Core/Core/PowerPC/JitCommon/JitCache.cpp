@@ -11,9 +11,9 @@
 
 #include <algorithm>
 #include <cstring>
-#include <map>
 #include <utility>
 
+#include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
 #include "Common/JitRegister.h"
 #include "Core/ConfigManager.h"
@@ -29,11 +29,12 @@ using namespace Gen;
 
 bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 {
-  return physical_addresses.lower_bound(address) !=
-         physical_addresses.lower_bound(address + length);
+  auto first = std::lower_bound(physical_addresses.begin(), physical_addresses.end(), address);
+  return first != physical_addresses.end() && *first - address < length;
 }
 
-JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
+JitBaseBlockCache::JitBaseBlockCache(JitBase& jit)
+    : m_jit{jit}, block_range_bits(new u64[BLOCK_RANGE_BITS_ELEMENTS])
 {
 }
 
@@ -67,10 +68,12 @@ void JitBaseBlockCache::Clear()
   block_map.clear();
   links_to.clear();
   block_range_map.clear();
+  std::memset(block_range_bits.get(), 0, sizeof(u64) * BLOCK_RANGE_BITS_ELEMENTS);
 
   valid_block.ClearAll();
 
   fast_block_map.fill(nullptr);
+  clear_count++;
 }
 
 void JitBaseBlockCache::Reset()
@@ -109,13 +112,23 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
   fast_block_map[index] = &block;
   block.fast_block_map_index = index;
 
-  block.physical_addresses = physical_addresses;
+  block.physical_addresses.assign(physical_addresses.begin(), physical_addresses.end());
 
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  for (u32 addr : physical_addresses)
+  u32 last_range = 0;
+  bool first = true;
+  for (u32 addr : block.physical_addresses)
   {
     valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
+
+    // The addresses are sorted, so each macro block comes up in one run
+    const u32 range = addr >> BLOCK_RANGE_MAP_SHIFT;
+    if (first || range != last_range)
+    {
+      block_range_map[range].push_back(&block);
+      block_range_bits[range / 64] |= 1ULL << (range % 64);
+      last_range = range;
+      first = false;
+    }
   }
 
   if (block_link)
@@ -207,24 +220,35 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
-  // Iterate over all macro blocks which overlap the given range.
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
+  if (length == 0)
+    return;
+
+  // Iterate over all macro blocks which overlap the given range and contain code.
+  const u32 last = static_cast<u32>((u64(address) + length - 1) >> BLOCK_RANGE_MAP_SHIFT);
+  u32 range = address >> BLOCK_RANGE_MAP_SHIFT;
+  while (range <= last)
   {
+    const u64 bits = block_range_bits[range / 64] >> (range % 64);
+    if (!bits)
+    {
+      range = (range / 64 + 1) * 64;
+      continue;
+    }
+    range += LeastSignificantSetBit(bits);
+    if (range > last)
+      break;
+
     // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    auto range_iter = block_range_map.find(range);
+    std::vector<JitBlock*>& range_blocks = range_iter->second;
+    size_t i = 0;
+    while (i < range_blocks.size())
     {
-      JitBlock* block = *iter;
+      JitBlock* block = range_blocks[i];
       if (block->OverlapsPhysicalRange(address, length))
       {
         // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
+        RemoveFromRangeMap(*block, range);
 
         // And remove the block.
         DestroyBlock(*block);
@@ -238,19 +262,53 @@ void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
           }
           block_map_iter.first++;
         }
-        iter = start->second.erase(iter);
+        range_blocks[i] = range_blocks.back();
+        range_blocks.pop_back();
       }
       else
       {
-        iter++;
+        i++;
       }
     }
 
     // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+    if (range_blocks.empty())
+    {
+      block_range_map.erase(range_iter);
+      block_range_bits[range / 64] &= ~(1ULL << (range % 64));
+    }
+
+    if (range == last)
+      break;
+    range++;
+  }
+}
+
+void JitBaseBlockCache::RemoveFromRangeMap(JitBlock& block, u32 except)
+{
+  u32 last_range = except;
+  for (u32 addr : block.physical_addresses)
+  {
+    const u32 range = addr >> BLOCK_RANGE_MAP_SHIFT;
+    if (range == except || range == last_range)
+      continue;
+    last_range = range;
+
+    auto range_iter = block_range_map.find(range);
+    if (range_iter == block_range_map.end())
+      continue;
+    std::vector<JitBlock*>& range_blocks = range_iter->second;
+    auto it = std::find(range_blocks.begin(), range_blocks.end(), &block);
+    if (it != range_blocks.end())
+    {
+      *it = range_blocks.back();
+      range_blocks.pop_back();
+    }
+    if (range_blocks.empty())
+    {
+      block_range_map.erase(range_iter);
+      block_range_bits[range / 64] &= ~(1ULL << (range % 64));
+    }
   }
 }
 
@@ -8,9 +8,9 @@
 #include <bitset>
 #include <cstring>
 #include <functional>
-#include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -62,8 +62,8 @@ struct JitBlock
   };
   std::vector<LinkData> linkData;
 
-  // This set stores all physical addresses of all occupied instructions.
-  std::set<u32> physical_addresses;
+  // The physical addresses of all occupied instructions, sorted.
+  std::vector<u32> physical_addresses;
 
   // we don't really need to save start and stop
   // TODO (mb2): ticStart and ticStop -> "local var" mean "in block" ... low priority ;)
@@ -149,6 +149,9 @@ public:
 
   u32* GetBlockBitSet() const;
 
+  // Incremented by Clear(), so code compiled before a clear can be told apart.
+  u32 GetClearCount() const { return clear_count; }
+
 protected:
   JitBase& m_jit;
 
@@ -166,19 +169,28 @@ private:
   // Fast but risky block lookup based on fast_block_map.
   size_t FastLookupIndexForAddress(u32 address);
 
+  // Removes block from every macro block it occupies, other than the one at index except.
+  void RemoveFromRangeMap(JitBlock& block, u32 except);
+
   // links_to hold all exit points of all valid blocks in a reverse way.
   // It is used to query all blocks which links to an address.
-  std::multimap<u32, JitBlock*> links_to;  // destination_PC -> number
+  std::unordered_multimap<u32, JitBlock*> links_to;  // destination_PC -> number
 
   // Map indexed by the physical address of the entry point.
   // This is used to query the block based on the current PC in a slow way.
-  std::multimap<u32, JitBlock> block_map;  // start_addr -> block
+  // Elements of unordered containers don't move on rehash, so JitBlock pointers stay valid.
+  std::unordered_multimap<u32, JitBlock> block_map;  // start_addr -> block
 
-  // Range of overlapping code indexed by a masked physical address.
+  // Range of overlapping code indexed by a physical address shifted by BLOCK_RANGE_MAP_SHIFT.
   // This is used for invalidation of memory regions. The range is grouped
   // in macro blocks of each 0x100 bytes.
-  static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  static constexpr u32 BLOCK_RANGE_MAP_SHIFT = 8;
+  std::unordered_map<u32, std::vector<JitBlock*>> block_range_map;
+
+  // One bit per macro block that has an entry in block_range_map, so invalidating a large range
+  // only visits the macro blocks that contain code.
+  static constexpr size_t BLOCK_RANGE_BITS_ELEMENTS = ((1ULL << 32) >> BLOCK_RANGE_MAP_SHIFT) / 64;
+  std::unique_ptr<u64[]> block_range_bits;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
@@ -187,4 +199,6 @@ private:
   // This array is indexed with the masked PC and likely holds the correct block id.
   // This is used as a fast cache of block_map used in the assembly dispatcher.
   std::array<JitBlock*, FAST_BLOCK_MAP_ELEMENTS> fast_block_map;  // start_addr & mask -> number
+
+  u32 clear_count = 0;
 };
@@ -0,0 +1,147 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+
+class JitPersistentCache::Reader final : public LinearDiskCacheReader<Entry, u8>
+{
+public:
+  explicit Reader(std::unordered_map<u64, u64>& known) : m_known(known) {}
+  void Read(const Entry& key, const u8* value, u32 value_size) override
+  {
+    // Later entries replace earlier ones for the same block
+    m_known[MakeKey(key.effective_address, key.msr_bits)] = key.hash;
+  }
+
+private:
+  std::unordered_map<u64, u64>& m_known;
+};
+
+u64 JitPersistentCache::HashBlock(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions)
+{
+  std::vector<u32> words;
+  words.reserve(num_instructions * 2);
+  for (u32 i = 0; i < num_instructions; i++)
+  {
+    // Followed branches make blocks discontiguous, so the addresses are part of the hash
+    words.push_back(buffer.codebuffer[i].address);
+    words.push_back(buffer.codebuffer[i].inst.hex);
+  }
+  return GetXXHash64(reinterpret_cast<const u8*>(words.data()),
+                     static_cast<u32>(words.size() * sizeof(u32)), 0);
+}
+
+void JitPersistentCache::Init(const std::string& game_id)
+{
+  m_known.clear();
+  m_pending.clear();
+  m_enabled = !game_id.empty();
+  if (!m_enabled)
+    return;
+
+  const std::string& cache_dir = File::GetUserPath(D_CACHE_IDX);
+  if (!File::IsDirectory(cache_dir))
+    File::CreateFullPath(cache_dir);
+  const std::string filename =
+      StringFromFormat("%sJIT64-%s-blocks.cache", cache_dir.c_str(), game_id.c_str());
+
+  Reader reader(m_known);
+  const u32 num_read = m_file.OpenAndRead(filename, reader);
+
+  // The file is append only; rewrite it without the replaced entries once they pile up
+  if (num_read > m_known.size() * 2 || m_known.size() > MAX_ENTRIES)
+  {
+    m_file.Close();
+    File::Delete(filename);
+    // Recreates the file with just the header
+    m_file.OpenAndRead(filename, reader);
+    size_t count = 0;
+    for (auto it = m_known.begin(); it != m_known.end();)
+    {
+      if (count++ >= MAX_ENTRIES)
+      {
+        it = m_known.erase(it);
+        continue;
+      }
+      const Entry entry = {static_cast<u32>(it->first), static_cast<u32>(it->first >> 32),
+                           it->second};
+      m_file.Append(entry, nullptr, 0);
+      ++it;
+    }
+  }
+
+  for (const auto& known : m_known)
+  {
+    const Entry entry = {static_cast<u32>(known.first), static_cast<u32>(known.first >> 32),
+                         known.second};
+    m_pending[entry.effective_address >> REGION_SHIFT].push_back(entry);
+  }
+
+  INFO_LOG(DYNA_REC, "Loaded %zu blocks from the persistent JIT cache", m_known.size());
+}
+
+void JitPersistentCache::Shutdown()
+{
+  if (!m_enabled)
+    return;
+
+  m_enabled = false;
+  m_file.Sync();
+  m_file.Close();
+  m_known.clear();
+  m_pending.clear();
+}
+
+void JitPersistentCache::Record(u32 effective_address, u32 msr_bits, u64 hash)
+{
+  if (!m_enabled)
+    return;
+
+  const u64 key = MakeKey(effective_address, msr_bits);
+  auto it = m_known.find(key);
+  if (it != m_known.end())
+  {
+    if (it->second == hash)
+      return;
+    it->second = hash;
+  }
+  else
+  {
+    if (m_known.size() >= MAX_ENTRIES)
+      return;
+    m_known.emplace(key, hash);
+  }
+
+  const Entry entry = {effective_address, msr_bits, hash};
+  m_file.Append(entry, nullptr, 0);
+}
+
+std::vector<JitPersistentCache::Entry> JitPersistentCache::TakeRegion(u32 address)
+{
+  std::vector<Entry> entries;
+  if (m_pending.empty())
+    return entries;
+
+  auto it = m_pending.find(address >> REGION_SHIFT);
+  if (it != m_pending.end())
+  {
+    entries.swap(it->second);
+    m_pending.erase(it);
+  }
+  return entries;
+}
+
+void JitPersistentCache::Reject(const Entry& entry)
+{
+  auto it = m_known.find(MakeKey(entry.effective_address, entry.msr_bits));
+  if (it != m_known.end() && it->second == entry.hash)
+    m_known.erase(it);
+}
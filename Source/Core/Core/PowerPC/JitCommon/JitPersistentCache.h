@@ -0,0 +1,73 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+
+namespace PPCAnalyst
+{
+class CodeBuffer;
+}
+
+// Remembers which blocks a game compiled in earlier sessions, so they can be compiled again before
+// they are first executed.
+//
+// Emitted code refers to absolute addresses of the code space, the register caches and ppcState,
+// so it is not relocatable and only the block descriptors are stored: the start address, the MSR
+// translation bits and a hash of the instructions the analyzer put into the block. A block is only
+// compiled ahead of time if the instructions currently in memory still have the same hash, which
+// keeps JitBaseBlockCache::InvalidateICache authoritative: a preloaded block is a regular block,
+// and code that was invalidated and rewritten since the last session just fails the hash check.
+//
+// Entries are grouped in regions of effective address space. The first miss in a region hands out
+// all of the region's entries, so blocks are preloaded near where the game runs next.
+class JitPersistentCache
+{
+public:
+  struct Entry
+  {
+    u32 effective_address;
+    u32 msr_bits;
+    u64 hash;
+  };
+
+  static constexpr u32 REGION_SHIFT = 16;
+  // Keeps the file and the preloading work bounded for games that generate code at runtime
+  static constexpr size_t MAX_ENTRIES = 0x10000;
+
+  static u64 HashBlock(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions);
+
+  void Init(const std::string& game_id);
+  void Shutdown();
+
+  // Adds a block compiled this session, if it isn't known with the same hash already.
+  void Record(u32 effective_address, u32 msr_bits, u64 hash);
+
+  // Returns the entries from earlier sessions in the region of address, once per region.
+  std::vector<Entry> TakeRegion(u32 address);
+
+  // Forgets an entry whose instructions changed, until it is recorded again.
+  void Reject(const Entry& entry);
+
+private:
+  class Reader;
+
+  static u64 MakeKey(u32 effective_address, u32 msr_bits)
+  {
+    return static_cast<u64>(msr_bits) << 32 | effective_address;
+  }
+
+  bool m_enabled = false;
+  LinearDiskCache<Entry, u8> m_file;
+  // Hash of every block known by start address and MSR bits
+  std::unordered_map<u64, u64> m_known;
+  // Entries loaded from the file that weren't handed out yet, by region
+  std::unordered_map<u32, std::vector<Entry>> m_pending;
+};
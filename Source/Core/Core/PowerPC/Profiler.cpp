@@ -3,16 +3,171 @@
 // Refer to the license.txt file included.
 
 #include "Core/PowerPC/Profiler.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/SymbolDB.h"
+#include "Common/Thread.h"
 #include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
 
 namespace Profiler
 {
 bool g_ProfileBlocks;
+bool g_SampleBlocks;
+std::atomic<u32> g_current_block{0};
+
+// About a minute of samples at the default interval
+static const size_t SAMPLE_BUFFER_SIZE = 64 * 1024;
+
+static std::thread s_sampler_thread;
+static std::mutex s_sampler_lock;
+static std::condition_variable s_sampler_stop;
+static bool s_sampler_quit;
+// Guarded by s_sampler_lock; s_samples[s_next_sample % SAMPLE_BUFFER_SIZE] is the oldest sample
+// once the buffer wrapped around
+static std::vector<Sample> s_samples;
+static u64 s_next_sample;
+static std::chrono::steady_clock::time_point s_sampling_start;
 
 void WriteProfileResults(const std::string& filename)
 {
 	JitInterface::WriteProfileResults(filename);
 }
 
+// Called with s_sampler_lock held
+static void RecordSample()
+{
+	const Sample sample = {
+		static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - s_sampling_start).count()),
+		g_current_block.load(std::memory_order_relaxed) };
+	s_samples[s_next_sample++ % SAMPLE_BUFFER_SIZE] = sample;
+}
+
+static void SamplerThread(std::chrono::microseconds interval)
+{
+	Common::SetCurrentThreadName("Profiler Sampler");
+
+	std::unique_lock<std::mutex> lk(s_sampler_lock);
+	while (!s_sampler_stop.wait_for(lk, interval, [] { return s_sampler_quit; }))
+		RecordSample();
+}
+
+void StartSampling(u32 interval_us)
+{
+	StopSampling();
+
+	s_samples.assign(SAMPLE_BUFFER_SIZE, {});
+	s_next_sample = 0;
+	s_sampling_start = std::chrono::steady_clock::now();
+	s_sampler_quit = false;
+	g_current_block = 0;
+	g_SampleBlocks = true;
+	if (interval_us != 0)
+		s_sampler_thread = std::thread(SamplerThread, std::chrono::microseconds(interval_us));
+}
+
+void TakeSample()
+{
+	std::lock_guard<std::mutex> lk(s_sampler_lock);
+	if (!s_samples.empty())
+		RecordSample();
+}
+
+void StopSampling()
+{
+	g_SampleBlocks = false;
+	if (!s_sampler_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_sampler_lock);
+		s_sampler_quit = true;
+	}
+	s_sampler_stop.notify_one();
+	s_sampler_thread.join();
+}
+
+std::vector<Sample> GetSamples()
+{
+	std::lock_guard<std::mutex> lk(s_sampler_lock);
+	std::vector<Sample> samples;
+	if (s_next_sample <= SAMPLE_BUFFER_SIZE)
+	{
+		samples.assign(s_samples.begin(), s_samples.begin() + static_cast<size_t>(s_next_sample));
+		return samples;
+	}
+
+	const size_t oldest = static_cast<size_t>(s_next_sample % SAMPLE_BUFFER_SIZE);
+	samples.reserve(SAMPLE_BUFFER_SIZE);
+	samples.insert(samples.end(), s_samples.begin() + oldest, s_samples.end());
+	samples.insert(samples.end(), s_samples.begin(), s_samples.begin() + oldest);
+	return samples;
+}
+
+static std::string GetSampleName(u32 address)
+{
+	if (address == 0)
+		return "(outside of compiled code)";
+
+	const Symbol* symbol = g_symbolDB.GetSymbolFromAddr(address);
+	if (!symbol)
+		return StringFromFormat("%08x", address);
+
+	std::string name;
+	for (char c : symbol->name)
+	{
+		if (c == '"' || c == '\\')
+			name += '\\';
+		// Control characters aren't allowed in JSON strings
+		if (static_cast<unsigned char>(c) >= 0x20)
+			name += c;
+	}
+	return name;
+}
+
+void WriteSampleTrace(const std::string& filename)
+{
+	const std::vector<Sample> samples = GetSamples();
+
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		PanicAlert("Failed to open %s", filename.c_str());
+		return;
+	}
+
+	std::FILE* file = f.GetHandle();
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+		"\"args\":{\"name\":\"CPU\"}}");
+	size_t i = 0;
+	while (i < samples.size())
+	{
+		// A sample stands for the time until the next one
+		const std::string name = GetSampleName(samples[i].address);
+		size_t end = i + 1;
+		while (end < samples.size() && GetSampleName(samples[end].address) == name)
+			end++;
+		if (end == samples.size())
+			break;
+
+		std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%" PRIu64
+			",\"dur\":%" PRIu64 ",\"args\":{\"samples\":%zu}}",
+			name.c_str(), samples[i].time_us, samples[end].time_us - samples[i].time_us, end - i);
+		i = end;
+	}
+	std::fprintf(file, "\n]}\n");
+}
+
 }  // namespace
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <string>
 #include <vector>
@@ -68,4 +69,30 @@ namespace Profiler
 extern bool g_ProfileBlocks;
 
 void WriteProfileResults(const std::string& filename);
+
+// Sampling profiler. Blocks compiled while sampling is enabled store their start address in
+// g_current_block on entry, 0 means the CPU thread is outside of compiled code. A separate thread
+// reads it at a fixed interval and keeps the most recent samples in a ring buffer, so the samples
+// of a block are proportional to the host time spent in it, including the calls it makes.
+struct Sample
+{
+	u64 time_us;
+	u32 address;
+};
+
+extern std::atomic<u32> g_current_block;
+extern bool g_SampleBlocks;
+
+// The JIT cache must be cleared around these, so that blocks are compiled with or without the store.
+// With an interval of 0 no thread is started, and samples are only taken by TakeSample.
+void StartSampling(u32 interval_us = 1000);
+void StopSampling();
+// Records the current block now, as the sampler thread does at every interval
+void TakeSample();
+
+// Returns the samples in the ring buffer, oldest first
+std::vector<Sample> GetSamples();
+// Writes the samples in the Chrome trace event format (chrome://tracing, Perfetto), consecutive
+// samples in the same guest function merged into one event
+void WriteSampleTrace(const std::string& filename);
 }
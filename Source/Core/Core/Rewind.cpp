@@ -0,0 +1,282 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/Rewind.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <lzo/lzo1x.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayClient.h"
+#include "Core/State.h"
+
+namespace Rewind
+{
+// Stepping back within this many fields of the last snapshot (or rewind) goes one snapshot further
+// back instead of reloading the same one.
+static const u32 STEP_BACK_THRESHOLD = 20;
+
+static bool s_enabled = false;
+static u32 s_interval = 0;
+static size_t s_budget = 0;
+static std::atomic<u32> s_frames_since_snapshot{ 0 };
+static std::atomic<bool> s_capture_queued{ false };
+
+static std::thread s_worker;
+static std::mutex s_mutex;
+static std::condition_variable s_work_available;
+static std::condition_variable s_work_done;
+static bool s_quit = false;
+static bool s_busy = false;
+static bool s_has_pending = false;
+// Captured state waiting for the worker
+static std::vector<u8> s_pending;
+// Buffer of a dropped state, reused by the next capture to avoid a large allocation
+static std::vector<u8> s_spare;
+// Only used by the worker, or by StepBack while the worker is idle
+static History s_history(0);
+
+// older ^= newer, with newer treated as zero-padded to the size of older.
+// Applying it twice with the same newer state gives back the original.
+static void XorStates(std::vector<u8>& older, const std::vector<u8>& newer)
+{
+	const size_t size = std::min(older.size(), newer.size());
+	u8* dst = older.data();
+	const u8* src = newer.data();
+	for (size_t i = 0; i < size; i++)
+		dst[i] ^= src[i];
+}
+
+History::History(size_t budget) : m_budget(budget)
+{
+}
+
+void History::Push(std::vector<u8>& state)
+{
+	if (!m_latest.empty())
+	{
+		if (m_wrkmem.empty())
+			m_wrkmem.resize((LZO1X_1_MEM_COMPRESS + sizeof(u64) - 1) / sizeof(u64));
+
+		Delta delta;
+		delta.size = m_latest.size();
+		m_scratch = m_latest;
+		XorStates(m_scratch, state);
+
+		lzo_uint out_len = 0;
+		delta.compressed.resize(delta.size + delta.size / 16 + 64 + 3);
+		if (lzo1x_1_compress(m_scratch.data(), delta.size, delta.compressed.data(), &out_len,
+			m_wrkmem.data()) == LZO_E_OK)
+		{
+			delta.compressed.resize(out_len);
+			delta.compressed.shrink_to_fit();
+			m_deltas_size += delta.compressed.size();
+			m_deltas.emplace_back(std::move(delta));
+		}
+		else
+		{
+			// Without the delta the older states can't be reached anymore
+			ERROR_LOG(CORE, "Rewind: failed to compress snapshot delta");
+			m_deltas.clear();
+			m_deltas_size = 0;
+		}
+	}
+
+	m_latest.swap(state);
+	Trim();
+}
+
+bool History::Pop()
+{
+	if (m_deltas.empty())
+		return false;
+
+	const Delta& delta = m_deltas.back();
+	m_scratch.resize(delta.size);
+	lzo_uint new_len = delta.size;
+	if (lzo1x_decompress_safe(delta.compressed.data(), delta.compressed.size(), m_scratch.data(),
+		&new_len, nullptr) != LZO_E_OK ||
+		new_len != delta.size)
+	{
+		ERROR_LOG(CORE, "Rewind: failed to decompress snapshot delta");
+		m_deltas.clear();
+		m_deltas_size = 0;
+		return false;
+	}
+
+	XorStates(m_scratch, m_latest);
+	m_latest.swap(m_scratch);
+	m_deltas_size -= delta.compressed.size();
+	m_deltas.pop_back();
+	return true;
+}
+
+void History::Clear()
+{
+	std::vector<u8>().swap(m_latest);
+	std::vector<u8>().swap(m_scratch);
+	std::deque<Delta>().swap(m_deltas);
+	m_deltas_size = 0;
+}
+
+void History::Trim()
+{
+	while (!m_deltas.empty() && GetSize() > m_budget)
+	{
+		m_deltas_size -= m_deltas.front().compressed.size();
+		m_deltas.pop_front();
+	}
+}
+
+static void WorkerThread()
+{
+	Common::SetCurrentThreadName("Rewind Worker");
+
+	while (true)
+	{
+		std::vector<u8> state;
+		{
+			std::unique_lock<std::mutex> lk(s_mutex);
+			s_work_available.wait(lk, [] { return s_quit || s_has_pending; });
+			if (s_quit)
+				return;
+			state.swap(s_pending);
+			s_has_pending = false;
+			s_busy = true;
+		}
+
+		s_history.Push(state);
+
+		std::lock_guard<std::mutex> lk(s_mutex);
+		s_spare.swap(state);
+		s_busy = false;
+		s_work_done.notify_all();
+	}
+}
+
+static void Capture()
+{
+	std::vector<u8> buffer;
+	{
+		std::lock_guard<std::mutex> lk(s_mutex);
+		// Skip this snapshot if the worker is still behind, so memory use stays bounded
+		if (!s_worker.joinable() || s_has_pending)
+			return;
+		buffer.swap(s_spare);
+	}
+
+	State::SaveToBuffer(buffer);
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	s_pending.swap(buffer);
+	s_has_pending = true;
+	s_work_available.notify_one();
+}
+
+void Init()
+{
+	const SConfig& config = SConfig::GetInstance();
+	s_enabled = config.bRewindEnabled && config.iRewindInterval > 0 && config.iRewindBufferSize > 0;
+	if (!s_enabled)
+		return;
+
+	s_interval = config.iRewindInterval;
+	s_budget = static_cast<size_t>(config.iRewindBufferSize) * 1024 * 1024;
+	s_frames_since_snapshot = 0;
+	s_capture_queued = false;
+	s_history = History(s_budget);
+
+	s_quit = false;
+	s_has_pending = false;
+	s_worker = std::thread(WorkerThread);
+}
+
+void Shutdown()
+{
+	if (!s_worker.joinable())
+		return;
+
+	s_enabled = false;
+	{
+		std::lock_guard<std::mutex> lk(s_mutex);
+		s_quit = true;
+		s_work_available.notify_one();
+	}
+	s_worker.join();
+
+	s_has_pending = false;
+	s_busy = false;
+	std::vector<u8>().swap(s_pending);
+	std::vector<u8>().swap(s_spare);
+	s_history.Clear();
+}
+
+void FrameUpdate()
+{
+	if (!s_enabled || NetPlay::IsNetPlayRunning() || Movie::IsMovieActive())
+		return;
+
+	if (++s_frames_since_snapshot < s_interval)
+		return;
+	s_frames_since_snapshot = 0;
+
+	// Serializing the state pauses the core, so it is done from the host thread
+	if (!s_capture_queued.exchange(true))
+	{
+		Core::QueueHostJob([] {
+			Capture();
+			s_capture_queued = false;
+		});
+	}
+}
+
+bool StepBack()
+{
+	if (!s_enabled || !Core::IsRunning())
+		return false;
+
+	if (NetPlay::IsNetPlayRunning() || Movie::IsMovieActive())
+	{
+		Core::DisplayMessage("Rewind is disabled in Netplay and while a movie is active", 2000);
+		return false;
+	}
+
+	bool was_unpaused = Core::PauseAndLock(true);
+
+	std::unique_lock<std::mutex> lk(s_mutex);
+	s_work_done.wait(lk, [] { return !s_busy && !s_has_pending; });
+
+	if (s_history.GetLatest().empty())
+	{
+		lk.unlock();
+		Core::PauseAndLock(false, was_unpaused);
+		Core::DisplayMessage("There is nothing to rewind to", 2000);
+		return false;
+	}
+
+	if (s_frames_since_snapshot < STEP_BACK_THRESHOLD)
+		s_history.Pop();
+
+	State::LoadFromBuffer(s_history.GetLatest());
+	s_frames_since_snapshot = 0;
+	const size_t remaining = s_history.GetOlderCount();
+	lk.unlock();
+
+	Core::PauseAndLock(false, was_unpaused);
+	Core::DisplayMessage(StringFromFormat("Rewound (%zu more steps available)", remaining), 1000);
+	return true;
+}
+}
@@ -0,0 +1,72 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// In-memory savestate history used to step emulation backwards.
+//
+// Every iRewindInterval fields a savestate is captured into a buffer and handed off to a worker
+// thread. The worker keeps the newest state uncompressed and turns the previous one into a
+// backward delta: the XOR of both states (mostly zero, as RAM dominates the state and little of
+// it changes between snapshots), compressed with LZO. Deltas live in a ring that drops the oldest
+// entries once iRewindBufferSize MiB are in use.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Rewind
+{
+// The stored snapshots: the newest one as is, the older ones as compressed deltas.
+// Not thread-safe.
+class History
+{
+public:
+	explicit History(size_t budget);
+
+	// Makes state the newest snapshot. state is left holding a buffer that can be reused.
+	void Push(std::vector<u8>& state);
+	// Drops the newest snapshot, making the one before it the newest.
+	// Returns false if there is no older snapshot.
+	bool Pop();
+	void Clear();
+
+	// Non-const for State::LoadFromBuffer, which only reads it
+	std::vector<u8>& GetLatest() { return m_latest; }
+	size_t GetOlderCount() const { return m_deltas.size(); }
+	// Memory used by the snapshots, which is kept within the budget by dropping the oldest ones
+	size_t GetSize() const { return m_latest.size() + m_deltas_size; }
+
+private:
+	// The state one snapshot older than the next newer one, as XOR against that state.
+	struct Delta
+	{
+		std::vector<u8> compressed;
+		size_t size;  // uncompressed size of the older state
+	};
+
+	void Trim();
+
+	size_t m_budget;
+	std::vector<u8> m_latest;
+	// Oldest first
+	std::deque<Delta> m_deltas;
+	size_t m_deltas_size = 0;
+	std::vector<u8> m_scratch;
+	// LZO work memory, u64 for its alignment
+	std::vector<u64> m_wrkmem;
+};
+
+void Init();
+void Shutdown();
+
+// Called on the CPU thread at the end of every VI field.
+void FrameUpdate();
+
+// Loads the newest snapshot, or the one before it if the newest was loaded just now.
+// Host thread only. Returns false if there is nothing to go back to.
+bool StepBack();
+}
@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <lzo/lzo1x.h>
 #include <map>
 #include <mutex>
@@ -18,12 +21,16 @@
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/DSPEmulator.h"
 #include "Core/GeckoCode.h"
+#include "Core/HW/DSP.h"
+#include "Core/HW/EXI/EXI.h"
 #include "Core/HW/HW.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
@@ -33,6 +40,7 @@
 #include "Core/State.h"
 
 #include "VideoCommon/AVIDump.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoBackendBase.h"
 
@@ -48,12 +56,12 @@ static const u32 IN_LEN = 128 * 1024u;
 
 static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
-static unsigned char __LZO_MMODEL out[OUT_LEN];
-
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
-
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+// Compressed states are a sequence of frames, each holding one IN_LEN chunk of
+// the state (the last one is shorter, possibly empty):
+//   u32 compressed size, compressed data
+// Chunks are independent, so they are compressed and decompressed in parallel,
+// CHUNKS_PER_BATCH at a time when saving.
+static const size_t CHUNKS_PER_BATCH = 32;
 
 static std::string g_last_filename;
 
@@ -244,6 +252,51 @@ void VerifyBuffer(std::vector<u8>& buffer)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
+static void PauseAndLockOtherThreads(bool do_lock)
+{
+	if (do_lock)
+	{
+		ExpansionInterface::PauseAndLock(true, false);
+		DSP::GetDSPEmulator()->PauseAndLock(true, false);
+		Fifo::PauseAndLock(true, false);
+	}
+	else
+	{
+		Fifo::PauseAndLock(false, true);
+		DSP::GetDSPEmulator()->PauseAndLock(false, true);
+		ExpansionInterface::PauseAndLock(false, true);
+	}
+}
+
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer)
+{
+	PauseAndLockOtherThreads(true);
+
+	u8* ptr = nullptr;
+	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+
+	DoState(p);
+	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
+	buffer.resize(buffer_size);
+
+	ptr = &buffer[0];
+	p.SetMode(PointerWrap::MODE_WRITE);
+	DoState(p);
+
+	PauseAndLockOtherThreads(false);
+}
+
+void LoadFromBufferOnCPUThread(std::vector<u8>& buffer)
+{
+	PauseAndLockOtherThreads(true);
+
+	u8* ptr = &buffer[0];
+	PointerWrap p(&ptr, PointerWrap::MODE_READ);
+	DoState(p);
+
+	PauseAndLockOtherThreads(false);
+}
+
 // return state number not in map
 static int GetEmptySlot(std::map<double, int> m)
 {
@@ -338,7 +391,7 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 	}
 
 	if ((Movie::IsMovieActive()) && !Movie::IsJustStartingRecordingInputFromSaveState())
-		Movie::SaveRecording(filename + ".dtm");
+		Movie::SaveStateRecording(filename + ".dtm");
 	else if (!Movie::IsMovieActive())
 		File::Delete(filename + ".dtm");
 
@@ -359,33 +412,46 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
 	if (header.size != 0)  // non-zero header size means the state is compressed
 	{
-		lzo_uint i = 0;
-		while (true)
+		// There's always a last, shorter chunk, even if it is empty
+		const size_t num_chunks = buffer_size / IN_LEN + 1;
+		struct CompressedChunk
 		{
-			lzo_uint32 cur_len = 0;
-			lzo_uint out_len = 0;
-
-			if ((i + IN_LEN) >= buffer_size)
-			{
-				cur_len = (lzo_uint32)(buffer_size - i);
-			}
-			else
+			std::vector<u8> data;
+			lzo_uint size = 0;
+		};
+		std::vector<CompressedChunk> chunks(std::min(num_chunks, CHUNKS_PER_BATCH));
+		for (CompressedChunk& chunk : chunks)
+			chunk.data.resize(OUT_LEN);
+		std::atomic<bool> compress_failed{ false };
+
+		for (size_t first = 0; first < num_chunks; first += chunks.size())
+		{
+			const size_t count = std::min(chunks.size(), num_chunks - first);
+			Common::ThreadPool::ParallelFor(0, (s32)count, [&](s32 begin, s32 end) {
+				thread_local std::vector<lzo_align_t> wrkmem(
+					(LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+				for (s32 i = begin; i < end; i++)
+				{
+					const size_t offset = (first + i) * IN_LEN;
+					const lzo_uint cur_len = (lzo_uint)std::min<size_t>(IN_LEN, buffer_size - offset);
+					CompressedChunk& out = chunks[i];
+					if (lzo1x_1_compress(buffer_data + offset, cur_len, out.data.data(), &out.size,
+						wrkmem.data()) != LZO_E_OK)
+						compress_failed.store(true);
+				}
+			});
+
+			for (size_t i = 0; i < count; i++)
 			{
-				cur_len = IN_LEN;
+				// The size of the data to write is 'out_len'
+				lzo_uint32 out_len = (lzo_uint32)chunks[i].size;
+				f.WriteArray(&out_len, 1);
+				f.WriteBytes(chunks[i].data.data(), out_len);
 			}
-
-			if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-				PanicAlertT("Internal LZO Error - compression failed");
-
-			// The size of the data to write is 'out_len'
-			f.WriteArray((lzo_uint32*)&out_len, 1);
-			f.WriteBytes(out, out_len);
-
-			if (cur_len != IN_LEN)
-				break;
-
-			i += cur_len;
 		}
+
+		if (compress_failed.load())
+			PanicAlertT("Internal LZO Error - compression failed");
 	}
 	else  // uncompressed
 	{
@@ -497,27 +563,61 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
 		buffer.resize(header.size);
 
-		lzo_uint i = 0;
-		while (true)
+		// Read all the frames at once and find where each of them starts
+		std::vector<u8> compressed((size_t)(f.GetSize() - sizeof(StateHeader)));
+		if (!f.ReadBytes(compressed.data(), compressed.size()))
+		{
+			PanicAlert("wtf? reading bytes: %zu", compressed.size());
+			return;
+		}
+		std::vector<std::pair<size_t, lzo_uint32>> frames;
+		size_t position = 0;
+		while (position + sizeof(lzo_uint32) <= compressed.size())
 		{
 			lzo_uint32 cur_len = 0;  // number of bytes to read
-			lzo_uint new_len = 0;    // number of bytes to write
-
-			if (!f.ReadArray(&cur_len, 1))
-				break;
+			std::memcpy(&cur_len, &compressed[position], sizeof(cur_len));
+			position += sizeof(cur_len);
+			cur_len = (lzo_uint32)std::min<size_t>(cur_len, compressed.size() - position);
+			frames.emplace_back(position, cur_len);
+			position += cur_len;
+		}
 
-			f.ReadBytes(out, cur_len);
-			const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-			if (res != LZO_E_OK)
+		// Every frame but the last one holds exactly IN_LEN bytes of the state
+		if (frames.size() < header.size / IN_LEN + 1)
+		{
+			PanicAlertT("Internal LZO Error - the state is truncated (%zu of %zu chunks)",
+				frames.size(), (size_t)(header.size / IN_LEN + 1));
+			return;
+		}
+		std::atomic<int> result{ LZO_E_OK };
+		std::atomic<size_t> failed_frame{ 0 };
+		Common::ThreadPool::ParallelFor(0, (s32)frames.size(), [&](s32 begin, s32 end) {
+			for (s32 frame = begin; frame < end; frame++)
 			{
-				// This doesn't seem to happen anymore.
-				PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-					"Try loading the state again",
-					res, i, new_len);
-				return;
+				// The last frame is empty when the state size is a multiple of IN_LEN
+				const size_t offset = std::min<size_t>(frame * IN_LEN, buffer.size());
+				const lzo_uint expected_len = (lzo_uint)std::min<size_t>(IN_LEN, buffer.size() - offset);
+				lzo_uint new_len = expected_len;
+				int res = lzo1x_decompress_safe(&compressed[frames[frame].first],
+					frames[frame].second, buffer.data() + offset, &new_len, nullptr);
+				// A short chunk would leave part of the state uninitialized
+				if (res == LZO_E_OK && new_len != expected_len)
+					res = LZO_E_ERROR;
+				if (res != LZO_E_OK)
+				{
+					failed_frame.store(frame);
+					result.store(res);
+				}
 			}
+		});
 
-			i += new_len;
+		if (result.load() != LZO_E_OK)
+		{
+			// This doesn't seem to happen anymore.
+			PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
+				"Try loading the state again",
+				result.load(), (long)(failed_frame.load() * IN_LEN), (long)IN_LEN);
+			return;
 		}
 	}
 	else  // uncompressed
@@ -559,7 +659,7 @@ void LoadAs(const std::string& filename)
 		std::lock_guard<std::mutex> lk(g_cs_undo_load_buffer);
 		SaveToBuffer(g_undo_load_buffer);
 		if (Movie::IsMovieActive())
-			Movie::SaveRecording(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm");
+			Movie::SaveStateRecording(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm");
 		else if (File::Exists(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm"))
 			File::Delete(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm");
 	}
@@ -52,6 +52,11 @@ void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
+// Variants for the CPU thread, for use at a point where the CPU state is consistent (from a
+// CoreTiming event). Only the other emulation threads are paused, and netplay is not checked.
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer);
+void LoadFromBufferOnCPUThread(std::vector<u8>& buffer);
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
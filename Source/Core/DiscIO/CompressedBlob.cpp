@@ -8,21 +8,26 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 #include <zlib.h>
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
@@ -84,7 +89,8 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 	return 0;
 }
 
-bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+bool CompressedBlobReader::ReadRawBlock(u64 block_num, u8* out_buffer, u32* out_size,
+	bool* out_uncompressed)
 {
 	bool uncompressed = false;
 	u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
@@ -98,11 +104,17 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 		offset &= ~(1ULL << 63);
 	}
 
-	// clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-	memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+	// Valid blocks never get larger than the block size, don't overflow the buffer on bad ones
+	if (comp_block_size > m_header.block_size)
+	{
+		PanicAlertT("The disc image \"%s\" is corrupt.\n"
+			"Block %" PRIu64 " is %u bytes long, more than the block size of %u bytes.",
+			m_file_name.c_str(), block_num, comp_block_size, m_header.block_size);
+		return false;
+	}
 
 	m_file.Seek(offset, SEEK_SET);
-	if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+	if (!m_file.ReadBytes(out_buffer, comp_block_size))
 	{
 		PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
 			m_file_name.c_str());
@@ -111,30 +123,58 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 	}
 
 	// First, check hash.
-	u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+	u32 block_hash = HashAdler32(out_buffer, comp_block_size);
 	if (block_hash != m_hashes[block_num])
 		PanicAlertT("The disc image \"%s\" is corrupt.\n"
 			"Hash of block %" PRIu64 " is %08x instead of %08x.",
 			m_file_name.c_str(), block_num, block_hash, m_hashes[block_num]);
 
+	*out_size = comp_block_size;
+	*out_uncompressed = uncompressed;
+	return true;
+}
+
+// Inflates a single block, z must be initialized with inflateInit.
+// Returns the zlib status, out_size receives the amount of data written.
+static int InflateBlock(z_stream* z, const u8* in, u32 in_size, u8* out, u32 block_size,
+	u32* out_size)
+{
+	inflateReset(z);
+	z->next_in = const_cast<u8*>(in);
+	z->avail_in = in_size;
+	z->next_out = out;
+	z->avail_out = block_size;
+	int status = inflate(z, Z_FULL_FLUSH);
+	*out_size = block_size - z->avail_out;
+	return status;
+}
+
+bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+{
+	bool uncompressed = false;
+	u32 comp_block_size = 0;
+
+	if (!ReadRawBlock(block_num, m_zlib_buffer.data(), &comp_block_size, &uncompressed))
+		return false;
+
+	// clear unused part of zlib buffer. maybe this can be deleted when it works fully.
+	std::fill(m_zlib_buffer.begin() + comp_block_size, m_zlib_buffer.end(), 0);
+
 	if (uncompressed)
 	{
 		std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
 	}
 	else
 	{
-		z_stream z = {};
-		z.next_in = m_zlib_buffer.data();
-		z.avail_in = comp_block_size;
-		if (z.avail_in > m_header.block_size)
+		if (comp_block_size > m_header.block_size)
 		{
 			PanicAlert("We have a problem");
 		}
-		z.next_out = out_ptr;
-		z.avail_out = m_header.block_size;
+		z_stream z = {};
 		inflateInit(&z);
-		int status = inflate(&z, Z_FULL_FLUSH);
-		u32 uncomp_size = m_header.block_size - z.avail_out;
+		u32 uncomp_size = 0;
+		int status = InflateBlock(&z, m_zlib_buffer.data(), comp_block_size, out_ptr,
+			m_header.block_size, &uncomp_size);
 		if (status != Z_STREAM_END)
 		{
 			// this seem to fire wrongly from time to time
@@ -151,6 +191,129 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 	return true;
 }
 
+namespace
+{
+// Blocks handed to each thread per batch. Large enough to amortize the
+// hand-off, small enough to keep the memory use low.
+static const u32 BLOCKS_PER_THREAD = 16;
+
+// Batches in flight: one being read, one being (de)compressed and one being written.
+static const u32 NUM_BATCHES = 3;
+
+// Threads that can run blocks at the same time: the pool's workers (one per logical CPU but
+// one) and the calling thread
+static u32 GetThreadCount()
+{
+	return static_cast<u32>(std::max(cpu_info.logical_cpu_count - 1, 1) + 1);
+}
+
+// zlib streams shared by the threads running blocks, one per thread running at the same time.
+class StreamPool
+{
+public:
+	explicit StreamPool(size_t count) : m_streams(count)
+	{
+		for (z_stream& z : m_streams)
+		{
+			z = {};
+			m_free.push_back(&z);
+		}
+	}
+
+	std::vector<z_stream>& GetStreams() { return m_streams; }
+
+	z_stream* Acquire()
+	{
+		std::lock_guard<std::mutex> lk(m_lock);
+		z_stream* z = m_free.back();
+		m_free.pop_back();
+		return z;
+	}
+
+	void Release(z_stream* z)
+	{
+		std::lock_guard<std::mutex> lk(m_lock);
+		m_free.push_back(z);
+	}
+
+private:
+	std::vector<z_stream> m_streams;
+	std::vector<z_stream*> m_free;
+	std::mutex m_lock;
+};
+
+// Runs a job over the blocks of a batch on the thread pool, so the calling thread can read
+// the next batch and write the previous one in the meantime. Blocks are handed out one at a
+// time so threads stay busy when some blocks compress slower than others.
+class BatchWorker final : public Common::IWorker
+{
+public:
+	typedef std::function<void(u32 block)> Job;
+
+	explicit BatchWorker(Job job) : m_job(std::move(job))
+	{
+		Common::ThreadPool::RegisterWorker(this);
+	}
+
+	~BatchWorker() { Common::ThreadPool::UnregisterWorker(this); }
+
+	// Starts running the job for every block in [first, first + count). Returns immediately.
+	void Start(u32 first, u32 count)
+	{
+		// Set before the blocks are handed out, a thread can finish one right away
+		m_remaining.store(count);
+		{
+			std::lock_guard<std::mutex> lk(m_lock);
+			m_next = first;
+			m_end = first + count;
+		}
+		// Every notification wakes up two more worker threads
+		for (u32 i = 0; i < count; i += 2)
+			Common::ThreadPool::NotifyWorkPending();
+	}
+
+	// Helps running the blocks that are left and returns once all of them are done
+	void Wait()
+	{
+		while (NextTask())
+		{
+		}
+		while (m_remaining.load() != 0)
+			Common::YieldCPU();
+	}
+
+	bool NextTask() override
+	{
+		u32 block;
+		{
+			std::lock_guard<std::mutex> lk(m_lock);
+			if (m_next == m_end)
+				return false;
+			block = m_next++;
+		}
+		m_job(block);
+		m_remaining.fetch_sub(1);
+		return true;
+	}
+
+private:
+	Job m_job;
+	std::mutex m_lock;
+	u32 m_next = 0;
+	u32 m_end = 0;
+	std::atomic<u32> m_remaining{ 0 };
+};
+
+struct CompressionBlock
+{
+	std::vector<u8> in_buf;
+	std::vector<u8> out_buf;
+	u32 write_size = 0;
+	u32 hash = 0;
+	bool stored = false;
+};
+}
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
 	u32 sub_type, int block_size, CompressCB callback, void* arg)
 {
@@ -192,11 +355,19 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 		scrubbing = true;
 	}
 
-	z_stream z = {};
-	if (deflateInit(&z, 9) != Z_OK)
-		return false;
+	// Every block is compressed independently with a reset stream, so the output
+	// is identical to compressing the blocks one after another.
+	const u32 thread_count = GetThreadCount();
+	StreamPool streams(thread_count);
+	bool success = true;
+	for (z_stream& z : streams.GetStreams())
+	{
+		if (deflateInit(&z, 9) != Z_OK)
+			success = false;
+	}
 
-	callback(GetStringT("Files opened, ready to compress."), 0, arg);
+	if (success)
+		callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
 	CompressedBlobHeader header;
 	header.magic_cookie = GCZ_MAGIC;
@@ -209,8 +380,22 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
 	std::vector<u64> offsets(header.num_blocks);
 	std::vector<u32> hashes(header.num_blocks);
-	std::vector<u8> out_buf(block_size);
-	std::vector<u8> in_buf(block_size);
+
+	// Batch n lives in blocks[n % NUM_BATCHES * batch_size]
+	const u32 batch_size = thread_count * BLOCKS_PER_THREAD;
+	const u32 num_batches = (header.num_blocks + batch_size - 1) / batch_size;
+	std::vector<CompressionBlock> blocks(NUM_BATCHES * batch_size);
+	for (CompressionBlock& block : blocks)
+	{
+		block.in_buf.resize(block_size);
+		block.out_buf.resize(block_size);
+	}
+	auto get_block = [&](u32 block_num) -> CompressionBlock& {
+		return blocks[block_num / batch_size % NUM_BATCHES * batch_size + block_num % batch_size];
+	};
+	auto get_count = [&](u32 batch) {
+		return std::min(batch_size, header.num_blocks - batch * batch_size);
+	};
 
 	// seek past the header (we will write it at the end)
 	outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -223,17 +408,90 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 	u64 position = 0;
 	int num_compressed = 0;
 	int num_stored = 0;
-	int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
-	bool success = true;
+	std::atomic<bool> deflate_failed{ false };
+
+	BatchWorker compressor([&](u32 block_num) {
+		CompressionBlock& block = get_block(block_num);
+		z_stream* z = streams.Acquire();
+		if (deflateReset(z) != Z_OK)
+		{
+			deflate_failed.store(true);
+			streams.Release(z);
+			return;
+		}
+		z->next_in = block.in_buf.data();
+		z->avail_in = header.block_size;
+		z->next_out = block.out_buf.data();
+		z->avail_out = block_size;
+
+		int status = deflate(z, Z_FINISH);
+		int comp_size = block_size - z->avail_out;
+		// Blocks that don't compress well enough are stored uncompressed
+		block.stored = (status != Z_STREAM_END) || (z->avail_out < 10);
+		streams.Release(z);
+
+		block.write_size = block.stored ? block_size : comp_size;
+		block.hash = HashAdler32(block.stored ? block.in_buf.data() : block.out_buf.data(),
+			block.write_size);
+	});
+
+	auto read_batch = [&](u32 batch) {
+		const u32 first = batch * batch_size;
+		for (u32 i = first; i < first + get_count(batch); i++)
+		{
+			std::vector<u8>& in_buf = get_block(i).in_buf;
+			size_t read_bytes;
+			if (scrubbing)
+				read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
+			else
+				infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
+			if (read_bytes < header.block_size)
+				std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
+		}
+	};
 
-	for (u32 i = 0; i < header.num_blocks; i++)
+	auto write_batch = [&](u32 batch) {
+		const u32 first = batch * batch_size;
+		for (u32 i = first; i < first + get_count(batch); i++)
+		{
+			const CompressionBlock& block = get_block(i);
+			const u8* write_buf = block.stored ? block.in_buf.data() : block.out_buf.data();
+			offsets[i] = position;
+			if (block.stored)
+			{
+				offsets[i] |= 0x8000000000000000ULL;
+				num_stored++;
+			}
+			else
+			{
+				num_compressed++;
+			}
+			hashes[i] = block.hash;
+			if (!outfile.WriteBytes(write_buf, block.write_size))
+			{
+				PanicAlertT("Failed to write the output file \"%s\".\n"
+					"Check that you have enough space available on the target drive.",
+					outfile_path.c_str());
+				return false;
+			}
+			position += block.write_size;
+		}
+		return true;
+	};
+
+	// Batch n is compressed while batch n + 1 is read and batch n - 1 is written.
+	if (success && num_batches != 0)
+		read_batch(0);
+	for (u32 n = 0; n <= num_batches && success; n++)
 	{
-		if (i % progress_monitor == 0)
+		if (n < num_batches)
 		{
-			const u64 inpos = infile.Tell();
+			// position only covers the batches written so far
+			const u32 i = n * batch_size;
+			const u64 written_blocks = n > 1 ? (u64)(n - 1) * batch_size : 0;
 			int ratio = 0;
-			if (inpos != 0)
-				ratio = (int)(100 * position / inpos);
+			if (written_blocks != 0)
+				ratio = (int)(100 * position / (written_blocks * block_size));
 
 			std::string temp =
 				StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
@@ -244,66 +502,22 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 				success = false;
 				break;
 			}
-		}
-
-		offsets[i] = position;
 
-		size_t read_bytes;
-		if (scrubbing)
-			read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-		else
-			infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-		if (read_bytes < header.block_size)
-			std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-		int retval = deflateReset(&z);
-		z.next_in = in_buf.data();
-		z.avail_in = header.block_size;
-		z.next_out = out_buf.data();
-		z.avail_out = block_size;
-
-		if (retval != Z_OK)
-		{
-			ERROR_LOG(DISCIO, "Deflate failed");
-			success = false;
-			break;
+			compressor.Start(i, get_count(n));
 		}
 
-		int status = deflate(&z, Z_FINISH);
-		int comp_size = block_size - z.avail_out;
-
-		u8* write_buf;
-		int write_size;
-		if ((status != Z_STREAM_END) || (z.avail_out < 10))
-		{
-			// PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-			// let's store uncompressed
-			write_buf = in_buf.data();
-			offsets[i] |= 0x8000000000000000ULL;
-			write_size = block_size;
-			num_stored++;
-		}
-		else
-		{
-			// let's store compressed
-			// PanicAlert("Comp %i to %i", block_size, comp_size);
-			write_buf = out_buf.data();
-			write_size = comp_size;
-			num_compressed++;
-		}
+		if (n != 0)
+			success = write_batch(n - 1);
+		if (n + 1 < num_batches && success)
+			read_batch(n + 1);
 
-		if (!outfile.WriteBytes(write_buf, write_size))
+		if (n < num_batches)
+			compressor.Wait();
+		if (deflate_failed.load())
 		{
-			PanicAlertT("Failed to write the output file \"%s\".\n"
-				"Check that you have enough space available on the target drive.",
-				outfile_path.c_str());
+			ERROR_LOG(DISCIO, "Deflate failed");
 			success = false;
-			break;
 		}
-
-		position += write_size;
-
-		hashes[i] = HashAdler32(write_buf, write_size);
 	}
 
 	header.compressed_data_size = position;
@@ -324,7 +538,8 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 	}
 
 	// Cleanup
-	deflateEnd(&z);
+	for (z_stream& z : streams.GetStreams())
+		deflateEnd(&z);
 
 	if (success)
 	{
@@ -365,37 +580,122 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
 	}
 
 	const CompressedBlobHeader& header = reader->GetHeader();
-	static const size_t BUFFER_BLOCKS = 32;
-	size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-	size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-	std::vector<u8> buffer(buffer_size);
-	u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
-	int progress_monitor = std::max<int>(1, num_buffers / 100);
-	bool success = true;
+	const u32 block_size = header.block_size;
 
-	for (u64 i = 0; i < num_buffers; i++)
+	const u32 thread_count = GetThreadCount();
+	StreamPool streams(thread_count);
+	for (z_stream& z : streams.GetStreams())
+		inflateInit(&z);
+
+	// The compressed data of a batch is read in order on this thread, inflated on
+	// the pool while the next batch is read and then written out.
+	struct RawBlock
 	{
-		if (i % progress_monitor == 0)
+		std::vector<u8> data;
+		u32 size = 0;
+		bool uncompressed = false;
+	};
+	const u32 batch_size = thread_count * BLOCKS_PER_THREAD;
+	const u32 num_batches = (header.num_blocks + batch_size - 1) / batch_size;
+	std::vector<RawBlock> raw_blocks(NUM_BATCHES * batch_size);
+	for (RawBlock& block : raw_blocks)
+		block.data.resize(block_size + 64);
+	std::vector<u8> buffer((size_t)block_size * NUM_BATCHES * batch_size);
+	// Block block_num of the disc lives in raw_blocks[get_slot(block_num)]
+	auto get_slot = [&](u32 block_num) {
+		return block_num / batch_size % NUM_BATCHES * batch_size + block_num % batch_size;
+	};
+	auto get_count = [&](u32 batch) {
+		return std::min(batch_size, header.num_blocks - batch * batch_size);
+	};
+
+	std::atomic<bool> inflate_failed{ false };
+	std::atomic<u64> failed_block{ 0 };
+	int progress_monitor = std::max<int>(1, num_batches / 100);
+	bool success = true;
+
+	BatchWorker decompressor([&](u32 block_num) {
+		const u32 slot = get_slot(block_num);
+		const RawBlock& block = raw_blocks[slot];
+		u8* out = buffer.data() + (size_t)slot * block_size;
+		if (block.uncompressed)
 		{
-			bool was_cancelled = !callback(GetStringT("Unpacking"), (float)i / (float)num_buffers, arg);
-			if (was_cancelled)
-			{
-				success = false;
-				break;
-			}
+			std::copy(block.data.begin(), block.data.begin() + block.size, out);
+			return;
+		}
+		z_stream* z = streams.Acquire();
+		u32 uncomp_size = 0;
+		int status = InflateBlock(z, block.data.data(), block.size, out, block_size, &uncomp_size);
+		streams.Release(z);
+		if (status != Z_STREAM_END || uncomp_size != block_size)
+		{
+			failed_block.store(block_num);
+			inflate_failed.store(true);
+		}
+	});
+
+	auto read_batch = [&](u32 batch) {
+		const u32 first = batch * batch_size;
+		for (u32 i = first; i < first + get_count(batch); i++)
+		{
+			RawBlock& block = raw_blocks[get_slot(i)];
+			if (!reader->ReadRawBlock(i, block.data.data(), &block.size, &block.uncompressed))
+				return false;
 		}
-		const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-		reader->Read(i * buffer_size, sz, buffer.data());
-		if (!outfile.WriteBytes(buffer.data(), sz))
+		return true;
+	};
+
+	auto write_batch = [&](u32 batch) {
+		const u8* data = buffer.data() + (size_t)get_slot(batch * batch_size) * block_size;
+		if (!outfile.WriteBytes(data, (size_t)get_count(batch) * block_size))
 		{
 			PanicAlertT("Failed to write the output file \"%s\".\n"
 				"Check that you have enough space available on the target drive.",
 				outfile_path.c_str());
+			return false;
+		}
+		return true;
+	};
+
+	// Batch n is inflated while batch n + 1 is read and batch n - 1 is written.
+	if (num_batches != 0)
+		success = read_batch(0);
+	for (u32 n = 0; n <= num_batches && success; n++)
+	{
+		if (n < num_batches)
+		{
+			if (n % progress_monitor == 0)
+			{
+				bool was_cancelled =
+					!callback(GetStringT("Unpacking"), (float)n / (float)num_batches, arg);
+				if (was_cancelled)
+				{
+					success = false;
+					break;
+				}
+			}
+
+			decompressor.Start(n * batch_size, get_count(n));
+		}
+
+		if (n != 0)
+			success = write_batch(n - 1);
+		if (n + 1 < num_batches && success)
+			success = read_batch(n + 1);
+
+		if (n < num_batches)
+			decompressor.Wait();
+		if (inflate_failed.load())
+		{
+			PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.",
+				failed_block.load());
 			success = false;
-			break;
 		}
 	}
 
+	for (z_stream& z : streams.GetStreams())
+		inflateEnd(&z);
+
 	if (!success)
 	{
 		// Remove the incomplete output file.
@@ -53,6 +53,9 @@ public:
 	u64 GetRawSize() const override { return m_file_size; }
 	u64 GetBlockCompressedSize(u64 block_num) const;
 	bool GetBlock(u64 block_num, u8* out_ptr) override;
+	// Reads the stored data of a block without inflating it and checks its hash.
+	// out_buffer must hold at least block_size bytes.
+	bool ReadRawBlock(u64 block_num, u8* out_buffer, u32* out_size, bool* out_uncompressed);
 
 private:
 	CompressedBlobReader(File::IOFile file, const std::string& filename);
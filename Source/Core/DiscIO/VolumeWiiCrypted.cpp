@@ -4,6 +4,7 @@
 
 #include "DiscIO/VolumeWiiCrypted.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <map>
@@ -31,7 +32,7 @@ namespace DiscIO
 CVolumeWiiCrypted::CVolumeWiiCrypted(std::unique_ptr<IBlobReader> reader, u64 _VolumeOffset,
 	const unsigned char* _pVolumeKey)
 	: m_pReader(std::move(reader)), m_AES_ctx(std::make_unique<mbedtls_aes_context>()),
-	m_VolumeOffset(_VolumeOffset), m_dataOffset(0x20000), m_LastDecryptedBlockOffset(-1)
+	m_VolumeOffset(_VolumeOffset), m_dataOffset(0x20000), m_block_cache_tick(0), m_next_sequential_block(UINT64_MAX)
 {
 	mbedtls_aes_setkey_dec(m_AES_ctx.get(), _pVolumeKey, 128);
 }
@@ -39,7 +40,7 @@ CVolumeWiiCrypted::CVolumeWiiCrypted(std::unique_ptr<IBlobReader> reader, u64 _V
 bool CVolumeWiiCrypted::ChangePartition(u64 offset)
 {
 	m_VolumeOffset = offset;
-	m_LastDecryptedBlockOffset = -1;
+	ClearBlockCache();
 
 	u8 volume_key[16];
 	DiscIO::VolumeKeyForPartition(*m_pReader, offset, volume_key);
@@ -51,6 +52,83 @@ CVolumeWiiCrypted::~CVolumeWiiCrypted()
 {
 }
 
+void CVolumeWiiCrypted::ClearBlockCache() const
+{
+	for (CachedBlock& entry : m_block_cache)
+		entry.block = UINT64_MAX;
+	m_block_cache_index.clear();
+	m_next_sequential_block = UINT64_MAX;
+}
+
+const CVolumeWiiCrypted::CachedBlock* CVolumeWiiCrypted::GetCachedBlock(u64 block) const
+{
+	auto it = m_block_cache_index.find(block);
+	if (it == m_block_cache_index.end())
+		return nullptr;
+	CachedBlock& entry = m_block_cache[it->second];
+	entry.last_use = ++m_block_cache_tick;
+	return &entry;
+}
+
+CVolumeWiiCrypted::CachedBlock* CVolumeWiiCrypted::AllocateCachedBlock(u64 block) const
+{
+	// The cache is only allocated once the volume is actually read from, so
+	// that volumes opened just for their metadata stay cheap.
+	size_t slot = m_block_cache.size();
+	if (slot < CACHED_BLOCKS)
+	{
+		if (m_block_cache.empty())
+			m_block_cache.reserve(CACHED_BLOCKS);
+		m_block_cache.emplace_back();
+	}
+	else
+	{
+		// Evict the least recently used entry. The cache is small and this only
+		// happens next to an AES decryption, so a linear search is good enough.
+		slot = 0;
+		for (size_t i = 1; i < m_block_cache.size(); i++)
+		{
+			if (m_block_cache[i].last_use < m_block_cache[slot].last_use)
+				slot = i;
+		}
+	}
+	CachedBlock& entry = m_block_cache[slot];
+	if (entry.block != UINT64_MAX)
+		m_block_cache_index.erase(entry.block);
+	entry.block = block;
+	entry.last_use = ++m_block_cache_tick;
+	m_block_cache_index[block] = slot;
+	return &entry;
+}
+
+bool CVolumeWiiCrypted::DecryptBlocks(u64 first_block, u64 count) const
+{
+	// Read all the blocks with a single request to the blob reader
+	m_read_buffer.resize(count * BLOCK_TOTAL_SIZE);
+	if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + first_block * BLOCK_TOTAL_SIZE,
+		count * BLOCK_TOTAL_SIZE, m_read_buffer.data()))
+		return false;
+
+	for (u64 i = 0; i < count; i++)
+	{
+		u8* encrypted = &m_read_buffer[i * BLOCK_TOTAL_SIZE];
+		CachedBlock* entry = AllocateCachedBlock(first_block + i);
+
+		// Decrypt the block's data.
+		// 0x3D0 - 0x3DF in the block will be overwritten,
+		// but that won't affect anything, because we won't
+		// use the encrypted data anymore after this
+		mbedtls_aes_crypt_cbc(m_AES_ctx.get(), MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE,
+			&encrypted[0x3D0], &encrypted[BLOCK_HEADER_SIZE], entry->data.data());
+
+		// The only thing we currently use from the 0x000 - 0x3FF part
+		// of the block is the IV (at 0x3D0), but it also contains SHA-1
+		// hashes that IOS uses to check that discs aren't tampered with.
+		// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+	}
+	return true;
+}
+
 bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, bool decrypt) const
 {
 	if (m_pReader == nullptr)
@@ -61,39 +139,52 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, bool de
 
 	FileMon::FindFilename(_ReadOffset);
 
-	std::vector<u8> read_buffer(BLOCK_TOTAL_SIZE);
+	if (_Length == 0)
+		return true;
+
+	const u64 first_block = _ReadOffset / BLOCK_DATA_SIZE;
+	const u64 last_block = (_ReadOffset + _Length - 1) / BLOCK_DATA_SIZE;
+
+	// Streaming reads (continuing where the last read stopped) also decrypt
+	// the blocks that follow so the next read is served from the cache.
+	// Never read ahead past the end of the underlying blob.
+	u64 fetch_end = last_block + 1;
+	if (first_block == m_next_sequential_block || first_block + 1 == m_next_sequential_block)
+	{
+		const u64 data_start = m_VolumeOffset + m_dataOffset;
+		const u64 blob_size = m_pReader->GetDataSize();
+		const u64 available_blocks =
+			blob_size > data_start ? (blob_size - data_start) / BLOCK_TOTAL_SIZE : 0;
+		fetch_end = std::max(fetch_end, std::min(last_block + 1 + READ_AHEAD_BLOCKS, available_blocks));
+	}
+	m_next_sequential_block = last_block + 1;
+
 	while (_Length > 0)
 	{
 		// Calculate block offset
 		u64 Block = _ReadOffset / BLOCK_DATA_SIZE;
 		u64 Offset = _ReadOffset % BLOCK_DATA_SIZE;
 
-		if (m_LastDecryptedBlockOffset != Block)
+		const CachedBlock* entry = GetCachedBlock(Block);
+		if (!entry)
 		{
-			// Read the current block
-			if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + Block * BLOCK_TOTAL_SIZE,
-				BLOCK_TOTAL_SIZE, read_buffer.data()))
+			// Decrypt the run of uncached blocks starting here in one go
+			u64 count = 1;
+			while (Block + count < fetch_end && count < MAX_BATCH_BLOCKS &&
+				m_block_cache_index.find(Block + count) == m_block_cache_index.end())
+			{
+				count++;
+			}
+			// If the batched read fails, fall back to the block that is actually needed
+			if (!DecryptBlocks(Block, count) && (count == 1 || !DecryptBlocks(Block, 1)))
 				return false;
-
-			// Decrypt the block's data.
-			// 0x3D0 - 0x3DF in m_pBuffer will be overwritten,
-			// but that won't affect anything, because we won't
-			// use the content of m_pBuffer anymore after this
-			mbedtls_aes_crypt_cbc(m_AES_ctx.get(), MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE,
-				&read_buffer[0x3D0], &read_buffer[BLOCK_HEADER_SIZE],
-				m_LastDecryptedBlock);
-			m_LastDecryptedBlockOffset = Block;
-
-			// The only thing we currently use from the 0x000 - 0x3FF part
-			// of the block is the IV (at 0x3D0), but it also contains SHA-1
-			// hashes that IOS uses to check that discs aren't tampered with.
-			// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+			entry = GetCachedBlock(Block);
 		}
 
 		// Copy the decrypted data
 		u64 MaxSizeToCopy = BLOCK_DATA_SIZE - Offset;
 		u64 CopySize = (_Length > MaxSizeToCopy) ? MaxSizeToCopy : _Length;
-		memcpy(_pBuffer, &m_LastDecryptedBlock[Offset], (size_t)CopySize);
+		memcpy(_pBuffer, &entry->data[Offset], (size_t)CopySize);
 
 		// Update offsets
 		_Length -= CopySize;
@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <map>
 #include <mbedtls/aes.h>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -61,15 +63,40 @@ public:
 	static constexpr unsigned int BLOCK_DATA_SIZE = 0x7C00;
 	static constexpr unsigned int BLOCK_TOTAL_SIZE = BLOCK_HEADER_SIZE + BLOCK_DATA_SIZE;
 
+	// Number of decrypted blocks kept around (about 2 MiB)
+	static constexpr size_t CACHED_BLOCKS = 64;
+	// Blocks decrypted past the end of a read when the reads are sequential
+	static constexpr u64 READ_AHEAD_BLOCKS = 8;
+	// Upper bound for the number of blocks fetched from the blob with one read
+	static constexpr u64 MAX_BATCH_BLOCKS = 16;
+
 private:
+	struct CachedBlock
+	{
+		u64 block = UINT64_MAX;
+		u64 last_use = 0;
+		std::array<u8, BLOCK_DATA_SIZE> data;
+	};
+
+	const CachedBlock* GetCachedBlock(u64 block) const;
+	CachedBlock* AllocateCachedBlock(u64 block) const;
+	bool DecryptBlocks(u64 first_block, u64 count) const;
+	void ClearBlockCache() const;
+
 	std::unique_ptr<IBlobReader> m_pReader;
 	std::unique_ptr<mbedtls_aes_context> m_AES_ctx;
 
 	u64 m_VolumeOffset;
 	u64 m_dataOffset;
 
-	mutable u64 m_LastDecryptedBlockOffset;
-	mutable unsigned char m_LastDecryptedBlock[BLOCK_DATA_SIZE];
+	// LRU cache of decrypted blocks of the current partition, allocated on the first read
+	mutable std::vector<CachedBlock> m_block_cache;
+	mutable std::unordered_map<u64, size_t> m_block_cache_index;
+	mutable u64 m_block_cache_tick;
+	// Block following the last read, used to detect sequential access
+	mutable u64 m_next_sequential_block;
+	// Encrypted data of the blocks being decrypted
+	mutable std::vector<u8> m_read_buffer;
 };
 
 }  // namespace
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <OptionParser.h>
+#include <algorithm>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
@@ -21,6 +22,7 @@
 #include "Core/BootManager.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/IOS/IPC.h"
@@ -381,6 +383,11 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
   auto parser = CommandLineParse::CreateParser(CommandLineParse::ParserOptions::OmitGUIOptions);
+  parser->add_option("--fifo_benchmark")
+      .action("store")
+      .type("int")
+      .metavar("<loops>")
+      .help("Replay the FIFO log <loops> times without frame limiting and print timings");
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
@@ -406,6 +413,13 @@ int main(int argc, char* argv[])
     user_directory = static_cast<const char*>(options.get("user"));
   }
 
+  const bool fifo_benchmark = options.is_set("fifo_benchmark");
+  if (fifo_benchmark)
+  {
+    const int loops = options.get("fifo_benchmark");
+    FifoPlayer::GetInstance().SetBenchmarkLoops(static_cast<u32>(std::max(loops, 1)));
+  }
+
   platform = GetPlatform();
   if (!platform)
   {
@@ -416,6 +430,12 @@ int main(int argc, char* argv[])
   UICommon::SetUserDirectory(user_directory);
   UICommon::Init();
 
+  if (options.is_set("video_backend"))
+    SConfig::GetInstance().m_strVideoBackend = static_cast<const char*>(options.get("video_backend"));
+  if (options.is_set("audio_emulation"))
+    SConfig::GetInstance().bDSPHLE = std::string(options.get("audio_emulation")) == "HLE";
+  VideoBackendBase::ActivateBackend(SConfig::GetInstance().m_strVideoBackend);
+
   Core::SetOnStoppedCallback([]() { s_running.Clear(); });
   platform->Init();
 
@@ -451,5 +471,16 @@ int main(int argc, char* argv[])
 
   delete platform;
 
+  if (fifo_benchmark)
+  {
+    const std::string& report = FifoPlayer::GetInstance().GetBenchmarkReport();
+    if (report.empty())
+    {
+      fprintf(stderr, "No FIFO benchmark results, was a .dff file given?\n");
+      return 1;
+    }
+    fputs(report.c_str(), stdout);
+  }
+
   return 0;
 }
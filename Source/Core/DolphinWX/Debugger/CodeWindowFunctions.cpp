@@ -130,6 +130,23 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
 		Profiler::g_ProfileBlocks = GetParentMenuBar()->IsChecked(IDM_PROFILE_BLOCKS);
 		Core::SetState(Core::State::Running);
 		break;
+	case IDM_SAMPLE_BLOCKS:
+		Core::SetState(Core::State::Paused);
+		JitInterface::ClearCache();
+		if (GetParentMenuBar()->IsChecked(IDM_SAMPLE_BLOCKS))
+			Profiler::StartSampling();
+		else
+			Profiler::StopSampling();
+		Core::SetState(Core::State::Running);
+		break;
+	case IDM_WRITE_SAMPLE_TRACE:
+	{
+		std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/profiler_trace.json";
+		File::CreateFullPath(filename);
+		Profiler::WriteSampleTrace(filename);
+		Parent->StatusBarMessage("Wrote the profiler samples to %s", filename.c_str());
+		break;
+	}
 	case IDM_WRITE_PROFILE:
 		if (Core::GetState() == Core::State::Running)
 			Core::SetState(Core::State::Paused);
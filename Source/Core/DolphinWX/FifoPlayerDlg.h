@@ -39,6 +39,7 @@ private:
 	void OnRecordStop(wxCommandEvent& event);
 	void OnSaveFile(wxCommandEvent& event);
 	void OnNumFramesToRecord(wxSpinEvent& event);
+	void OnCheckCompressRecording(wxCommandEvent& event);
 
 	void OnBeginSearch(wxCommandEvent& event);
 	void OnFindNextClick(wxCommandEvent& event);
@@ -97,6 +98,7 @@ private:
 	wxButton* m_Save;
 	wxStaticText* m_FramesToRecordLabel;
 	wxSpinCtrl* m_FramesToRecordCtrl;
+	wxCheckBox* m_CompressRecording;
 
 	wxPanel* m_AnalyzePage;
 	wxListBox* m_framesList;
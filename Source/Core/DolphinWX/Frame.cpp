@@ -51,6 +51,7 @@
 #include "Core/IOS/IPC.h"
 #include "Core/IOS/USB/Bluetooth/BTBase.h"
 #include "Core/Movie.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "DolphinWX/Config/ConfigMain.h"
@@ -1564,6 +1565,8 @@ void CFrame::ParseHotkeys()
 		State::UndoLoadState();
 	if (IsHotkey(HK_UNDO_SAVE_STATE))
 		State::UndoSaveState();
+	if (IsHotkey(HK_REWIND))
+		Rewind::StepBack();
 }
 
 void CFrame::HandleFrameSkipHotkeys()
@@ -146,6 +146,7 @@ void CFrame::BindMenuBarEvents()
 	Bind(wxEVT_MENU, &CFrame::OnRecordReadOnly, this, IDM_RECORD_READ_ONLY);
 	Bind(wxEVT_MENU, &CFrame::OnTASInput, this, IDM_TAS_INPUT);
 	Bind(wxEVT_MENU, &CFrame::OnTogglePauseMovie, this, IDM_TOGGLE_PAUSE_MOVIE);
+	Bind(wxEVT_MENU, &CFrame::OnToggleStreamMovieInput, this, IDM_TOGGLE_STREAM_MOVIE_INPUT);
 	Bind(wxEVT_MENU, &CFrame::OnShowLag, this, IDM_SHOW_LAG);
 	Bind(wxEVT_MENU, &CFrame::OnShowFrameCount, this, IDM_SHOW_FRAME_COUNT);
 	Bind(wxEVT_MENU, &CFrame::OnShowInputDisplay, this, IDM_SHOW_INPUT_DISPLAY);
@@ -395,6 +396,12 @@ void CFrame::OnTogglePauseMovie(wxCommandEvent& WXUNUSED(event))
 	SConfig::GetInstance().SaveSettings();
 }
 
+void CFrame::OnToggleStreamMovieInput(wxCommandEvent& WXUNUSED(event))
+{
+	SConfig::GetInstance().m_StreamMovieInput = !SConfig::GetInstance().m_StreamMovieInput;
+	SConfig::GetInstance().SaveSettings();
+}
+
 void CFrame::OnToggleDumpFrames(wxCommandEvent& WXUNUSED(event))
 {
 	SConfig::GetInstance().m_DumpFrames = !SConfig::GetInstance().m_DumpFrames;
@@ -75,6 +75,7 @@ enum
 	IDM_RECORD_READ_ONLY,
 	IDM_TAS_INPUT,
 	IDM_TOGGLE_PAUSE_MOVIE,
+	IDM_TOGGLE_STREAM_MOVIE_INPUT,
 	IDM_SHOW_LAG,
 	IDM_SHOW_FRAME_COUNT,
 	IDM_SHOW_INPUT_DISPLAY,
@@ -236,6 +237,8 @@ enum
 
 	// Profiler
 	IDM_PROFILE_BLOCKS,
+	IDM_SAMPLE_BLOCKS,
+	IDM_WRITE_SAMPLE_TRACE,
 	IDM_WRITE_PROFILE,
 	// --------------------------------------------------------------
 
@@ -146,6 +146,8 @@ wxMenu* MainMenuBar::CreateMovieMenu() const
 	movie_menu->AppendSeparator();
 	movie_menu->AppendCheckItem(IDM_TOGGLE_PAUSE_MOVIE, _("Pause at End of Movie"));
 	movie_menu->Check(IDM_TOGGLE_PAUSE_MOVIE, config_instance.m_PauseMovie);
+	movie_menu->AppendCheckItem(IDM_TOGGLE_STREAM_MOVIE_INPUT, _("Stream Input to Disk"));
+	movie_menu->Check(IDM_TOGGLE_STREAM_MOVIE_INPUT, config_instance.m_StreamMovieInput);
 	movie_menu->AppendCheckItem(IDM_SHOW_LAG, _("Show Lag Counter"));
 	movie_menu->Check(IDM_SHOW_LAG, config_instance.m_ShowLag);
 	movie_menu->AppendCheckItem(IDM_SHOW_FRAME_COUNT, _("Show Frame Counter"));
@@ -473,6 +475,9 @@ wxMenu* MainMenuBar::CreateProfilerMenu() const
 	profiler_menu->AppendCheckItem(IDM_PROFILE_BLOCKS, _("&Profile Blocks"));
 	profiler_menu->AppendSeparator();
 	profiler_menu->Append(IDM_WRITE_PROFILE, _("&Write to profile.txt, Show"));
+	profiler_menu->AppendSeparator();
+	profiler_menu->AppendCheckItem(IDM_SAMPLE_BLOCKS, _("&Sample Blocks"));
+	profiler_menu->Append(IDM_WRITE_SAMPLE_TRACE, _("Write Samples to &Trace File"));
 
 	return profiler_menu;
 }
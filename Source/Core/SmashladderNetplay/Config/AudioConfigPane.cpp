@@ -49,6 +49,7 @@ void AudioConfigPane::InitializeGUI()
 	m_audio_latency_label = new wxStaticText(this, wxID_ANY, _("Latency:"));
 
 	m_time_stretching_checkbox = new wxCheckBox(this, wxID_ANY, _("Time Stretching"));
+	m_sinc_resampling_checkbox = new wxCheckBox(this, wxID_ANY, _("High Quality Resampling"));
 	m_RS_Hack_checkbox = new wxCheckBox(this, wxID_ANY, _("Rogue Squadron 2/3 Hack"));
 	m_audio_backend_choice->SetToolTip(
 		_("Changing this will have no effect while the emulator is running."));
@@ -56,6 +57,9 @@ void AudioConfigPane::InitializeGUI()
 		"crackling. Certain backends only."));
 	m_dpl2_decoder_checkbox->SetToolTip(
 		_("Enables Dolby Pro Logic II emulation using 5.1 surround. Certain backends only."));
+	m_sinc_resampling_checkbox->SetToolTip(
+		_("Uses a windowed sinc filter instead of cubic interpolation to convert the game audio to "
+			"the output sample rate. Reduces aliasing at a small CPU cost."));
 
 	const int space5 = FromDIP(5);
 
@@ -67,6 +71,9 @@ void AudioConfigPane::InitializeGUI()
 	dsp_engine_sizer->Add(m_time_stretching_checkbox, 0, wxLEFT | wxRIGHT, space5);
 	dsp_engine_sizer->AddStretchSpacer();
 	dsp_engine_sizer->AddSpacer(space5);
+	dsp_engine_sizer->Add(m_sinc_resampling_checkbox, 0, wxLEFT | wxRIGHT, space5);
+	dsp_engine_sizer->AddStretchSpacer();
+	dsp_engine_sizer->AddSpacer(space5);
 	dsp_engine_sizer->Add(m_RS_Hack_checkbox, 0, wxLEFT | wxRIGHT, space5);
 	dsp_engine_sizer->AddStretchSpacer();
 	dsp_engine_sizer->AddSpacer(space5);
@@ -129,6 +136,7 @@ void AudioConfigPane::LoadGUIValues()
 	m_audio_latency_spinctrl->SetValue(startup_params.iLatency);
 
 	m_time_stretching_checkbox->SetValue(startup_params.bTimeStretching);
+	m_sinc_resampling_checkbox->SetValue(startup_params.bSincResampling);
 	m_RS_Hack_checkbox->SetValue(startup_params.bRSHACK);
 }
 
@@ -162,6 +170,7 @@ void AudioConfigPane::BindEvents()
 	m_audio_latency_spinctrl->Bind(wxEVT_SPINCTRL, &AudioConfigPane::OnLatencySpinCtrlChanged, this);
 	m_audio_latency_spinctrl->Bind(wxEVT_UPDATE_UI, &WxEventUtils::OnEnableIfCoreNotRunning);
 	m_time_stretching_checkbox->Bind(wxEVT_CHECKBOX, &AudioConfigPane::OnTimeStretchingCheckBoxChanged, this);
+	m_sinc_resampling_checkbox->Bind(wxEVT_CHECKBOX, &AudioConfigPane::OnSincResamplingCheckBoxChanged, this);
 	m_RS_Hack_checkbox->Bind(wxEVT_CHECKBOX, &AudioConfigPane::OnRS_Hack_checkboxChanged, this);
 }
 
@@ -182,6 +191,11 @@ void AudioConfigPane::OnTimeStretchingCheckBoxChanged(wxCommandEvent&)
 	SConfig::GetInstance().bTimeStretching = m_time_stretching_checkbox->IsChecked();
 }
 
+void AudioConfigPane::OnSincResamplingCheckBoxChanged(wxCommandEvent&)
+{
+	SConfig::GetInstance().bSincResampling = m_sinc_resampling_checkbox->IsChecked();
+}
+
 void AudioConfigPane::OnRS_Hack_checkboxChanged(wxCommandEvent&)
 {
 	SConfig::GetInstance().bRSHACK = m_RS_Hack_checkbox->IsChecked();
@@ -30,6 +30,7 @@
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
 #include "Common/Swap.h"
+#include "Core/ConfigManager.h"
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoPlaybackAnalyzer.h"
 #include "Core/FifoPlayer/FifoPlayer.h"
@@ -168,6 +169,11 @@ void FifoPlayerDlg::CreateGUIControls()
 		m_FramesToRecordCtrl =
 			new wxSpinCtrl(m_RecordPage, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
 				wxSP_ARROW_KEYS, 0, 10000, m_FramesToRecord);
+		m_CompressRecording = new wxCheckBox(m_RecordPage, wxID_ANY, _("Compress"));
+		m_CompressRecording->SetValue(SConfig::GetInstance().bCompressFifoLogs);
+		m_CompressRecording->SetToolTip(
+			_("Compresses the recorded frames and writes them to disk while recording, so that long "
+				"recordings don't run out of memory. Saved files can't be loaded by older versions."));
 
 		wxStaticBoxSizer* sRecordInfo =
 			new wxStaticBoxSizer(wxVERTICAL, m_RecordPage, _("Recording Info"));
@@ -192,6 +198,9 @@ void FifoPlayerDlg::CreateGUIControls()
 		sRecordingOptions->Add(m_FramesToRecordCtrl, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxBOTTOM,
 			space5);
 		sRecordingOptions->AddSpacer(space5);
+		sRecordingOptions->Add(m_CompressRecording, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxBOTTOM,
+			space5);
+		sRecordingOptions->AddSpacer(space5);
 
 		wxBoxSizer* sRecordPage = new wxBoxSizer(wxVERTICAL);
 		sRecordPage->Add(sRecordInfo, 0, wxEXPAND);
@@ -299,6 +308,7 @@ void FifoPlayerDlg::CreateGUIControls()
 	m_RecordStop->Bind(wxEVT_BUTTON, &FifoPlayerDlg::OnRecordStop, this);
 	m_Save->Bind(wxEVT_BUTTON, &FifoPlayerDlg::OnSaveFile, this);
 	m_FramesToRecordCtrl->Bind(wxEVT_SPINCTRL, &FifoPlayerDlg::OnNumFramesToRecord, this);
+	m_CompressRecording->Bind(wxEVT_CHECKBOX, &FifoPlayerDlg::OnCheckCompressRecording, this);
 
 	m_framesList->Bind(wxEVT_LISTBOX, &FifoPlayerDlg::OnFrameListSelectionChanged, this);
 	m_objectsList->Bind(wxEVT_LISTBOX, &FifoPlayerDlg::OnObjectListSelectionChanged, this);
@@ -425,6 +435,11 @@ void FifoPlayerDlg::OnNumFramesToRecord(wxSpinEvent& event)
 		m_FramesToRecord = -1;
 }
 
+void FifoPlayerDlg::OnCheckCompressRecording(wxCommandEvent& event)
+{
+	SConfig::GetInstance().bCompressFifoLogs = event.IsChecked();
+}
+
 void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
 {
 	wxString str_search_val = m_searchField->GetValue();
@@ -907,13 +922,7 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
 	FifoDataFile* file = FifoRecorder::GetInstance().GetRecordedFile();
 
 	if (file)
-	{
-		size_t fifoBytes = 0;
-		for (size_t i = 0; i < file->GetFrameCount(); ++i)
-			fifoBytes += file->GetFrame(i).fifoData.size();
-
-		return wxString::Format(_("%zu FIFO bytes"), fifoBytes);
-	}
+		return wxString::Format(_("%zu FIFO bytes"), static_cast<size_t>(file->GetFifoDataSize()));
 
 	return _("No recorded file");
 }
@@ -924,15 +933,8 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
 
 	if (file)
 	{
-		size_t memBytes = 0;
-		for (size_t frameNum = 0; frameNum < file->GetFrameCount(); ++frameNum)
-		{
-			const std::vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
-			for (const auto& memUpdate : memUpdates)
-				memBytes += memUpdate.data.size();
-		}
-
-		return wxString::Format(_("%zu memory bytes"), memBytes);
+		return wxString::Format(_("%zu memory bytes"),
+			static_cast<size_t>(file->GetMemoryUpdateSize()));
 	}
 
 	return wxEmptyString;
@@ -251,11 +251,11 @@ wxSizer* NetPlayDialog::CreateBottomGUI(wxWindow* parent)
 		m_start_btn->Bind(wxEVT_BUTTON, &NetPlayDialog::OnStart, this);
 
 		wxStaticText* buffer_lbl = new wxStaticText(parent, wxID_ANY, _("Buffer:"));
-		wxSpinCtrl* const padbuf_spin =
+		m_padbuf_spin =
 			new wxSpinCtrl(parent, wxID_ANY, std::to_string(INITIAL_PAD_BUFFER_SIZE), wxDefaultPosition,
 				wxDefaultSize, wxSP_ARROW_KEYS, 0, 200, INITIAL_PAD_BUFFER_SIZE);
-		padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
-		padbuf_spin->SetMinSize(WxUtils::GetTextWidgetMinSize(padbuf_spin));
+		m_padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
+		m_padbuf_spin->SetMinSize(WxUtils::GetTextWidgetMinSize(m_padbuf_spin));
 
 		m_memcard_write = new wxCheckBox(parent, wxID_ANY, _("Write save/SD data"));
 
@@ -263,7 +263,7 @@ wxSizer* NetPlayDialog::CreateBottomGUI(wxWindow* parent)
 
 		bottom_szr->Add(m_start_btn, 0, wxALIGN_CENTER_VERTICAL);
 		bottom_szr->Add(buffer_lbl, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
-		bottom_szr->Add(padbuf_spin, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
+		bottom_szr->Add(m_padbuf_spin, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
 		bottom_szr->Add(m_memcard_write, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
 		bottom_szr->Add(m_copy_wii_save, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
 		bottom_szr->AddSpacer(space5);
@@ -590,6 +590,10 @@ void NetPlayDialog::OnThread(wxThreadEvent& event)
 	break;
 	case NP_GUI_EVT_PAD_BUFFER_CHANGE:
 	{
+		// The server may have changed it on its own (adaptive buffer)
+		if (m_padbuf_spin)
+			m_padbuf_spin->SetValue(m_pad_buffer);
+
 		std::string msg = StringFromFormat("Pad buffer: %d", m_pad_buffer);
 
 		if (g_ActiveConfig.bShowNetPlayMessages)
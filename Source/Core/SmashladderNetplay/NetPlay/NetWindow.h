@@ -32,6 +32,7 @@ class wxCheckBox;
 class wxChoice;
 class wxListBox;
 class wxSizer;
+class wxSpinCtrl;
 class wxStaticText;
 class wxString;
 class wxTextCtrl;
@@ -143,6 +144,7 @@ private:
 	wxCheckBox* m_memcard_write;
 	wxCheckBox* m_copy_wii_save;
 	wxCheckBox* m_record_chkbox;
+	wxSpinCtrl* m_padbuf_spin = nullptr;
 
 	std::string m_selected_game;
 	wxButton* m_player_config_btn;
@@ -166,6 +166,7 @@ static wxString dump_textures_desc = _("Dump decoded game textures to User/Dump/
 static wxString dump_VertexTranslators_desc = _("Dump Vertex translator code to User/Dump/\n\nIf unsure, leave this unchecked.");
 static wxString fullAsyncShaderCompilation_desc = _("Make shader compilation proccess fully asynchronous. This can cause glitches but will give a smooth game experience.");
 static wxString compute_texture_decoding_desc = _("Decode Textures using compute shaders. Can Increase Performance in some scenarios.");
+static wxString async_texture_decoding_desc = _("Decode and upscale new textures on worker threads. A low resolution version of the texture is shown for a frame or two until they are done.\nReduces stuttering when many textures are loaded at once.\n\nIf unsure, leave this unchecked.");
 static wxString Compute_texture_encoding_desc = _("Encode Textures using compute shaders. Can Increase Performance in some scenarios.");
 static wxString waitforshadercompilation_desc = _("Wait for shader compilation in the cpu to avoid fifo problems. This option prevents loops in F-Zero, Metroid Prime fifo resets and others.");
 static wxString predictiveFifo_desc = _("Generate a secondary fifo to predict resource usage and improve loading time.");
@@ -887,6 +888,7 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string &title)
 			szr_other->Add(Async_Shader_compilation = CreateCheckBox(page_hacks, _("Full Async Shader Compilation"), (fullAsyncShaderCompilation_desc), vconfig.bFullAsyncShaderCompilation));
 			szr_other->Add(Compute_Shader_decoding = CreateCheckBox(page_hacks, _("Compute Texture Decoding"), (compute_texture_decoding_desc), vconfig.bEnableComputeTextureDecoding));
 			szr_other->Add(Compute_Shader_encoding = CreateCheckBox(page_hacks, _("Compute Texture Encoding"), (Compute_texture_encoding_desc), vconfig.bEnableComputeTextureEncoding));
+			szr_other->Add(CreateCheckBox(page_hacks, _("Asynchronous Texture Decoding"), (async_texture_decoding_desc), vconfig.bAsyncTextureDecoding));
 			wxStaticBoxSizer* const group_other = new wxStaticBoxSizer(wxVERTICAL, page_hacks, _("Other"));
 			group_other->Add(szr_other, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
 			szr_hacks->Add(group_other, 0, wxEXPAND | wxALL, 5);
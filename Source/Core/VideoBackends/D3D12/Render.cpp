@@ -1485,7 +1485,6 @@ void  Renderer::DumpFrame(const EFBRectangle& source_rc, u32 xfb_addr,
 	AVIDump::Frame state = AVIDump::FetchState(ticks);
 	DumpFrameData(reinterpret_cast<const u8*>(screenshot_texture_map), box_width, box_height,
 		dst_location.PlacedFootprint.Footprint.RowPitch, state);
-	FinishFrameData();
 
 	D3D12_RANGE write_range = {};
 	m_frame_dump_buffer->Unmap(0, &write_range);
@@ -76,6 +76,8 @@ void VideoBackend::InitBackendInfo()
 	const int maxConstants = (shaderModel < 3) ? 32 : ((shaderModel < 4) ? 224 : 65536);
 	g_Config.backend_info.APIType = shaderModel < 3 ? API_D3D9_SM20 : API_D3D9_SM30;
 	g_Config.backend_info.MaxTextureSize = static_cast<u32>(device_caps.MaxTextureWidth);
+	// D3D9 class hardware tends to have less video memory
+	g_Config.backend_info.DefaultTextureMemoryBudget = 512;
 	g_Config.backend_info.bSupportsExclusiveFullscreen = false;
 	g_Config.backend_info.bSupportsSeparateAlphaFunction = (device_caps.PrimitiveMiscCaps & D3DPMISCCAPS_SEPARATEALPHABLEND) == D3DPMISCCAPS_SEPARATEALPHABLEND;
 	// Dual source blend disabled by default until a proper method to test for support is found	
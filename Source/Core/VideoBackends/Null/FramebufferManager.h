@@ -0,0 +1,43 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/RenderBase.h"
+
+namespace Null
+{
+class XFBSource : public XFBSourceBase
+{
+public:
+	void DecodeToTexture(u32 xfbAddr, u32 fbWidth, u32 fbHeight) override {}
+	void CopyEFB(float Gamma) override {}
+};
+
+class FramebufferManager : public FramebufferManagerBase
+{
+public:
+	void GetTargetSize(unsigned int* width, unsigned int* height) override
+	{
+		*width = Renderer::GetTargetWidth();
+		*height = Renderer::GetTargetHeight();
+	}
+
+private:
+	std::unique_ptr<XFBSourceBase> CreateXFBSource(unsigned int target_width, unsigned int target_height,
+		unsigned int layers) override
+	{
+		return std::make_unique<XFBSource>();
+	}
+
+	void CopyToRealXFB(u32 xfbAddr, u32 fbStride, u32 fbHeight, const EFBRectangle& sourceRc,
+		float Gamma = 1.0f) override
+	{
+	}
+};
+}
@@ -0,0 +1,61 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/Render.h"
+
+#include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+// Init functions
+Renderer::Renderer()
+{
+	g_Config.bRunning = true;
+	UpdateActiveConfig();
+
+	// There is no window, so pretend the output has the size of the largest XFB.
+	FramebufferManagerBase::SetLastXfbWidth(MAX_XFB_WIDTH);
+	FramebufferManagerBase::SetLastXfbHeight(MAX_XFB_HEIGHT);
+	s_backbuffer_width = MAX_XFB_WIDTH;
+	s_backbuffer_height = MAX_XFB_HEIGHT;
+	s_last_efb_scale = g_ActiveConfig.iEFBScale;
+	UpdateDrawRectangle();
+	CalculateTargetSize();
+	PixelShaderManager::SetEfbScaleChanged();
+}
+
+Renderer::~Renderer()
+{
+	g_Config.bRunning = false;
+	UpdateActiveConfig();
+}
+
+void Renderer::RenderText(const std::string& text, int left, int top, u32 color)
+{
+	// Called every frame for the on-screen display, there is nothing to draw it on
+}
+
+TargetRectangle Renderer::ConvertEFBRectangle(const EFBRectangle& rc)
+{
+	TargetRectangle result;
+	result.left = EFBToScaledX(rc.left);
+	result.top = EFBToScaledY(rc.top);
+	result.right = EFBToScaledX(rc.right);
+	result.bottom = EFBToScaledY(rc.bottom);
+	return result;
+}
+
+void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height,
+	const EFBRectangle& rc, u64 ticks, float gamma)
+{
+	// Nothing is presented, but the per-frame bookkeeping of the real backends still runs so the
+	// CPU-side cost stays comparable.
+	UpdateDrawRectangle();
+	UpdateActiveConfig();
+	g_texture_cache->Cleanup(frameCount);
+}
+}
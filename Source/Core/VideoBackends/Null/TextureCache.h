@@ -0,0 +1,82 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+// Textures are decoded into the shared temporary buffer and then dropped, so the cache
+// bookkeeping, hashing and decoding cost the same as with a real backend.
+class TextureCache : public TextureCacheBase
+{
+public:
+	struct TCacheEntry : TCacheEntryBase
+	{
+		TCacheEntry(const TCacheEntryConfig& _config) : TCacheEntryBase(_config) {}
+		~TCacheEntry() {}
+
+		void Load(const u8* src, u32 width, u32 height, u32 expanded_width, u32 level) override {}
+		void LoadMaterialMap(const u8* src, u32 width, u32 height, u32 level) override {}
+		void Load(const u8* src, u32 width, u32 height, u32 expandedWidth, u32 expandedHeight,
+			const s32 texformat, const u32 tlutaddr, const TlutFormat tlutfmt, u32 level) override
+		{
+			TexDecoder_Decode(g_texture_cache->GetTemporalBuffer(), src, expandedWidth, expandedHeight,
+				texformat, tlutaddr, tlutfmt, true, false);
+		}
+		void LoadFromTmem(const u8* ar_src, const u8* gb_src, u32 width, u32 height,
+			u32 expanded_width, u32 expanded_Height, u32 level) override
+		{
+			TexDecoder_DecodeRGBA8FromTmem(reinterpret_cast<u32*>(g_texture_cache->GetTemporalBuffer()),
+				ar_src, gb_src, expanded_width, expanded_Height);
+		}
+
+		void FromRenderTarget(bool is_depth_copy, const EFBRectangle& srcRect, bool scaleByHalf,
+			unsigned int cbufid, const float* colmat, u32 width, u32 height) override
+		{
+		}
+		void CopyRectangleFromTexture(const TCacheEntryBase* source,
+			const MathUtil::Rectangle<int>& src_rect,
+			const MathUtil::Rectangle<int>& dst_rect) override
+		{
+		}
+
+		void Bind(u32 stage) override {}
+		bool Save(const std::string& filename, unsigned int level) override { return false; }
+		bool SupportsMaterialMap() const override { return false; }
+		uintptr_t GetInternalObject() override { return 0; }
+	};
+
+	TextureCache() {}
+	~TextureCache() {}
+
+	bool CompileShaders() override { return true; }
+	void DeleteShaders() override {}
+
+	TCacheEntryBase* CreateTexture(const TCacheEntryConfig& config) override
+	{
+		return new TCacheEntry(config);
+	}
+
+	void CopyEFB(u8* dst, u32 format, u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
+		u32 memory_stride, bool is_depth_copy, const EFBRectangle& src_rect,
+		bool is_intensity, bool scale_by_half) override
+	{
+	}
+
+private:
+	bool Palettize(TCacheEntryBase* entry, const TCacheEntryBase* base_entry) override { return false; }
+	void LoadLut(u32 lutFmt, void* addr, u32 size) override {}
+	PC_TexFormat GetNativeTextureFormat(const s32 texformat, const TlutFormat tlutfmt, u32 width, u32 height) override
+	{
+		return PC_TEX_FMT_RGBA32;
+	}
+};
+}
@@ -0,0 +1,57 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/VertexManager.h"
+
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexLoaderManager.h"
+
+namespace Null
+{
+class NullNativeVertexFormat : public NativeVertexFormat
+{
+public:
+	NullNativeVertexFormat(const PortableVertexDeclaration& vtx_decl_) { vtx_decl = vtx_decl_; }
+	void SetupVertexPointers() override {}
+};
+
+std::unique_ptr<NativeVertexFormat>
+VertexManager::CreateNativeVertexFormat(const PortableVertexDeclaration& vtx_decl)
+{
+	return std::make_unique<NullNativeVertexFormat>(vtx_decl);
+}
+
+VertexManager::VertexManager() : m_local_v_buffer(MAXVBUFFERSIZE), m_local_i_buffer(MAXIBUFFERSIZE)
+{
+}
+
+VertexManager::~VertexManager()
+{
+}
+
+void VertexManager::ResetBuffer(u32 stride)
+{
+	s_pCurBufferPointer = s_pBaseBufferPointer = m_local_v_buffer.data();
+	s_pEndBufferPointer = s_pBaseBufferPointer + m_local_v_buffer.size();
+	IndexGenerator::Start(m_local_i_buffer.data());
+}
+
+u16* VertexManager::GetIndexBuffer()
+{
+	return m_local_i_buffer.data();
+}
+
+void VertexManager::PrepareShaders(PrimitiveType primitive, u32 components, const XFMemory &xfr, const BPMemory &bpm, bool ongputhread)
+{
+	const bool use_dst_alpha = bpm.dstalpha.enable && bpm.blendmode.alphaupdate &&
+		bpm.zcontrol.pixel_format == PEControl::RGBA6_Z24;
+	GetVertexShaderUID(m_vs_uid, components, xfr, bpm);
+	GetPixelShaderUID(m_ps_uid,
+		use_dst_alpha ? PIXEL_SHADER_RENDER_MODE::PSRM_DUAL_SOURCE_BLEND : PIXEL_SHADER_RENDER_MODE::PSRM_DEFAULT,
+		components, xfr, bpm);
+	GetGeometryShaderUid(m_gs_uid, primitive, xfr, components);
+}
+}
@@ -0,0 +1,43 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/GeometryShaderGen.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
+
+namespace Null
+{
+class VertexManager : public VertexManagerBase
+{
+public:
+	VertexManager();
+	~VertexManager();
+
+	std::unique_ptr<NativeVertexFormat>
+		CreateNativeVertexFormat(const PortableVertexDeclaration& vtx_decl) override;
+	void PrepareShaders(PrimitiveType primitive, u32 components, const XFMemory &xfr, const BPMemory &bpm, bool ongputhread = true) override;
+
+protected:
+	void ResetBuffer(u32 stride) override;
+	u16* GetIndexBuffer() override;
+
+private:
+	void vFlush(bool use_dst_alpha) override {}
+
+	std::vector<u8> m_local_v_buffer;
+	std::vector<u16> m_local_i_buffer;
+
+	// Shader selection of the last draw, computing these is part of the CPU cost of a draw.
+	VertexShaderUid m_vs_uid;
+	PixelShaderUid m_ps_uid;
+	GeometryShaderUid m_gs_uid;
+};
+}
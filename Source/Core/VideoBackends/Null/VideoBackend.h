@@ -0,0 +1,28 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace Null
+{
+// Backend without any GPU work: the whole VideoCommon pipeline (command processing, vertex
+// loading, shader UID generation, texture decoding) runs on the CPU, but nothing is drawn.
+// Meant for headless runs and for measuring the CPU side of the video emulation.
+class VideoBackend : public VideoBackendBase
+{
+	bool Initialize(void* window_handle) override;
+	void Shutdown() override;
+
+	std::string GetName() const override { return "Null"; }
+	std::string GetDisplayName() const override { return "Null"; }
+	void Video_Prepare() override;
+	void Video_Cleanup() override;
+
+	void InitBackendInfo() override;
+
+	unsigned int PeekMessages() override { return 0; }
+};
+}
@@ -0,0 +1,92 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/FramebufferManager.h"
+#include "VideoBackends/Null/Render.h"
+#include "VideoBackends/Null/TextureCache.h"
+#include "VideoBackends/Null/VertexManager.h"
+#include "VideoBackends/Null/VideoBackend.h"
+
+#include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+void VideoBackend::InitBackendInfo()
+{
+	g_Config.backend_info.APIType = API_NONE;
+	g_Config.backend_info.MaxTextureSize = 16384;
+	g_Config.backend_info.bSupportsExclusiveFullscreen = true;
+	g_Config.backend_info.bSupportsDualSourceBlend = true;
+	g_Config.backend_info.bSupportsPixelLighting = true;
+	g_Config.backend_info.bSupportsNormalMaps = false;
+	g_Config.backend_info.bSupportsSeparateAlphaFunction = true;
+	g_Config.backend_info.bSupportsOversizedDepthRanges = true;
+	g_Config.backend_info.bSupportsBindingLayout = true;
+	g_Config.backend_info.bSupportsEarlyZ = true;
+	g_Config.backend_info.bNeedBlendIndices = false;
+	g_Config.backend_info.bSupportsOversizedViewports = true;
+	g_Config.backend_info.bSupportsPostProcessing = false;
+	g_Config.backend_info.bSupportsGeometryShaders = true;
+	g_Config.backend_info.bSupports3DVision = false;
+	g_Config.backend_info.bSupportsBBox = true;
+	g_Config.backend_info.bSupportsGSInstancing = true;
+	g_Config.backend_info.bSupportsPaletteConversion = false;
+	g_Config.backend_info.bSupportsClipControl = true;
+	g_Config.backend_info.bSupportsSSAA = true;
+	g_Config.backend_info.bSupportsTessellation = false;
+	g_Config.backend_info.bSupportsScaling = false;
+	g_Config.backend_info.bSupportsDepthClamp = true;
+	g_Config.backend_info.bSupportsComputeTextureDecoding = false;
+	g_Config.backend_info.bSupportsComputeTextureEncoding = false;
+	g_Config.backend_info.bSupportsMultithreading = false;
+	g_Config.backend_info.bSupportsValidationLayer = false;
+	g_Config.backend_info.bSupportsReversedDepthRange = true;
+	g_Config.backend_info.bSupportsInternalResolutionFrameDumps = false;
+	g_Config.backend_info.bSupportsAsyncShaderCompilation = false;
+
+	// Textures are always decoded to RGBA8 on the CPU, like the slowest path of the real backends.
+	for (bool& supported : g_Config.backend_info.bSupportedFormats)
+		supported = false;
+	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_RGBA32] = true;
+
+	// aamodes: We only support 1 sample, so no MSAA
+	g_Config.backend_info.Adapters.clear();
+	g_Config.backend_info.AAModes = { 1 };
+}
+
+bool VideoBackend::Initialize(void* window_handle)
+{
+	InitBackendInfo();
+	InitializeShared();
+
+	g_renderer = std::make_unique<Renderer>();
+	g_framebuffer_manager = std::make_unique<FramebufferManager>();
+	g_vertex_manager = std::make_unique<VertexManager>();
+	g_texture_cache = std::make_unique<TextureCache>();
+	g_perf_query = std::make_unique<PerfQueryBase>();
+	return true;
+}
+
+void VideoBackend::Video_Prepare()
+{
+}
+
+void VideoBackend::Shutdown()
+{
+	ShutdownShared();
+}
+
+void VideoBackend::Video_Cleanup()
+{
+	g_perf_query.reset();
+	g_texture_cache.reset();
+	g_vertex_manager.reset();
+	g_framebuffer_manager.reset();
+	g_renderer.reset();
+
+	CleanupShared();
+}
+}
@@ -834,10 +834,6 @@ void Renderer::WriteFrameDumpImage(size_t index)
 
 StagingTexture2D* Renderer::PrepareFrameDumpImage(u32 width, u32 height, u64 ticks)
 {
-	// Ensure the last frame that was sent to the frame dump has completed encoding before we send
-	// the next image to it.
-	FinishFrameData();
-
 	// If the last image hasn't been written to the frame dump yet, write it now.
 	// This is necessary so that the worker thread is no more than one frame behind, and the pointer
 	// (which is actually the buffer) is safe for us to re-use next time.
@@ -16,6 +16,7 @@
 
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/PhaseProfiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
@@ -156,7 +157,10 @@ void VertexManager::vFlush(bool use_dst_alpha)
 		dstalpha_mode = PIXEL_SHADER_RENDER_MODE::PSRM_DUAL_SOURCE_BLEND;
 
 	// Check for any shader stage changes
-	StateTracker::GetInstance()->CheckForShaderChanges(current_primitive_type, VertexLoaderManager::g_current_components, dstalpha_mode);
+	{
+		PhaseProfiler::ScopedPhase shader_phase(PhaseProfiler::PHASE_SHADER_LOOKUP);
+		StateTracker::GetInstance()->CheckForShaderChanges(current_primitive_type, VertexLoaderManager::g_current_components, dstalpha_mode);
+	}
 
 	// Update any changed constants
 	StateTracker::GetInstance()->UpdateVertexShaderConstants();
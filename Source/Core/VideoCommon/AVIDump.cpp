@@ -178,6 +178,9 @@ bool AVIDump::CreateVideoFile()
 	s_codec_context->time_base.den = VideoInterface::GetTargetRefreshRate();
 	s_codec_context->gop_size = 12;
 	s_codec_context->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+	// Encode on all cores, a single thread can't keep up with high resolution dumps
+	s_codec_context->thread_count = 0;
+	s_codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
 	if (output_format->flags & AVFMT_GLOBALHEADER)
 		s_codec_context->flags |= CODEC_FLAG_GLOBAL_HEADER;
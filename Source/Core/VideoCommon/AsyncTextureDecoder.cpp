@@ -0,0 +1,104 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/AsyncTextureDecoder.h"
+
+#include <cstring>
+
+#include "Common/Align.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureScalerCommon.h"
+
+void AsyncTextureDecodeUnit::AddLevel(u32 width, u32 height, u32 expanded_width, u32 expanded_height)
+{
+	Level level;
+	level.source_offset = source_size;
+	level.offset = Common::AlignUp(decoded.size(), 16);
+	level.width = width;
+	level.height = height;
+	level.expanded_width = expanded_width;
+	level.expanded_height = expanded_height;
+	levels.push_back(level);
+
+	// The scaler works on the expanded width but only the real height, like the backends do
+	size_t size = scaling_factor ?
+		size_t(expanded_width * scaling_factor) * (height * scaling_factor) * 4 :
+		size_t(expanded_width) * expanded_height * 4;
+	decoded.resize(level.offset + size);
+	source_size += TexDecoder_GetTextureSizeInBytes(expanded_width, expanded_height, texformat);
+}
+
+AsyncTextureDecoder::AsyncTextureDecoder() :
+	m_input(MAX_PENDING_UNITS * 2),
+	m_pending(0),
+	m_scaler(std::make_unique<TextureScaler>())
+{
+	Common::ThreadPool::RegisterWorker(this);
+}
+
+AsyncTextureDecoder::~AsyncTextureDecoder()
+{
+	// Once unregistered no pool thread is in NextTask anymore, the rest is decoded here
+	Common::ThreadPool::UnregisterWorker(this);
+	WaitForIdle();
+}
+
+bool AsyncTextureDecoder::NextTask()
+{
+	AsyncTextureDecodeUnit* unit;
+	if (!m_input.try_pop(unit))
+		return false;
+	Decode(unit);
+	// The unit may be freed as soon as done is set
+	unit->done.store(true);
+	m_pending.fetch_sub(1);
+	return true;
+}
+
+bool AsyncTextureDecoder::Queue(AsyncTextureDecodeUnit* unit)
+{
+	if (m_pending.load() >= MAX_PENDING_UNITS)
+		return false;
+	m_pending.fetch_add(1);
+	m_input.push(unit);
+	Common::ThreadPool::NotifyWorkPending();
+	return true;
+}
+
+void AsyncTextureDecoder::WaitForIdle()
+{
+	while (m_pending.load() > 0)
+	{
+		if (!NextTask())
+			Common::YieldCPU();
+	}
+}
+
+void AsyncTextureDecoder::Decode(AsyncTextureDecodeUnit* unit)
+{
+	std::vector<u8> scratch;
+	for (const AsyncTextureDecodeUnit::Level& level : unit->levels)
+	{
+		const u8* src = unit->source.data() + level.source_offset;
+		u8* dst = unit->decoded.data() + level.offset;
+		if (!unit->scaling_factor)
+		{
+			TexDecoder_Decode(dst, src, level.expanded_width, level.expanded_height, unit->texformat, 0,
+				GX_TL_IA8, unit->rgba_only, unit->compressed);
+		}
+		else
+		{
+			scratch.resize(size_t(level.expanded_width) * level.expanded_height * 4);
+			TexDecoder_Decode(scratch.data(), src, level.expanded_width, level.expanded_height,
+				unit->texformat, 0, GX_TL_IA8, unit->rgba_only, unit->compressed);
+
+			std::lock_guard<std::mutex> lk(m_scaler_lock);
+			const u32* scaled = m_scaler->Scale(reinterpret_cast<u32*>(scratch.data()),
+				level.expanded_width, level.height, unit->scaling_factor, unit->scaling_type,
+				unit->deposterize);
+			memcpy(dst, scaled, size_t(level.expanded_width * unit->scaling_factor) *
+				(level.height * unit->scaling_factor) * 4);
+		}
+	}
+}
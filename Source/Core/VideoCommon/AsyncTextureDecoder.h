@@ -0,0 +1,76 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
+
+class TextureScaler;
+
+// A texture to decode (and optionally upscale) off the GPU thread.
+// The GPU thread fills in the inputs and the level layout, the worker fills decoded and sets done.
+struct AsyncTextureDecodeUnit
+{
+	// Dimensions are those of the level in emulated memory, upscaled levels are
+	// scaling_factor times as large in decoded
+	struct Level
+	{
+		size_t source_offset;
+		size_t offset;
+		u32 width;
+		u32 height;
+		u32 expanded_width;
+		u32 expanded_height;
+	};
+
+	// Copy of the texture and all its mips, as they were in emulated memory
+	std::vector<u8> source;
+	size_t source_size = 0;
+	u32 texformat = 0;
+	bool rgba_only = false;
+	bool compressed = false;
+	// 0 if the texture is not upscaled
+	int scaling_factor = 0;
+	int scaling_type = 0;
+	bool deposterize = false;
+
+	// Where each level ends up in decoded
+	std::vector<Level> levels;
+	std::vector<u8> decoded;
+	std::atomic<bool> done{ false };
+
+	// Call after setting the format and scaling options
+	void AddLevel(u32 width, u32 height, u32 expanded_width, u32 expanded_height);
+};
+
+class AsyncTextureDecoder final : Common::IWorker
+{
+public:
+	// Units queued at the same time; beyond this textures are loaded synchronously
+	static const s32 MAX_PENDING_UNITS = 64;
+
+	AsyncTextureDecoder();
+	~AsyncTextureDecoder();
+
+	bool NextTask() override;
+	// Returns false if too many units are in flight already
+	bool Queue(AsyncTextureDecodeUnit* unit);
+	// Processes queued units on the calling thread until no unit is pending anymore
+	void WaitForIdle();
+
+private:
+	void Decode(AsyncTextureDecodeUnit* unit);
+
+	Common::ManyToManyQueue<AsyncTextureDecodeUnit*, Common::CircularQueue<AsyncTextureDecodeUnit*>> m_input;
+	std::atomic<s32> m_pending;
+	// TextureScaler keeps its buffers in the instance, so only one unit is scaled at a time
+	std::mutex m_scaler_lock;
+	std::unique_ptr<TextureScaler> m_scaler;
+};
@@ -11,7 +11,6 @@
 #include <thread>
 #include <utility>
 #include <vector>
-#include <xxhash.h>
 
 #include <SOIL/SOIL.h>
 
@@ -19,6 +18,7 @@
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/Flag.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
@@ -335,10 +335,10 @@ std::string HiresTexture::GenBaseName(
 	if ((!dump || convert) && s_check_native_format)
 	{
 		// try to load the old format first
-		u64 tex_hash = GetHashHiresTexture(texture, (int)texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+		u64 tex_hash = GetLegacyHiresTextureHash(texture, (int)texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 		u64 tlut_hash = 0;
 		if (tlut_size)
-			tlut_hash = GetHashHiresTexture(tlut, (int)tlut_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+			tlut_hash = GetLegacyHiresTextureHash(tlut, (int)tlut_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 		name = StringFromFormat("%s_%08x_%i", SConfig::GetInstance().GetGameID().c_str(), (u32)(tex_hash ^ tlut_hash), (u16)format);
 		convert_iter = s_textureMap.find(name);
 		if (convert_iter != s_textureMap.end())
@@ -386,10 +386,10 @@ std::string HiresTexture::GenBaseName(
 			tlut_size = 2 * (max + 1 - min);
 			tlut += 2 * min;
 		}
-		u64 tex_hash = XXH64(texture, texture_size);
+		u64 tex_hash = GetHiresTextureHash(texture, static_cast<u32>(texture_size));
 		u64 tlut_hash = 0;
 		if (tlut_size)
-			tlut_hash = XXH64(tlut, tlut_size);
+			tlut_hash = GetHiresTextureHash(tlut, static_cast<u32>(tlut_size));
 		std::string basename = s_format_prefix + StringFromFormat("%dx%d%s_%016" PRIx64, width, height, has_mipmaps ? "_m" : "", tex_hash);
 		std::string tlutname = tlut_size ? StringFromFormat("_%016" PRIx64, tlut_hash) : "";
 		std::string formatname = StringFromFormat("_%d", format);
@@ -23,6 +23,7 @@
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/PhaseProfiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -161,6 +162,7 @@ void Init()
 template <bool is_preprocess, bool sizeCheck>
 u8* Run(DataReader& reader, u32* cycles)
 {
+	PhaseProfiler::ScopedPhase phase(PhaseProfiler::PHASE_OPCODE_DECODING, !is_preprocess);
 	u32 totalCycles = 0;
 	u8* opcodeStart;
 	while (true)
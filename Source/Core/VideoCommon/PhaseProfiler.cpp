@@ -0,0 +1,77 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/PhaseProfiler.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace PhaseProfiler
+{
+using Clock = std::chrono::steady_clock;
+
+static const int NO_PHASE = -1;
+
+std::atomic<bool> g_enabled{false};
+
+static std::array<std::atomic<u64>, NUM_PHASES> s_time_ns;
+
+// Phases are tracked per thread, the GPU thread and the CPU thread (when preprocessing) each
+// have their own nesting.
+static thread_local int s_current_phase = NO_PHASE;
+static thread_local Clock::time_point s_phase_start;
+
+static void ChargeCurrentPhase(Clock::time_point now)
+{
+	if (s_current_phase != NO_PHASE)
+	{
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_phase_start);
+		s_time_ns[s_current_phase].fetch_add(static_cast<u64>(elapsed.count()), std::memory_order_relaxed);
+	}
+	s_phase_start = now;
+}
+
+void SetEnabled(bool enabled)
+{
+	g_enabled.store(enabled);
+}
+
+void Reset()
+{
+	for (auto& time : s_time_ns)
+		time.store(0, std::memory_order_relaxed);
+}
+
+u64 GetTimeNs(Phase phase)
+{
+	return s_time_ns[phase].load(std::memory_order_relaxed);
+}
+
+const char* GetName(Phase phase)
+{
+	static const char* const names[NUM_PHASES] = {
+		"Opcode decoding",
+		"Vertex loading",
+		"Flush",
+		"Shader lookup",
+		"Texture load/decode",
+	};
+	return names[phase];
+}
+
+int EnterPhase(Phase phase)
+{
+	ChargeCurrentPhase(Clock::now());
+	const int previous = s_current_phase;
+	s_current_phase = phase;
+	return previous;
+}
+
+void LeavePhase(int previous)
+{
+	ChargeCurrentPhase(Clock::now());
+	s_current_phase = previous;
+}
+}
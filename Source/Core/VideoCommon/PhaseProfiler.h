@@ -0,0 +1,62 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Wall-clock time spent in the main stages of the video pipeline, used by the FIFO benchmark.
+//
+// Phases nest (vertex loading happens inside opcode decoding, texture loads inside a flush, ...).
+// Time is only charged to the innermost active phase, so the totals add up without counting
+// anything twice. Collection is off by default; a disabled scope costs a single branch.
+
+#pragma once
+
+#include <atomic>
+
+#include "Common/CommonTypes.h"
+
+namespace PhaseProfiler
+{
+enum Phase
+{
+	PHASE_OPCODE_DECODING,
+	PHASE_VERTEX_LOADING,
+	PHASE_FLUSH,
+	PHASE_SHADER_LOOKUP,
+	PHASE_TEXTURE_LOADING,
+	NUM_PHASES
+};
+
+// Set from the host thread, read by the video thread.
+extern std::atomic<bool> g_enabled;
+
+void SetEnabled(bool enabled);
+void Reset();
+u64 GetTimeNs(Phase phase);
+const char* GetName(Phase phase);
+
+// Used by ScopedPhase, returns the phase that was active before.
+int EnterPhase(Phase phase);
+void LeavePhase(int previous);
+
+class ScopedPhase final
+{
+public:
+	explicit ScopedPhase(Phase phase, bool active = true) : m_active(active && g_enabled.load(std::memory_order_relaxed))
+	{
+		if (m_active)
+			m_previous = EnterPhase(phase);
+	}
+	~ScopedPhase()
+	{
+		if (m_active)
+			LeavePhase(m_previous);
+	}
+
+	ScopedPhase(const ScopedPhase&) = delete;
+	ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+	bool m_active;
+	int m_previous = -1;
+};
+}
@@ -12,8 +12,10 @@
 // Next frame, that one is scanned out and the other one gets the copy. = double buffering.
 // ---------------------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -445,7 +447,10 @@ void Renderer::DrawDebugText()
 	final_cyan += Common::Profiler::ToString();
 
 	if (g_ActiveConfig.bOverlayStats)
+	{
 		final_cyan += Statistics::ToString();
+		final_cyan += g_renderer->GetFrameDumpStatsString();
+	}
 
 	if (g_ActiveConfig.bOverlayProjStats)
 		final_cyan += Statistics::ToStringProj();
@@ -782,39 +787,93 @@ bool Renderer::IsFrameDumping()
 
 void Renderer::ShutdownFrameDumping()
 {
-	if (!m_frame_dump_thread_running.IsSet())
+	if (!m_frame_dump_thread_running)
 		return;
 
-	FinishFrameData();
-	m_frame_dump_thread_running.Clear();
-	m_frame_dump_start.Set();
+	// The thread writes the frames still in the queue before it exits
+	{
+		std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+		m_frame_dump_quit = true;
+	}
+	m_frame_dump_queued.notify_one();
+	m_frame_dump_thread_running = false;
 }
 
 void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down, bool bgra)
 {
-	FinishFrameData();
-
-	m_frame_dump_config = FrameDumpConfig{ data, w, h, stride, swap_upside_down, bgra, state };
-
-	if (!m_frame_dump_thread_running.IsSet())
+	if (!m_frame_dump_thread_running)
 	{
 		if (m_frame_dump_thread.joinable())
 			m_frame_dump_thread.join();
-		m_frame_dump_thread_running.Set();
+		m_frame_dump_quit = false;
+		m_frame_dump_stats = {};
+		m_frame_dump_thread_running = true;
 		m_frame_dump_thread = std::thread(&Renderer::RunFrameDumps, this);
 	}
 
-	m_frame_dump_start.Set();
-	m_frame_dump_frame_running = true;
+	const bool screenshot = s_screenshot.TestAndClear();
+	const size_t queue_size = static_cast<size_t>(std::max(g_ActiveConfig.iFrameDumpQueueSize, 1));
+	std::unique_ptr<QueuedFrameDump> frame;
+	{
+		std::unique_lock<std::mutex> lk(m_frame_dump_lock);
+		if (m_frame_dump_free_frames.empty() && m_frame_dump_frames >= queue_size)
+		{
+			// Timing starts with the first frame of a movie dump, so it must not be lost
+			if (g_ActiveConfig.bFrameDumpDropFrames && !screenshot && !state.first_frame)
+			{
+				m_frame_dump_stats.dropped_frames++;
+				return;
+			}
+			m_frame_dump_freed.wait(lk, [this] { return !m_frame_dump_free_frames.empty(); });
+		}
+
+		if (!m_frame_dump_free_frames.empty())
+		{
+			frame = std::move(m_frame_dump_free_frames.back());
+			m_frame_dump_free_frames.pop_back();
+		}
+		else
+		{
+			m_frame_dump_frames++;
+		}
+	}
+	if (!frame)
+		frame = std::make_unique<QueuedFrameDump>();
+
+	// Store the rows top to bottom without padding
+	const size_t row_size = static_cast<size_t>(w) * 4;
+	frame->buffer.resize(row_size * h);
+	for (int y = 0; y < h; y++)
+	{
+		const int source_row = swap_upside_down ? h - 1 - y : y;
+		std::memcpy(&frame->buffer[y * row_size], data + static_cast<ptrdiff_t>(source_row) * stride,
+			row_size);
+	}
+	frame->config = FrameDumpConfig{ frame->buffer.data(), w, h, static_cast<int>(row_size), bgra, state };
+	frame->screenshot = screenshot;
+	frame->queue_time_us = Common::Timer::GetTimeUs();
+
+	{
+		std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+		m_frame_dump_queue.push_back(std::move(frame));
+		m_frame_dump_stats.max_queue_depth =
+			std::max(m_frame_dump_stats.max_queue_depth, m_frame_dump_queue.size());
+	}
+	m_frame_dump_queued.notify_one();
 }
 
-void Renderer::FinishFrameData()
+std::string Renderer::GetFrameDumpStatsString()
 {
-	if (!m_frame_dump_frame_running)
-		return;
-
-	m_frame_dump_done.Wait();
-	m_frame_dump_frame_running = false;
+	if (!m_frame_dump_thread_running)
+		return "";
+
+	std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+	const FrameDumpStats& dump_stats = m_frame_dump_stats;
+	return StringFromFormat("Frame dump queue: %zu (max %zu), dropped: %" PRIu64 "\n"
+		"Frame dump encode: %.2f ms (max %.2f ms), latency max %.2f ms\n",
+		m_frame_dump_queue.size(), dump_stats.max_queue_depth, dump_stats.dropped_frames,
+		dump_stats.frames ? dump_stats.total_encode_time_us / 1000.0 / dump_stats.frames : 0.0,
+		dump_stats.max_encode_time_us / 1000.0, dump_stats.max_latency_us / 1000.0);
 }
 
 void Renderer::RunFrameDumps()
@@ -835,20 +894,21 @@ void Renderer::RunFrameDumps()
 
 	while (true)
 	{
-		m_frame_dump_start.Wait();
-		if (!m_frame_dump_thread_running.IsSet())
-			break;
-
-		auto config = m_frame_dump_config;
-
-		if (config.upside_down)
+		std::unique_ptr<QueuedFrameDump> frame;
 		{
-			config.data = config.data + (config.height - 1) * config.stride;
-			config.stride = -config.stride;
+			std::unique_lock<std::mutex> lk(m_frame_dump_lock);
+			m_frame_dump_queued.wait(lk, [this] { return m_frame_dump_quit || !m_frame_dump_queue.empty(); });
+			if (m_frame_dump_queue.empty())
+				break;
+			frame = std::move(m_frame_dump_queue.front());
+			m_frame_dump_queue.pop_front();
 		}
 
+		const u64 start_time_us = Common::Timer::GetTimeUs();
+		const FrameDumpConfig& config = frame->config;
+
 		// Save screenshot
-		if (s_screenshot.TestAndClear())
+		if (frame->screenshot)
 		{
 			std::lock_guard<std::mutex> lk(s_criticalScreenshot);
 
@@ -885,7 +945,19 @@ void Renderer::RunFrameDumps()
 			}
 		}
 
-		m_frame_dump_done.Set();
+		const u64 end_time_us = Common::Timer::GetTimeUs();
+		{
+			std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+			FrameDumpStats& dump_stats = m_frame_dump_stats;
+			dump_stats.frames++;
+			dump_stats.total_encode_time_us += end_time_us - start_time_us;
+			dump_stats.max_encode_time_us =
+				std::max(dump_stats.max_encode_time_us, end_time_us - start_time_us);
+			dump_stats.max_latency_us =
+				std::max(dump_stats.max_latency_us, end_time_us - frame->queue_time_us);
+			m_frame_dump_free_frames.push_back(std::move(frame));
+		}
+		m_frame_dump_freed.notify_one();
 	}
 
 	if (frame_dump_started)
@@ -893,6 +965,14 @@ void Renderer::RunFrameDumps()
 		// No additional cleanup is needed when dumping to images.
 		if (dump_to_avi)
 			StopFrameDumpToAVI();
+
+		std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+		const FrameDumpStats& dump_stats = m_frame_dump_stats;
+		INFO_LOG(VIDEO, "Frame dump: %" PRIu64 " frames, %" PRIu64 " dropped, max queue depth %zu, "
+			"encode %.2f ms (max %.2f ms), latency max %.2f ms", dump_stats.frames,
+			dump_stats.dropped_frames, dump_stats.max_queue_depth,
+			dump_stats.frames ? dump_stats.total_encode_time_us / 1000.0 / dump_stats.frames : 0.0,
+			dump_stats.max_encode_time_us / 1000.0, dump_stats.max_latency_us / 1000.0);
 	}
 }
 
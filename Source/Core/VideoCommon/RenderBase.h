@@ -14,6 +14,7 @@
 
 #pragma once
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -203,8 +204,8 @@ protected:
 	static void RecordVideoMemory();
 
 	bool IsFrameDumping();
+	// Copies the frame into the frame dump queue, data can be reused once this returns
 	void DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down = false, bool bgra = false);
-	void FinishFrameData();
 
 	static Common::Flag s_screenshot;
 	static std::mutex s_criticalScreenshot;
@@ -237,6 +238,8 @@ protected:
 private:
 	void RunFrameDumps();
 	void ShutdownFrameDumping();
+	// Queue depth and encode times for the statistics overlay, empty when not dumping
+	std::string GetFrameDumpStatsString();
 	static PEControl::PixelFormat prev_efb_format;
 	static unsigned int efb_scale_numeratorX;
 	static unsigned int efb_scale_numeratorY;
@@ -245,22 +248,46 @@ private:
 	static unsigned int ssaa_multiplier;
 
 	// frame dumping
-	std::thread m_frame_dump_thread;
-	Common::Event m_frame_dump_start;
-	Common::Event m_frame_dump_done;
-	Common::Flag m_frame_dump_thread_running;
-	u32 m_frame_dump_image_counter = 0;
-	bool m_frame_dump_frame_running = false;
 	struct FrameDumpConfig
 	{
 		const u8* data;
 		int width;
 		int height;
 		int stride;
-		bool upside_down;
 		bool bgra;
 		AVIDump::Frame state;
-	} m_frame_dump_config;
+	};
+	// A frame waiting in the frame dump queue. Frames are recycled, so the buffer is only
+	// reallocated when the frame size grows.
+	struct QueuedFrameDump
+	{
+		std::vector<u8> buffer;
+		FrameDumpConfig config;
+		bool screenshot;
+		u64 queue_time_us;
+	};
+	struct FrameDumpStats
+	{
+		u64 frames;
+		u64 dropped_frames;
+		size_t max_queue_depth;
+		u64 total_encode_time_us;
+		u64 max_encode_time_us;
+		u64 max_latency_us;
+	};
+	std::thread m_frame_dump_thread;
+	bool m_frame_dump_thread_running = false;
+	u32 m_frame_dump_image_counter = 0;
+	// Guards everything below
+	std::mutex m_frame_dump_lock;
+	std::condition_variable m_frame_dump_queued;
+	std::condition_variable m_frame_dump_freed;
+	bool m_frame_dump_quit = false;
+	std::deque<std::unique_ptr<QueuedFrameDump>> m_frame_dump_queue;
+	std::vector<std::unique_ptr<QueuedFrameDump>> m_frame_dump_free_frames;
+	// Queued, being written or free; limited to the queue size
+	size_t m_frame_dump_frames = 0;
+	FrameDumpStats m_frame_dump_stats = {};
 
 	// NOTE: The methods below are called on the framedumping thread.
 	bool StartFrameDumpToAVI(const FrameDumpConfig& config);
@@ -44,6 +44,8 @@ std::string Statistics::ToString()
 	}
 	str += StringFromFormat("Textures created: %i\n", stats.numTexturesCreated);
 	str += StringFromFormat("Textures alive: %i\n", stats.numTexturesAlive);
+	str += StringFromFormat("Texture overlap queries: %i (%i candidates)\n",
+		stats.thisFrame.numTextureOverlapQueries, stats.thisFrame.numTextureOverlapCandidates);
 	str += StringFromFormat("pshaders created: %i\n", stats.numPixelShadersCreated);
 	str += StringFromFormat("pshaders alive: %i\n", stats.numPixelShadersAlive);
 	str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
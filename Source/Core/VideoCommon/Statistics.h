@@ -64,6 +64,10 @@ struct Statistics
 		int numVerticesLoaded;
 		int tevPixelsIn;
 		int tevPixelsOut;
+
+		// Texture cache lookups by memory range, and the textures they had to look at
+		int numTextureOverlapQueries;
+		int numTextureOverlapCandidates;
 	};
 	ThisFrame thisFrame;
 	void ResetFrame();
@@ -17,9 +17,11 @@
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/AsyncTextureDecoder.h"
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/PhaseProfiler.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/SamplerCommon.h"
@@ -56,8 +58,8 @@ TextureCacheBase::TextureCacheBase()
 
 	HiresTexture::Init();
 
-	SetHash64Function();
-	texture_pool_memory_usage = 0;
+	SetHash64Function(static_cast<Hash64Function>(g_ActiveConfig.iTextureHashFunction));
+	texture_memory_usage = 0;
 	UnbindTextures();
 }
 
@@ -71,11 +73,15 @@ void TextureCacheBase::Invalidate()
 		iter = InvalidateTexture(iter);
 	}
 	textures_by_address.clear();
+	textures_by_page.clear();
 	textures_by_hash.clear();
 }
 
 TextureCacheBase::~TextureCacheBase()
 {
+	// Units still being decoded point into async_loads
+	async_decoder.reset();
+	async_loads.clear();
 	HiresTexture::Shutdown();
 	UnbindTextures();
 	Invalidate();
@@ -84,7 +90,8 @@ TextureCacheBase::~TextureCacheBase()
 		delete rt.second;
 	}
 	texture_pool.clear();
-	texture_pool_memory_usage = 0;
+	pool_by_age.clear();
+	texture_memory_usage = 0;
 	if (TextureCacheBase::temp)
 	{
 		Common::FreeAlignedMemory(TextureCacheBase::temp);
@@ -142,64 +149,60 @@ void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
 
 void TextureCacheBase::Cleanup(s32 _frameCount)
 {
+	FinishAsyncLoads();
+
+	// Textures used since the last call are at the end of the lists
+	for (TexLRUList* list : { &textures_by_use, &pool_by_age })
+	{
+		for (auto iter = list->rbegin(); iter != list->rend() && (*iter)->frameCount == FRAMECOUNT_INVALID; ++iter)
+			(*iter)->frameCount = _frameCount;
+	}
+
+	const size_t budget = GetTextureMemoryBudget();
 	s32 texture_kill_threshold = TEXTURE_KILL_THRESHOLD;
-	if (texture_pool_memory_usage < (TEXTURE_POOL_MEMORY_LIMIT / 2))
+	if (texture_memory_usage < budget / 2)
 	{
-		// if we are using less than the memory limit increase kill threshold
+		// if we are using less than half of the budget increase kill threshold
 		texture_kill_threshold *= TEXTURE_KILL_MULTIPLIER;
 	}
-	auto iter = textures_by_address.begin();
-	auto tcend = textures_by_address.end();
-	while (iter != tcend)
+
+	// Only the least recently used textures are looked at, so this does not depend on the size of
+	// the cache. Textures used in this frame are never evicted.
+	u32 processed = 0;
+	while (!textures_by_use.empty() && processed++ < TEXTURE_CLEANUP_BATCH_SIZE)
 	{
-		if (iter->second->frameCount == FRAMECOUNT_INVALID)
-		{
-			iter->second->frameCount = _frameCount;
-		}
-		if (_frameCount > texture_kill_threshold + iter->second->frameCount)
-		{
-			if (iter->second->IsEfbCopy())
-			{
-				// Only remove EFB copies when they wouldn't be used anymore(changed hash), because EFB copies living on the
-				// host GPU are unrecoverable. Perform this check only every TEXTURE_KILL_THRESHOLD for performance reasons
-				if ((_frameCount - iter->second->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
-					iter->second->hash != iter->second->CalculateHash())
-				{
-					iter = InvalidateTexture(iter);
-				}
-				else
-				{
-					++iter;
-				}
-			}
-			else
-			{
-				iter = InvalidateTexture(iter);
-			}
-		}
-		else
+		TCacheEntryBase* entry = textures_by_use.front();
+		const bool expired = _frameCount > texture_kill_threshold + entry->frameCount;
+		const bool over_budget = texture_memory_usage > budget && entry->frameCount != _frameCount;
+		if (!expired && !over_budget)
+			break;
+
+		// Only remove EFB copies when they wouldn't be used anymore(changed hash), because EFB copies living on the
+		// host GPU are unrecoverable. Unchanged ones are checked again after the kill threshold.
+		if (entry->IsEfbCopy() && entry->hash == entry->CalculateHash())
 		{
-			++iter;
+			entry->frameCount = _frameCount;
+			textures_by_use.splice(textures_by_use.end(), textures_by_use, entry->lru_iter);
+			continue;
 		}
+
+		InvalidateTexture(GetTexCacheIter(entry));
+		// Textures evicted for memory would just wait in the pool
+		if (!expired)
+			FreeTexture(entry);
 	}
-	TexPool::iterator iter2 = texture_pool.begin();
-	TexPool::iterator tcend2 = texture_pool.end();
-	while (iter2 != tcend2)
+
+	while (!pool_by_age.empty())
 	{
-		if (iter2->second->frameCount == FRAMECOUNT_INVALID)
-		{
-			iter2->second->frameCount = _frameCount;
-		}
-		if (_frameCount > TEXTURE_POOL_KILL_THRESHOLD + iter2->second->frameCount)
-		{
-			texture_pool_memory_usage -= iter2->second->native_size_in_bytes;
-			delete iter2->second;
-			iter2 = texture_pool.erase(iter2);
-		}
-		else
-		{
-			++iter2;
-		}
+		TCacheEntryBase* entry = pool_by_age.front();
+		// Disposed in this call
+		if (entry->frameCount == FRAMECOUNT_INVALID)
+			break;
+		const bool expired = _frameCount > TEXTURE_POOL_KILL_THRESHOLD + entry->frameCount;
+		const bool over_budget = texture_memory_usage > budget && entry->frameCount != _frameCount;
+		if (!expired && !over_budget)
+			break;
+		FreeTexture(entry);
 	}
 }
 
@@ -232,7 +235,7 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::ApplyPaletteToEntry(TCacheE
 		decoded_entry->frameCount = FRAMECOUNT_INVALID;
 		decoded_entry->is_efb_copy = false;
 		g_texture_cache->LoadLut(tlutfmt, &texMem[tlutaddr], palette_size);
-		auto iter = textures_by_address.emplace(entry->addr, decoded_entry);
+		auto iter = AddToCache(decoded_entry);
 		if (g_texture_cache->Palettize(decoded_entry, entry))
 		{
 			return decoded_entry;
@@ -290,7 +293,7 @@ void TextureCacheBase::ScaleTextureCacheEntryTo(TextureCacheBase::TCacheEntryBas
 		InvalidateTexture(GetTexCacheIter(*entry));
 
 		*entry = newentry;
-		textures_by_address.emplace((*entry)->addr, *entry);
+		AddToCache(*entry);
 	}
 	else
 	{
@@ -305,6 +308,9 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(TCa
 	// on each EFB copy.
 	if (!entry_to_update->may_have_overlapping_textures)
 		return entry_to_update;
+	// Applied to the real texture once it replaces the placeholder
+	if (entry_to_update->is_async_placeholder)
+		return entry_to_update;
 	entry_to_update->may_have_overlapping_textures = false;
 
 	const bool isPaletteTexture = (entry_to_update->format == GX_TF_C4
@@ -323,14 +329,11 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(TCa
 
 	u32 numBlocksX = (entry_to_update->native_width + block_width - 1) / block_width;
 
-	auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
-	while (iter.first != iter.second)
+	for (TCacheEntryBase* entry : FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes))
 	{
-		TCacheEntryBase* entry = iter.first->second;
 		if (entry != entry_to_update
 			&& entry->IsEfbCopy()
 			&& entry->references.count(entry_to_update) == 0
-			&& entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes)
 			&& entry->memory_stride == numBlocksX * block_size)
 		{
 			if (entry->hash == entry->CalculateHash())
@@ -343,12 +346,11 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(TCa
 						// Link the efb copy with the partially updated texture, so we won't apply this partial update again
 						entry->CreateReference(entry_to_update);
 						// Mark the texture update as used, as if it was loaded directly
-						entry->frameCount = FRAMECOUNT_INVALID;
+						TouchTexture(entry);
 						entry = decoded_entry;
 					}
 					else
 					{
-						++iter.first;
 						continue;
 					}
 				}
@@ -418,17 +420,15 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(TCa
 					// Link the two textures together, so we won't apply this partial update again
 					entry->CreateReference(entry_to_update);
 					// Mark the texture update as used, as if it was loaded directly
-					entry->frameCount = FRAMECOUNT_INVALID;
+					TouchTexture(entry);
 				}
 			}
 			else
 			{
 				// If the hash does not match, this EFB copy will not be used for anything, so remove it
-				iter.first = InvalidateTexture(iter.first);
-				continue;
+				InvalidateTexture(GetTexCacheIter(entry));
 			}
 		}
-		++iter.first;
 	}
 	return entry_to_update;
 }
@@ -455,7 +455,7 @@ void TextureCacheBase::DumpTexture(TCacheEntryBase* entry, std::string basename,
 // Used by TextureCacheBase::Load
 TextureCacheBase::TCacheEntryBase* TextureCacheBase::ReturnEntry(u32 stage, TCacheEntryBase* entry)
 {
-	entry->frameCount = FRAMECOUNT_INVALID;
+	TouchTexture(entry);
 	bound_textures[stage] = entry;
 	s_last_texture = std::max(s_last_texture, stage);
 	GFX_DEBUGGER_PAUSE_AT(NEXT_TEXTURE_CHANGE, true);
@@ -477,6 +477,7 @@ void TextureCacheBase::UnbindTextures()
 
 TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 {
+	PhaseProfiler::ScopedPhase phase(PhaseProfiler::PHASE_TEXTURE_LOADING);
 	const FourTexUnits &tex = bpmem.tex[stage >> 2];
 	const u32 id = stage & 3;
 	const u32 address = (tex.texImage3[id].image_base/* & 0x1FFFFF*/) << 5;
@@ -752,24 +753,38 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 		config.height *= g_ActiveConfig.iTexScalingFactor;
 		config.pcformat = PC_TEX_FMT_RGBA32;
 	}
-	TCacheEntryBase* entry = AllocateTexture(config);
+	// Palette textures stay on the GPU thread, as the decoder reads the palette straight from tmem,
+	// and so do textures which are about to be dumped.
+	const bool load_async = g_ActiveConfig.bAsyncTextureDecoding && !hires_tex && !from_tmem &&
+		!isPaletteTexture && !g_ActiveConfig.bDumpTextures &&
+		expandedWidth * expandedHeight >= ASYNC_LOAD_MIN_TEXELS;
+	TCacheEntryBase* entry = nullptr;
+	if (load_async)
+		entry = LoadAsync(config, src_data, texformat, tlutfmt, width, height, tex_levels, use_scaling);
+	if (!entry)
+		entry = AllocateTexture(config);
 	GFX_DEBUGGER_PAUSE_AT(NEXT_NEW_TEXTURE, true);
 
-	iter = textures_by_address.emplace(address, entry);
+	entry->SetGeneralParameters(address, texture_size, full_format);
+	iter = AddToCache(entry);
 	if (g_ActiveConfig.iSafeTextureCache_ColorSamples == 0 ||
 		std::max(texture_size, palette_size) <= (u32)g_ActiveConfig.iSafeTextureCache_ColorSamples * 8)
 	{
 		entry->textures_by_hash_iter = textures_by_hash.emplace(full_hash, entry);
 	}
 
-	entry->SetGeneralParameters(address, texture_size, full_format);
 	entry->SetDimensions(nativeW, nativeH, tex_levels);
-	entry->SetHiresParams(!!hires_tex, basename, use_scaling, !!hires_tex && hires_tex->emissive_in_color);
+	entry->SetHiresParams(!!hires_tex, basename, use_scaling && !entry->is_async_placeholder,
+		!!hires_tex && hires_tex->emissive_in_color);
 	entry->SetHashes(full_hash, tex_hash);
 	entry->is_efb_copy = false;
 
 	// load texture
-	if (hires_tex)
+	if (entry->is_async_placeholder)
+	{
+		// Already filled in by LoadAsync
+	}
+	else if (hires_tex)
 	{
 		entry->Load(TextureCacheBase::temp, width, height, expandedWidth, 0);
 		u8 *Bufferptr = TextureCacheBase::temp;
@@ -846,6 +861,147 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	return ReturnEntry(stage, entry);
 }
 
+// Queues the texture for decoding on the thread pool and returns a cheap placeholder to draw
+// with in the meantime, or nullptr if too many textures are in flight already.
+TextureCacheBase::TCacheEntryBase* TextureCacheBase::LoadAsync(const TCacheEntryConfig& config,
+	const u8* src_data, u32 texformat, u32 tlutfmt, u32 width, u32 height, u32 levels, bool use_scaling)
+{
+	if (!async_decoder)
+		async_decoder = std::make_unique<AsyncTextureDecoder>();
+
+	std::unique_ptr<AsyncTextureDecodeUnit> unit = std::make_unique<AsyncTextureDecodeUnit>();
+	unit->texformat = texformat;
+	unit->rgba_only = config.pcformat == PC_TEX_FMT_RGBA32;
+	unit->compressed = config.pcformat >= PC_TEX_FMT_DXT1 && config.pcformat <= PC_TEX_FMT_DXT5;
+	if (use_scaling)
+	{
+		unit->scaling_factor = g_ActiveConfig.iTexScalingFactor;
+		unit->scaling_type = g_ActiveConfig.iTexScalingType;
+		unit->deposterize = g_ActiveConfig.bTexDeposterize;
+	}
+	const u32 bsw = TexDecoder_GetBlockWidthInTexels(texformat);
+	const u32 bsh = TexDecoder_GetBlockHeightInTexels(texformat);
+	for (u32 level = 0; level != levels; ++level)
+	{
+		const u32 mip_width = TextureUtil::CalculateLevelSize(width, level);
+		const u32 mip_height = TextureUtil::CalculateLevelSize(height, level);
+		unit->AddLevel(mip_width, mip_height, Common::AlignUpSizePow2(mip_width, bsw),
+			Common::AlignUpSizePow2(mip_height, bsh));
+	}
+	// Emulated memory may change before the worker gets to it
+	unit->source.assign(src_data, src_data + unit->source_size);
+	if (!async_decoder->Queue(unit.get()))
+		return nullptr;
+
+	// Stand in with the first mip small enough to decode right away, or a single texel from the
+	// middle of the texture if there is no such mip
+	u32 first_level = 1;
+	while (first_level < levels &&
+		std::max(unit->levels[first_level].width, unit->levels[first_level].height) > ASYNC_PLACEHOLDER_MAX_SIZE)
+	{
+		++first_level;
+	}
+	TCacheEntryConfig placeholder_config;
+	if (first_level < levels)
+	{
+		placeholder_config.width = unit->levels[first_level].width;
+		placeholder_config.height = unit->levels[first_level].height;
+		placeholder_config.levels = levels - first_level;
+		placeholder_config.pcformat = GetNativeTextureFormat(texformat, (TlutFormat)tlutfmt,
+			placeholder_config.width, placeholder_config.height);
+	}
+	else
+	{
+		placeholder_config.width = 1;
+		placeholder_config.height = 1;
+		placeholder_config.pcformat = PC_TEX_FMT_RGBA32;
+	}
+	TCacheEntryBase* placeholder = AllocateTexture(placeholder_config);
+	placeholder->is_scaled = false;
+	placeholder->is_async_placeholder = true;
+	if (first_level < levels)
+	{
+		for (u32 level = first_level; level != levels; ++level)
+		{
+			const AsyncTextureDecodeUnit::Level& info = unit->levels[level];
+			placeholder->Load(unit->source.data() + info.source_offset, info.width, info.height,
+				info.expanded_width, info.expanded_height, texformat, 0, (TlutFormat)tlutfmt,
+				level - first_level);
+		}
+	}
+	else
+	{
+		u32 texel = 0;
+		TexDecoder_DecodeTexel(reinterpret_cast<u8*>(&texel), unit->source.data(), width / 2, height / 2,
+			width - 1, texformat, nullptr, (TlutFormat)tlutfmt);
+		placeholder->Load(reinterpret_cast<u8*>(&texel), 1, 1, 1, 0);
+	}
+
+	AsyncLoad load;
+	load.placeholder = placeholder;
+	load.config = config;
+	load.unit = std::move(unit);
+	async_loads.push_back(std::move(load));
+	return placeholder;
+}
+
+// Replaces the placeholders of all textures the workers are done with.
+// Called once per frame, so a texture is never swapped in the middle of one.
+void TextureCacheBase::FinishAsyncLoads()
+{
+	auto iter = async_loads.begin();
+	while (iter != async_loads.end())
+	{
+		const AsyncTextureDecodeUnit& unit = *iter->unit;
+		if (!unit.done.load())
+		{
+			++iter;
+			continue;
+		}
+
+		TCacheEntryBase* placeholder = iter->placeholder;
+		if (placeholder)
+		{
+			TCacheEntryBase* entry = AllocateTexture(iter->config);
+			entry->SetGeneralParameters(placeholder->addr, placeholder->size_in_bytes, placeholder->format);
+			entry->SetDimensions(placeholder->native_width, placeholder->native_height, placeholder->native_levels);
+			entry->SetHiresParams(false, placeholder->basename, unit.scaling_factor != 0, false);
+			entry->SetHashes(placeholder->hash, placeholder->base_hash);
+			entry->is_efb_copy = false;
+
+			const u32 factor = std::max(unit.scaling_factor, 1);
+			for (u32 level = 0; level != unit.levels.size(); ++level)
+			{
+				const AsyncTextureDecodeUnit::Level& info = unit.levels[level];
+				entry->Load(unit.decoded.data() + info.offset, info.width * factor, info.height * factor,
+					info.expanded_width * factor, level);
+			}
+
+			if (placeholder->textures_by_hash_iter != textures_by_hash.end())
+				entry->textures_by_hash_iter = textures_by_hash.emplace(entry->hash, entry);
+			for (TCacheEntryBase*& bound : bound_textures)
+			{
+				if (bound == placeholder)
+					bound = entry;
+			}
+			placeholder->is_async_placeholder = false;
+			InvalidateTexture(GetTexCacheIter(placeholder));
+			AddToCache(entry);
+		}
+		iter = async_loads.erase(iter);
+	}
+}
+
+void TextureCacheBase::CancelAsyncLoad(TCacheEntryBase* placeholder)
+{
+	placeholder->is_async_placeholder = false;
+	for (AsyncLoad& load : async_loads)
+	{
+		if (load.placeholder == placeholder)
+			load.placeholder = nullptr;
+	}
+}
+
 void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32 dstStride, bool is_depth_copy,
 	const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf)
 {
@@ -1284,20 +1440,12 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 	// TODO: This also invalidates partial overlaps, which we currently don't have a better way
 	//       of dealing with.
 	bool invalidate_textures = dstStride == bytes_per_row || !copy_to_vram;
-	auto iter = FindOverlappingTextures(dstAddr, covered_range);
-	while (iter.first != iter.second)
+	for (TCacheEntryBase* entry : FindOverlappingTextures(dstAddr, covered_range))
 	{
-		TCacheEntryBase* entry = iter.first->second;
-		if (entry->OverlapsMemoryRange(dstAddr, covered_range))
-		{
-			if (invalidate_textures)
-			{
-				iter.first = InvalidateTexture(iter.first);
-				continue;
-			}
+		if (invalidate_textures)
+			InvalidateTexture(GetTexCacheIter(entry));
+		else
 			entry->may_have_overlapping_textures = true;
-		}
-		++iter.first;
 	}
 
 	if (copy_to_vram)
@@ -1333,7 +1481,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 					count++), 0);
 			}
 
-			textures_by_address.emplace(dstAddr, entry);
+			AddToCache(entry);
 		}
 	}
 }
@@ -1346,10 +1494,11 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::AllocateTexture(const TCach
 	{
 		entry = iter->second;
 		texture_pool.erase(iter);
+		pool_by_age.erase(entry->lru_iter);
 	}
 	else
 	{
-		texture_pool_memory_usage += config.GetSizeInBytes();
+		texture_memory_usage += config.GetSizeInBytes();
 		entry = CreateTexture(config);
 		INCSTAT(stats.numTexturesCreated);
 	}
@@ -1360,6 +1509,9 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::AllocateTexture(const TCach
 
 void TextureCacheBase::DisposeTexture(TCacheEntryBase* entry)
 {
+	if (entry->is_async_placeholder)
+		CancelAsyncLoad(entry);
+
 	if (entry->textures_by_hash_iter != textures_by_hash.end())
 	{
 		textures_by_hash.erase(entry->textures_by_hash_iter);
@@ -1371,6 +1523,28 @@ void TextureCacheBase::DisposeTexture(TCacheEntryBase* entry)
 	entry->frameCount = FRAMECOUNT_INVALID;
 
 	texture_pool.emplace(entry->config, entry);
+	entry->lru_iter = pool_by_age.insert(pool_by_age.end(), entry);
+}
+
+void TextureCacheBase::FreeTexture(TCacheEntryBase* entry)
+{
+	auto range = texture_pool.equal_range(entry->config);
+	auto iter = std::find_if(range.first, range.second, [entry](const auto& pooled) {
+		return pooled.second == entry;
+	});
+	if (iter == range.second)
+		return;
+	texture_pool.erase(iter);
+	pool_by_age.erase(entry->lru_iter);
+	texture_memory_usage -= entry->native_size_in_bytes;
+	delete entry;
+}
+
+size_t TextureCacheBase::GetTextureMemoryBudget() const
+{
+	const int budget = g_ActiveConfig.iTextureMemoryBudget > 0 ?
+		g_ActiveConfig.iTextureMemoryBudget : g_ActiveConfig.backend_info.DefaultTextureMemoryBudget;
+	return static_cast<size_t>(budget) * 1024 * 1024;
 }
 
 TextureCacheBase::TexPool::iterator
@@ -1408,25 +1582,70 @@ TextureCacheBase::TexAddrCache::iterator TextureCacheBase::InvalidateTexture(Tex
 		return textures_by_address.end();
 
 	TCacheEntryBase* entry = iter->second;
+	textures_by_use.erase(entry->lru_iter);
+	RemoveFromPageIndex(iter->second);
 	DisposeTexture(iter->second);
 	return textures_by_address.erase(iter);
 }
 
-std::pair<TextureCacheBase::TexAddrCache::iterator, TextureCacheBase::TexAddrCache::iterator>
+TextureCacheBase::TexAddrCache::iterator TextureCacheBase::AddToCache(TCacheEntryBase* entry)
+{
+	// Textures of size 0 still have to be found when their address is in the queried range
+	const u32 last_page = (entry->addr + std::max(entry->size_in_bytes, 1u) - 1) >> TEXTURE_PAGE_SHIFT;
+	for (u32 page = entry->addr >> TEXTURE_PAGE_SHIFT; page <= last_page; ++page)
+		textures_by_page[page].push_back(entry);
+	entry->frameCount = FRAMECOUNT_INVALID;
+	entry->lru_iter = textures_by_use.insert(textures_by_use.end(), entry);
+	return textures_by_address.emplace(entry->addr, entry);
+}
+
+void TextureCacheBase::TouchTexture(TCacheEntryBase* entry)
+{
+	entry->frameCount = FRAMECOUNT_INVALID;
+	textures_by_use.splice(textures_by_use.end(), textures_by_use, entry->lru_iter);
+}
+
+void TextureCacheBase::RemoveFromPageIndex(TCacheEntryBase* entry)
+{
+	const u32 last_page = (entry->addr + std::max(entry->size_in_bytes, 1u) - 1) >> TEXTURE_PAGE_SHIFT;
+	for (u32 page = entry->addr >> TEXTURE_PAGE_SHIFT; page <= last_page; ++page)
+	{
+		std::vector<TCacheEntryBase*>& textures = textures_by_page[page];
+		auto iter = std::find(textures.begin(), textures.end(), entry);
+		if (iter != textures.end())
+			textures.erase(iter);
+	}
+}
+
+std::vector<TextureCacheBase::TCacheEntryBase*>
 TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
 {
-	// We index by the starting address only, so there is no way to query all textures
-	// which end after the given addr. But the GC textures have a limited size, so we
-	// look for all textures which have a start address bigger than addr minus the maximal
-	// texture size. But this yields false-positives which must be checked later on.
-
-	// 1024 x 1024 texel times 8 nibbles per texel
-	constexpr u32 max_texture_size = 1024 * 1024 * 4;
-	u32 lower_addr = addr > max_texture_size ? addr - max_texture_size : 0;
-	auto begin = textures_by_address.lower_bound(lower_addr);
-	auto end = textures_by_address.upper_bound(addr + size_in_bytes);
-
-	return std::make_pair(begin, end);
+	std::vector<TCacheEntryBase*> result;
+	const u32 first_page = addr >> TEXTURE_PAGE_SHIFT;
+	const u32 last_page = (addr + std::max(size_in_bytes, 1u) - 1) >> TEXTURE_PAGE_SHIFT;
+	u32 candidates = 0;
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		auto textures = textures_by_page.find(page);
+		if (textures == textures_by_page.end())
+			continue;
+		candidates += static_cast<u32>(textures->second.size());
+		for (TCacheEntryBase* entry : textures->second)
+		{
+			// Textures spanning several pages are only taken from the first queried page they are in
+			const u32 entry_page = std::max(entry->addr >> TEXTURE_PAGE_SHIFT, first_page);
+			if (entry_page == page && entry->OverlapsMemoryRange(addr, size_in_bytes))
+				result.push_back(entry);
+		}
+	}
+	// Within a page the textures are in insertion order, which is also how textures_by_address
+	// orders textures at the same address
+	std::stable_sort(result.begin(), result.end(),
+		[](const TCacheEntryBase* a, const TCacheEntryBase* b) { return a->addr < b->addr; });
+
+	INCSTAT(stats.thisFrame.numTextureOverlapQueries);
+	ADDSTAT(stats.thisFrame.numTextureOverlapCandidates, candidates);
+	return result;
 }
 
 u32 TextureCacheBase::TCacheEntryBase::BytesPerRow() const
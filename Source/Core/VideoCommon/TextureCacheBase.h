@@ -3,11 +3,13 @@
 // Refer to the license.txt file included.
 
 #pragma once
+#include <list>
 #include <map>
 #include <memory>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Thread.h"
@@ -16,6 +18,8 @@
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
 
+class AsyncTextureDecoder;
+struct AsyncTextureDecodeUnit;
 struct VideoConfig;
 
 enum TextureCacheParams
@@ -26,7 +30,14 @@ enum TextureCacheParams
 	TEXTURE_KILL_MULTIPLIER = 2,
 	TEXTURE_KILL_THRESHOLD = 120,
 	TEXTURE_POOL_KILL_THRESHOLD = 3,
-	TEXTURE_POOL_MEMORY_LIMIT = 64 * 1024 * 1024
+	// Most textures Cleanup evicts or checks at once, larger evictions are spread over several frames
+	TEXTURE_CLEANUP_BATCH_SIZE = 64,
+	// Smaller textures are cheap enough to always decode on the GPU thread
+	ASYNC_LOAD_MIN_TEXELS = 64 * 64,
+	// Largest mip used as a stand-in while a texture is decoded asynchronously
+	ASYNC_PLACEHOLDER_MAX_SIZE = 32,
+	// Granularity of the memory range index of the texture cache
+	TEXTURE_PAGE_SHIFT = 15
 };
 
 class TextureCacheBase
@@ -68,6 +79,7 @@ public:
 			{
 				result *= 2;
 			}
+			result *= layers;
 			result = std::max(result, 4096u);
 			return result;
 		}
@@ -108,6 +120,8 @@ public:
 		bool is_scaled = false;
 		bool emissive_in_alpha = false;
 		bool may_have_overlapping_textures = false;
+		// Stand-in drawn while the real texture is decoded on a worker thread
+		bool is_async_placeholder = false;
 		u32 addr = {};
 		u32 size_in_bytes = {};
 		u32 native_size_in_bytes = {};
@@ -122,6 +136,8 @@ public:
 
 		// Keep an iterator to the entry in textures_by_hash, so it does not need to be searched when removing the cache entry
 		std::multimap<u64, TCacheEntryBase*>::iterator textures_by_hash_iter;
+		// Position in textures_by_use while in the cache, or in pool_by_age while in the pool
+		std::list<TCacheEntryBase*>::iterator lru_iter;
 
 		// This is used to keep track of both:
 		//   * efb copies used by this partially updated texture
@@ -220,7 +236,8 @@ public:
 	virtual ~TextureCacheBase(); // needs virtual for DX11 dtor
 
 	void OnConfigChanged(VideoConfig& config);
-	// Removes textures which aren't used for more than TEXTURE_KILL_THRESHOLD frames,
+	// Removes textures which aren't used for more than TEXTURE_KILL_THRESHOLD frames, and the least
+	// recently used ones while textures take more memory than the budget.
 	// frameCount is the current frame number.
 	void Cleanup(int frameCount);
 	void Invalidate();
@@ -261,6 +278,9 @@ private:
 	typedef std::multimap<u64, TCacheEntryBase*> TexHashCache;
 	typedef std::unordered_multimap<TCacheEntryConfig, TCacheEntryBase*, TCacheEntryConfig::Hasher> TexPool;
 	typedef std::unordered_map<std::string, TCacheEntryBase*> HiresTexPool;
+	// Textures covering each page of emulated memory, in the order they were added
+	typedef std::unordered_map<u32, std::vector<TCacheEntryBase*>> TexPageIndex;
+	typedef std::list<TCacheEntryBase*> TexLRUList;
 
 	void SetBackupConfig(const VideoConfig& config);
 	void ScaleTextureCacheEntryTo(TCacheEntryBase** entry, u32 new_width, u32 new_height);
@@ -269,23 +289,53 @@ private:
 	TextureCacheBase::TCacheEntryBase* ApplyPaletteToEntry(TCacheEntryBase* entry, u32 tlutaddr, u32 tlutfmt, u32 palette_size);
 	void DumpTexture(TCacheEntryBase* entry, std::string basename, u32 level);
 
+	TCacheEntryBase* LoadAsync(const TCacheEntryConfig& config, const u8* src_data, u32 texformat,
+		u32 tlutfmt, u32 width, u32 height, u32 levels, bool use_scaling);
+	void FinishAsyncLoads();
+	void CancelAsyncLoad(TCacheEntryBase* placeholder);
+
 	TexPool::iterator FindMatchingTextureFromPool(const TCacheEntryConfig& config);
 	TexAddrCache::iterator GetTexCacheIter(TCacheEntryBase* entry);
 	TexAddrCache::iterator InvalidateTexture(TexAddrCache::iterator t_iter);
 	TCacheEntryBase* ReturnEntry(u32 stage, TCacheEntryBase* entry);
 
-	// Return all possible overlapping textures. As addr+size of the textures is not
-	// indexed, this may return false positives.
-	std::pair<TexAddrCache::iterator, TexAddrCache::iterator>
-		FindOverlappingTextures(u32 addr, u32 size_in_bytes);
+	// Adds the entry to textures_by_address and the page index.
+	// addr and size_in_bytes of the entry must not change while it is in the cache.
+	TexAddrCache::iterator AddToCache(TCacheEntryBase* entry);
+	void RemoveFromPageIndex(TCacheEntryBase* entry);
+	// Marks a texture in the cache as used in this frame
+	void TouchTexture(TCacheEntryBase* entry);
+	// Deletes a texture from the pool
+	void FreeTexture(TCacheEntryBase* entry);
+	size_t GetTextureMemoryBudget() const;
+	// Return all textures overlapping the range, ordered by address like textures_by_address
+	std::vector<TCacheEntryBase*> FindOverlappingTextures(u32 addr, u32 size_in_bytes);
 
 	TexAddrCache textures_by_address;
+	TexPageIndex textures_by_page;
 	TexHashCache textures_by_hash;
 	TexPool texture_pool;
-	size_t texture_pool_memory_usage = {};
+	// Textures in the cache, least recently used first. Textures used since the last Cleanup are
+	// at the end and have a frameCount of FRAMECOUNT_INVALID.
+	TexLRUList textures_by_use;
+	// Textures in the pool, disposed first at the front
+	TexLRUList pool_by_age;
+	// Host memory of the textures in the cache and in the pool
+	size_t texture_memory_usage = {};
 	
 	u32 s_last_texture = {};
 
+	struct AsyncLoad
+	{
+		// nullptr once the placeholder left the cache
+		TCacheEntryBase* placeholder;
+		// The texture the decoded data is uploaded to
+		TCacheEntryConfig config;
+		std::unique_ptr<AsyncTextureDecodeUnit> unit;
+	};
+	std::unique_ptr<AsyncTextureDecoder> async_decoder;
+	std::vector<AsyncLoad> async_loads;
+
 	// Backup configuration values
 	struct BackupConfig
 	{
@@ -29,6 +29,8 @@ public:
 	~TextureScaler();
 
 	u32* Scale(u32* data, int width, int height);
+	// Same as above, with explicit settings instead of the ones in g_ActiveConfig
+	u32* Scale(u32* data, int width, int height, int factor, int type, bool deposterize);
 
 	enum
 	{
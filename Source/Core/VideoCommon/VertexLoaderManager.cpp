@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 // Modified for Ishiiruka by Tino
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -11,10 +12,14 @@
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
 #include "Common/ThreadPool.h"
 #include "Common/StringUtil.h"
 
 #include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/ObjectUsageProfiler.h"
+#include "VideoCommon/PhaseProfiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -27,9 +32,43 @@ static std::string last_game_code;
 
 typedef std::unordered_map<VertexLoaderUID, std::unique_ptr<VertexLoaderBase>> VertexLoaderMap;
 
+// Bump this when the layout of VertexLoaderProfileKey changes
+static const pKey_t VERTEXLOADER_PROFILE_VERSION = 1;
+
+// Full vertex description as seen by the game, stored in the per game loader profile.
+// The uid masks out some of the attribute bits so it can't be used to rebuild a loader.
+struct VertexLoaderProfileKey
+{
+	u64 vtx_desc;
+	u32 vat[3];
+	u32 padding;
+	VertexLoaderProfileKey() : vtx_desc(0), vat{}, padding(0)
+	{}
+	VertexLoaderProfileKey(const TVtxDesc& desc, const VAT& vtx_attr) : vtx_desc(desc.Hex), vat{ vtx_attr.g0.Hex, vtx_attr.g1.Hex, vtx_attr.g2.Hex }, padding(0)
+	{}
+	bool operator == (const VertexLoaderProfileKey& other) const
+	{
+		return vtx_desc == other.vtx_desc && std::equal(vat, vat + 3, other.vat);
+	}
+	struct Hasher
+	{
+		size_t operator()(const VertexLoaderProfileKey& key) const
+		{
+			return static_cast<size_t>(GetMurmurHash3(reinterpret_cast<const u8*>(&key), sizeof(key), 0));
+		}
+	};
+};
+
+struct VertexLoaderProfileInfo
+{};
+
+typedef ObjectUsageProfiler<VertexLoaderProfileKey, pKey_t, VertexLoaderProfileInfo, VertexLoaderProfileKey::Hasher> VertexLoaderProfile;
+
 namespace VertexLoaderManager
 {
 static VertexLoaderMap s_vertex_loader_map;
+static std::unique_ptr<VertexLoaderProfile> s_loader_profile;
+static pKey_t s_profile_category;
 static NativeVertexFormatMap s_native_vertex_map;
 static NativeVertexFormat* s_current_vtx_fmt;
 u32 g_current_components;
@@ -184,18 +223,62 @@ void AppendListToString(std::string *dest)
 	}
 }
 
+// Builds the loaders recorded in previous sessions of the current game
+// so the jit doesn't have to run the first time each format is drawn.
+// Native vertex formats are resolved on first use as the vertex manager
+// may not exist yet.
+static void PrecompileProfiledLoaders()
+{
+	size_t loader_count = 0;
+	s_loader_profile->ForEachMostUsedByCategory(s_profile_category,
+		[&](const VertexLoaderProfileKey& key, size_t total)
+	{
+		TVtxDesc vtx_desc;
+		vtx_desc.Hex = key.vtx_desc;
+		VAT vtx_attr;
+		vtx_attr.g0.Hex = key.vat[0];
+		vtx_attr.g1.Hex = key.vat[1];
+		vtx_attr.g2.Hex = key.vat[2];
+		VertexLoaderUID uid(vtx_desc, vtx_attr);
+		if (s_vertex_loader_map.find(uid) != s_vertex_loader_map.end())
+			return;
+		s_vertex_loader_map[uid] = VertexLoaderBase::CreateVertexLoader(vtx_desc, vtx_attr);
+		INCSTAT(stats.numVertexLoaders);
+		loader_count++;
+	});
+	if (loader_count > 0)
+		INFO_LOG(VIDEO, "Precompiled %zu vertex loaders for %s", loader_count, last_game_code.c_str());
+}
+
 void Init()
 {
 	MarkAllDirty();
 	for (VertexLoaderBase*& vertexLoader : g_main_cp_state.vertex_loaders)
 		vertexLoader = nullptr;
 	last_game_code = SConfig::GetInstance().GetGameID();
+	if (!s_loader_profile)
+	{
+		s_profile_category = (pKey_t)GetMurmurHash3(reinterpret_cast<const u8*>(last_game_code.data()), (u32)last_game_code.size(), 0);
+		s_loader_profile.reset(VertexLoaderProfile::Create(
+			s_profile_category,
+			VERTEXLOADER_PROFILE_VERSION,
+			"Ishiiruka.vl",
+			StringFromFormat("%s.vl", last_game_code.c_str())
+		));
+		if (g_ActiveConfig.bCompileShaderOnStartup)
+			PrecompileProfiledLoaders();
+	}
 }
 
 void Shutdown()
 {
 	if (s_vertex_loader_map.size() > 0 && g_ActiveConfig.bDumpVertexLoaders)
 		DumpLoadersCode();
+	if (s_loader_profile)
+	{
+		s_loader_profile->Persist();
+		s_loader_profile.reset();
+	}
 	s_vertex_loader_map.clear();
 	s_native_vertex_map.clear();
 }
@@ -239,6 +322,16 @@ void MarkAllDirty()
 	g_preprocess_cp_state.bases_dirty = true;
 }
 
+inline void SetNativeVertexFormat(VertexLoaderBase* loader)
+{
+	loader->m_native_vertex_format = GetNativeVertexFormat(loader->m_native_vtx_decl);
+	VertexLoaderBase * fallback = loader->GetFallback();
+	if (fallback)
+	{
+		fallback->m_native_vertex_format = GetNativeVertexFormat(fallback->m_native_vtx_decl);
+	}
+}
+
 inline VertexLoaderBase *GetOrAddLoader(const TVtxDesc &VtxDesc, const VAT &VtxAttr)
 {
 	VertexLoaderUID uid(VtxDesc, VtxAttr);
@@ -247,16 +340,17 @@ inline VertexLoaderBase *GetOrAddLoader(const TVtxDesc &VtxDesc, const VAT &VtxA
 	{
 		s_vertex_loader_map[uid] = VertexLoaderBase::CreateVertexLoader(VtxDesc, VtxAttr);
 		VertexLoaderBase* loader = s_vertex_loader_map[uid].get();
-		loader->m_native_vertex_format = GetNativeVertexFormat(loader->m_native_vtx_decl);
-		VertexLoaderBase * fallback = loader->GetFallback();
-		if (fallback)
-		{
-			fallback->m_native_vertex_format = GetNativeVertexFormat(fallback->m_native_vtx_decl);
-		}
+		SetNativeVertexFormat(loader);
+		if (s_loader_profile)
+			s_loader_profile->GetOrAdd(VertexLoaderProfileKey(VtxDesc, VtxAttr));
 		INCSTAT(stats.numVertexLoaders);
 		return loader;
 	}
-	return iter->second.get();
+	VertexLoaderBase* loader = iter->second.get();
+	// Precompiled from the profile, resolve the native format now
+	if (loader->m_native_vertex_format == nullptr)
+		SetNativeVertexFormat(loader);
+	return loader;
 }
 
 void GetVertexSizeAndComponents(const VertexLoaderParameters &parameters, u32 &vertexsize, u32 &components)
@@ -277,6 +371,7 @@ inline void UpdateLoader(const VertexLoaderParameters &parameters)
 
 bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize)
 {
+	PhaseProfiler::ScopedPhase phase(PhaseProfiler::PHASE_VERTEX_LOADING);
 	if (parameters.needloaderrefresh)
 	{
 		UpdateLoader(parameters);
@@ -14,6 +14,7 @@
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/PhaseProfiler.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
@@ -128,10 +129,14 @@ void VertexManagerBase::PrepareForAdditionalData(int primitive, u32 count, u32 s
 
 void VertexManagerBase::DoFlush()
 {
+	PhaseProfiler::ScopedPhase phase(PhaseProfiler::PHASE_FLUSH);
 	// loading a state will invalidate BP, so check for it
 	NativeVertexFormat* current_vertex_format = VertexLoaderManager::GetCurrentVertexFormat();
 	g_video_backend->CheckInvalidState();
-	g_vertex_manager->PrepareShaders(current_primitive_type, VertexLoaderManager::g_current_components, xfmem, bpmem, true);
+	{
+		PhaseProfiler::ScopedPhase shader_phase(PhaseProfiler::PHASE_SHADER_LOOKUP);
+		g_vertex_manager->PrepareShaders(current_primitive_type, VertexLoaderManager::g_current_components, xfmem, bpmem, true);
+	}
 #if defined(_DEBUG) || defined(DEBUGFAST)
 	PRIM_LOG("frame%d:\n texgen=%d, numchan=%d, dualtex=%d, ztex=%d, cole=%d, alpe=%d, ze=%d", g_ActiveConfig.iSaveTargetId, xfmem.numTexGen.numTexGens,
 		xfmem.numChan.numColorChans, xfmem.dualTexTrans.enabled, bpmem.ztex2.op,
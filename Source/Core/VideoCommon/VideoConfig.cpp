@@ -56,6 +56,7 @@ VideoConfig::VideoConfig()
 	bEnableValidationLayer = false;
 	bBackendMultithreading = true;
 	backend_info.MaxTextureSize = 4096;
+	backend_info.DefaultTextureMemoryBudget = 1024;
 }
 
 void VideoConfig::Load(const std::string& ini_file)
@@ -74,6 +75,8 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("UseXFB", &bUseXFB, 0);
 	settings->Get("UseRealXFB", &bUseRealXFB, 0);
 	settings->Get("SafeTextureCacheColorSamples", &iSafeTextureCache_ColorSamples, 128);
+	settings->Get("TextureMemoryBudget", &iTextureMemoryBudget, 0);
+	settings->Get("TextureHashFunction", &iTextureHashFunction, 0);
 	settings->Get("ShowFPS", &bShowFPS, false);
 	settings->Get("ShowNetPlayPing", &bShowNetPlayPing, false);
 	settings->Get("ShowNetPlayMessages", &bShowNetPlayMessages, false);
@@ -97,6 +100,8 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("DumpCodec", &sDumpCodec, "");
 	settings->Get("DumpPath", &sDumpPath, "");
 	settings->Get("BitrateKbps", &iBitrateKbps, 2500);
+	settings->Get("FrameDumpQueueSize", &iFrameDumpQueueSize, 8);
+	settings->Get("FrameDumpDropFrames", &bFrameDumpDropFrames, false);
 	settings->Get("InternalResolutionFrameDumps", &bInternalResolutionFrameDumps, 0);
 	settings->Get("EnablePixelLighting", &bEnablePixelLighting, 0);
 	settings->Get("ForcedLighting", &bForcedLighting, 0);
@@ -173,6 +178,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("FullAsyncShaderCompilation", &bFullAsyncShaderCompilation, true);
 	hacks->Get("WaitForShaderCompilation", &bWaitForShaderCompilation, false);
 	hacks->Get("EnableComputeTextureDecoding", &bEnableComputeTextureDecoding, false);
+	hacks->Get("AsyncTextureDecoding", &bAsyncTextureDecoding, false);
 	hacks->Get("EnableComputeTextureEncoding", &bEnableComputeTextureEncoding, false);
 	hacks->Get("PredictiveFifo", &bPredictiveFifo, false);
 	hacks->Get("BoundingBoxMode", &iBBoxMode, (int)BBoxMode::BBoxNone);
@@ -228,6 +234,8 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "UseXFB", bUseXFB);
 	CHECK_SETTING("Video_Settings", "UseRealXFB", bUseRealXFB);
 	CHECK_SETTING("Video_Settings", "SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
+	CHECK_SETTING("Video_Settings", "TextureMemoryBudget", iTextureMemoryBudget);
+	CHECK_SETTING("Video_Settings", "TextureHashFunction", iTextureHashFunction);
 	CHECK_SETTING("Video_Settings", "HiresTextures", bHiresTextures);
 	CHECK_SETTING("Video_Settings", "HiresMaterialMaps", bHiresMaterialMaps);
 
@@ -330,6 +338,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video", "FullAsyncShaderCompilation", bFullAsyncShaderCompilation);
 	CHECK_SETTING("Video", "WaitForShaderCompilation", bWaitForShaderCompilation);
 	CHECK_SETTING("Video", "EnableComputeTextureDecoding", bEnableComputeTextureDecoding);
+	CHECK_SETTING("Video", "AsyncTextureDecoding", bAsyncTextureDecoding);
 	CHECK_SETTING("Video", "EnableComputeTextureEncoding", bEnableComputeTextureEncoding);
 	CHECK_SETTING("Video", "PredictiveFifo", bPredictiveFifo);
 	if (gfx_override_exists)
@@ -419,6 +428,8 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("UseXFB", bUseXFB);
 	settings->Set("UseRealXFB", bUseRealXFB);
 	settings->Set("SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
+	settings->Set("TextureMemoryBudget", iTextureMemoryBudget);
+	settings->Set("TextureHashFunction", iTextureHashFunction);
 	settings->Set("ShowFPS", bShowFPS);
 	settings->Set("ShowNetPlayPing", bShowNetPlayPing);
 	settings->Set("ShowNetPlayMessages", bShowNetPlayMessages);
@@ -443,6 +454,8 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("DumpCodec", sDumpCodec);
 	settings->Set("DumpPath", sDumpPath);
 	settings->Set("BitrateKbps", iBitrateKbps);
+	settings->Set("FrameDumpQueueSize", iFrameDumpQueueSize);
+	settings->Set("FrameDumpDropFrames", bFrameDumpDropFrames);
 	settings->Set("EnablePixelLighting", bEnablePixelLighting);
 	settings->Set("ForcedLighting", bForcedLighting);
 	settings->Set("ForcePhongShading", bForcePhongShading);
@@ -519,6 +532,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("FullAsyncShaderCompilation", bFullAsyncShaderCompilation);
 	hacks->Set("WaitForShaderCompilation", bWaitForShaderCompilation);
 	hacks->Set("EnableComputeTextureDecoding", bEnableComputeTextureDecoding);
+	hacks->Set("AsyncTextureDecoding", bAsyncTextureDecoding);
 	hacks->Set("EnableComputeTextureEncoding", bEnableComputeTextureEncoding);
 	hacks->Set("PredictiveFifo", bPredictiveFifo);
 	hacks->Set("BoundingBoxMode", iBBoxMode);
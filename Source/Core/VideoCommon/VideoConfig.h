@@ -155,6 +155,9 @@ struct VideoConfig final
 	bool bFreeLook;
 	bool bBorderlessFullscreen;
 	int iBitrateKbps;
+	// Frames waiting to be written; when the queue is full the GPU thread waits or drops the frame
+	int iFrameDumpQueueSize;
+	bool bFrameDumpDropFrames;
 	bool bCompileShaderOnStartup;
 	
 
@@ -167,11 +170,16 @@ struct VideoConfig final
 	bool bPredictiveFifo;
 	bool bWaitForShaderCompilation;
 	bool bEnableComputeTextureDecoding;
+	bool bAsyncTextureDecoding;
 	bool bEnableComputeTextureEncoding;
 	bool bEFBEmulateFormatChanges;
 	bool bSkipEFBCopyToRam;
 	bool bCopyEFBScaled;
 	int iSafeTextureCache_ColorSamples;
+	// Host memory for textures in MiB, 0 uses the default of the backend
+	int iTextureMemoryBudget;
+	// A Hash64Function, applied when the backend starts
+	int iTextureHashFunction;
 	int iPhackvalue[4];
 	std::string sPhackvalue[2];
 	float fAspectRatioHackW, fAspectRatioHackH;
@@ -241,6 +249,7 @@ struct VideoConfig final
 		std::string AdapterName; // for OpenGL
 
 		u32 MaxTextureSize;
+		u32 DefaultTextureMemoryBudget; // in MiB
 
 		bool bSupportedFormats[16]; // used for D3D9 in TextureCache		
 		bool bSupportsDualSourceBlend; // only supported by D3D11 and OpenGL
@@ -0,0 +1,180 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AudioCommon/Mixer.h"
+#include "Common/CommonTypes.h"
+#include "Common/Swap.h"
+#include "Core/ConfigManager.h"
+
+namespace
+{
+const u32 OUTPUT_RATE = 48000;
+// A typical audio callback buffer
+const u32 BUFFER_FRAMES = 512;
+
+class ScopeInit final
+{
+public:
+  explicit ScopeInit(bool sinc)
+  {
+    SConfig::Init();
+    SConfig::GetInstance().iTimingVariance = 40;
+    SConfig::GetInstance().m_EmulationSpeed = 1.0f;
+    SConfig::GetInstance().bSincResampling = sinc;
+  }
+  ~ScopeInit() { SConfig::Shutdown(); }
+};
+
+// Feeds a stereo sine wave to the DMA FIFO at the rate the mixer consumes it.
+class SineSource
+{
+public:
+  SineSource(CMixer& mixer, u32 rate, double frequency)
+      : m_mixer(mixer), m_rate(rate), m_step(2 * 3.14159265358979323846 * frequency / rate)
+  {
+    m_mixer.SetDMAInputSampleRate(rate);
+  }
+
+  void Push(u32 num_frames)
+  {
+    m_samples.resize(num_frames * 2);
+    for (u32 i = 0; i < num_frames; ++i)
+    {
+      const s16 sample = static_cast<s16>(16384 * std::sin(m_phase));
+      m_samples[i * 2] = Common::swap16(sample);
+      m_samples[i * 2 + 1] = Common::swap16(sample);
+      m_phase += m_step;
+    }
+    m_mixer.PushSamples(m_samples.data(), num_frames);
+  }
+
+  // Pushes what one output buffer consumes
+  void PushBuffer() { Push(BUFFER_FRAMES * m_rate / OUTPUT_RATE); }
+
+private:
+  CMixer& m_mixer;
+  u32 m_rate;
+  double m_step;
+  double m_phase = 0.0;
+  std::vector<s16> m_samples;
+};
+
+// Resamples a sine wave, and returns the output of the right channel once the rate control settled
+std::vector<float> Resample(bool sinc, u32 rate, double frequency, u32 num_buffers)
+{
+  ScopeInit init(sinc);
+  CMixer mixer(OUTPUT_RATE);
+  SineSource source(mixer, rate, frequency);
+  std::vector<float> output(BUFFER_FRAMES * 2);
+  std::vector<float> result;
+
+  // Fill the FIFO up to its target level
+  source.Push(rate * 40 / 1000);
+  for (u32 buffer = 0; buffer < 32 + num_buffers; ++buffer)
+  {
+    source.PushBuffer();
+    mixer.Mix(output.data(), BUFFER_FRAMES);
+    if (buffer < 32)
+      continue;
+    for (u32 i = 0; i < BUFFER_FRAMES; ++i)
+      result.push_back(output[i * 2]);
+  }
+  return result;
+}
+
+double MeasureRMS(bool sinc, u32 rate, double frequency)
+{
+  const std::vector<float> samples = Resample(sinc, rate, frequency, 32);
+  double sum = 0.0;
+  for (float sample : samples)
+    sum += sample * sample;
+  return std::sqrt(sum / samples.size());
+}
+
+// Peak magnitude of the Hann windowed spectrum of <samples> within 200 Hz of <frequency>
+double MeasureTone(const std::vector<float>& samples, double frequency)
+{
+  const double pi = 3.14159265358979323846;
+  const double bin_width = static_cast<double>(OUTPUT_RATE) / samples.size();
+  double peak = 0.0;
+  for (double f = frequency - 200; f <= frequency + 200; f += bin_width)
+  {
+    double re = 0.0, im = 0.0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+      const double window = 0.5 - 0.5 * std::cos(2 * pi * i / samples.size());
+      re += samples[i] * window * std::cos(2 * pi * f * i / OUTPUT_RATE);
+      im += samples[i] * window * std::sin(2 * pi * f * i / OUTPUT_RATE);
+    }
+    peak = std::max(peak, std::sqrt(re * re + im * im));
+  }
+  return peak;
+}
+}
+
+TEST(Mixer, ResamplersKeepAmplitude)
+{
+  // 0.5 * 255 / 256 full scale, over the square root of 2
+  const double expected = 0.5 * 255 / 256 / std::sqrt(2.0);
+  for (bool sinc : {false, true})
+  {
+    for (u32 rate : {32000u, 48000u})
+    {
+      EXPECT_NEAR(expected, MeasureRMS(sinc, rate, 1000.0), expected * 0.01)
+          << "sinc " << sinc << ", rate " << rate;
+    }
+  }
+}
+
+TEST(Mixer, SincResamplerRejectsImages)
+{
+  // Upsampling a 10 kHz tone from 32 kHz leaves an image at 22 kHz, which the cubic
+  // interpolation only partially removes.
+  double image_level[2];
+  for (bool sinc : {false, true})
+  {
+    const std::vector<float> samples = Resample(sinc, 32000, 10000.0, 16);
+    image_level[sinc] = MeasureTone(samples, 22000.0) / MeasureTone(samples, 10000.0);
+  }
+  EXPECT_LT(image_level[1], image_level[0] * 0.01);
+}
+
+// Not a correctness test: times both resamplers. Disabled by default, run it with
+// --gtest_also_run_disabled_tests.
+TEST(Mixer, DISABLED_Benchmark)
+{
+  const u32 BUFFERS = 20000;
+  std::printf("%-10s%14s%14s\n", "source", "cubic us/buf", "sinc us/buf");
+  for (u32 rate : {32000u, 48000u})
+  {
+    std::printf("%-10u", rate);
+    for (bool sinc : {false, true})
+    {
+      ScopeInit init(sinc);
+      CMixer mixer(OUTPUT_RATE);
+      SineSource source(mixer, rate, 1000.0);
+      std::vector<float> output(BUFFER_FRAMES * 2);
+
+      source.Push(rate * 40 / 1000);
+      std::chrono::steady_clock::duration elapsed{};
+      for (u32 i = 0; i < BUFFERS; ++i)
+      {
+        source.PushBuffer();
+        const auto start = std::chrono::steady_clock::now();
+        mixer.Mix(output.data(), BUFFER_FRAMES);
+        elapsed += std::chrono::steady_clock::now() - start;
+      }
+      std::printf("%14.2f", std::chrono::duration<double, std::micro>(elapsed).count() / BUFFERS);
+    }
+    std::printf("\n");
+  }
+}
@@ -0,0 +1,134 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+
+namespace
+{
+std::vector<u8> MakeData(u32 size)
+{
+  std::vector<u8> data(size);
+  u32 state = 0x12345678;
+  for (u8& byte : data)
+  {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<u8>(state >> 16);
+  }
+  return data;
+}
+}
+
+TEST(Hash, XXHash64MatchesReference)
+{
+  const u8 empty = 0;
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, GetXXHash64(&empty, 0, 0));
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, GetHiresTextureHash(&empty, 0));
+}
+
+TEST(Hash, HiresTextureHashesAreStable)
+{
+  // Custom texture packs are named after these, so the values must never change. They were
+  // computed with the implementations the texture packs were made with.
+  const std::vector<u8> data = MakeData(4096);
+  EXPECT_EQ(0xF75285BA9B19A6A8ULL, GetHiresTextureHash(data.data(), 4096));
+  EXPECT_EQ(0x831F5A2E71821A82ULL, GetLegacyHiresTextureHash(data.data(), 4096));
+  EXPECT_EQ(0x108318C66EF39DD2ULL, GetLegacyHiresTextureHash(data.data(), 4095));
+  EXPECT_EQ(0xED916FF3BBEE96E0ULL, GetLegacyHiresTextureHash(data.data(), 4096, 128));
+}
+
+TEST(Hash, MurmurHash3IsStable)
+{
+  // The default GetHash64 without SSE 4.2, which the shader caches on disk are keyed on
+  const std::vector<u8> data = MakeData(4096);
+  EXPECT_EQ(0x2026047144F04785ULL, GetMurmurHash3(data.data(), 4096, 0));
+  EXPECT_EQ(0xFF14BC73273E045FULL, GetMurmurHash3(data.data(), 4096, 128));
+}
+
+TEST(Hash, SetHash64FunctionSelectsFunction)
+{
+  const std::vector<u8> data = MakeData(1024);
+
+  SetHash64Function(HASH64_XXHASH64);
+  EXPECT_EQ(GetXXHash64(data.data(), 1024, 0), GetHash64(data.data(), 1024, 0));
+  SetHash64Function(HASH64_MURMURHASH3);
+  EXPECT_EQ(GetMurmurHash3(data.data(), 1024, 0), GetHash64(data.data(), 1024, 0));
+  SetHash64Function(HASH64_DEFAULT);
+}
+
+TEST(Hash, DetectsSingleBitChanges)
+{
+  std::vector<u8> data = MakeData(64 * 1024);
+  for (Hash64Function function : {HASH64_DEFAULT, HASH64_MURMURHASH3, HASH64_CRC32, HASH64_XXHASH64})
+  {
+    SetHash64Function(function);
+    const u64 hash = GetHash64(data.data(), static_cast<u32>(data.size()), 0);
+    for (size_t offset : {size_t(0), size_t(777), data.size() - 1})
+    {
+      data[offset] ^= 0x10;
+      EXPECT_NE(hash, GetHash64(data.data(), static_cast<u32>(data.size()), 0))
+          << "function " << function << ", offset " << offset;
+      data[offset] ^= 0x10;
+    }
+  }
+  SetHash64Function(HASH64_DEFAULT);
+}
+
+// Not a correctness test: reports the throughput of each hash function. It hashes several GB,
+// so it is disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST(Hash, DISABLED_Benchmark)
+{
+  struct Function
+  {
+    const char* name;
+    u64 (*hash)(const u8* src, u32 len, u32 samples);
+  };
+  static const Function FUNCTIONS[] = {
+      {"MurmurHash3", GetMurmurHash3},
+      {"CRC32", GetCRC32},
+      {"XXHash64", GetXXHash64},
+      {"Legacy hires", GetLegacyHiresTextureHash},
+  };
+  // From a 32x32 I4 texture to a 1024x1024 RGBA8 one
+  static const u32 SIZES[] = {512, 8 * 1024, 128 * 1024, 4 * 1024 * 1024};
+  // Without sampling, and the default of the safe texture cache setting
+  static const u32 SAMPLES[] = {0, 128};
+  const u64 BYTES_PER_RUN = 256 * 1024 * 1024;
+
+  std::vector<u8> data = MakeData(SIZES[3]);
+
+  for (u32 samples : SAMPLES)
+  {
+    std::printf("GB/s, samples %-5u", samples);
+    for (u32 size : SIZES)
+      std::printf("%11u", size);
+    std::printf("\n");
+    for (const Function& function : FUNCTIONS)
+    {
+      // CRC32 returns 0 if the build doesn't target a CPU with the instruction
+      if (function.hash(data.data(), SIZES[0], 0) == 0)
+        continue;
+      std::printf("%-20s", function.name);
+      for (u32 size : SIZES)
+      {
+        const u64 iterations = BYTES_PER_RUN / size;
+        u64 sum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (u64 i = 0; i < iterations; i++)
+          sum += function.hash(data.data(), size, samples);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        // Keeps the calls from being optimized out
+        EXPECT_NE(0u, sum | 1);
+        std::printf("%11.2f", iterations * size / elapsed.count() / 1e9);
+      }
+      std::printf("\n");
+    }
+  }
+}
@@ -0,0 +1,108 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
+
+TEST(ThreadPool, ParallelForCoversRangeOnce)
+{
+  const s32 begin = 17;
+  const s32 end = 10017;
+  for (s32 grain : {1, 3, 64, 20000})
+  {
+    std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[end - begin]);
+    for (s32 i = 0; i < end - begin; i++)
+      hits[i] = 0;
+
+    Common::ThreadPool::ParallelFor(begin, end,
+                                    [&](s32 l, s32 u) {
+                                      EXPECT_LE(begin, l);
+                                      EXPECT_LT(l, u);
+                                      EXPECT_LE(u, end);
+                                      for (s32 i = l; i < u; i++)
+                                        hits[i - begin]++;
+                                    },
+                                    grain);
+
+    for (s32 i = 0; i < end - begin; i++)
+      EXPECT_EQ(1, hits[i].load()) << "index " << i + begin << " grain " << grain;
+  }
+}
+
+TEST(ThreadPool, ParallelForEmptyRange)
+{
+  int calls = 0;
+  Common::ThreadPool::ParallelFor(5, 5, [&](s32, s32) { calls++; });
+  Common::ThreadPool::ParallelFor(5, 2, [&](s32, s32) { calls++; });
+  EXPECT_EQ(0, calls);
+}
+
+TEST(ThreadPool, ParallelForNested)
+{
+  std::atomic<int> total(0);
+  Common::ThreadPool::ParallelFor(0, 64, [&](s32 l, s32 u) {
+    for (s32 i = l; i < u; i++)
+    {
+      Common::ThreadPool::ParallelFor(0, 100, [&](s32 inner_l, s32 inner_u) {
+        total += inner_u - inner_l;
+      });
+    }
+  });
+  EXPECT_EQ(64 * 100, total.load());
+}
+
+namespace
+{
+// Runs a single task that blocks until it is released
+class BlockingWorker final : public Common::IWorker
+{
+public:
+  bool NextTask() override
+  {
+    if (started.exchange(true))
+      return false;
+    while (!released.load())
+      Common::YieldCPU();
+    finished.store(true);
+    return true;
+  }
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> released{false};
+  std::atomic<bool> finished{false};
+};
+}
+
+TEST(ThreadPool, UnregisterWaitsForRunningTask)
+{
+  auto worker = std::make_unique<BlockingWorker>();
+  Common::ThreadPool::RegisterWorker(worker.get());
+  Common::ThreadPool::NotifyWorkPending();
+  while (!worker->started.load())
+    Common::YieldCPU();
+
+  std::atomic<bool> unregistered{false};
+  bool finished_when_unregistered = false;
+  std::thread unregister([&] {
+    Common::ThreadPool::UnregisterWorker(worker.get());
+    finished_when_unregistered = worker->finished.load();
+    unregistered.store(true);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(unregistered.load());
+  worker->released.store(true);
+  unregister.join();
+
+  // The worker can be freed now
+  EXPECT_TRUE(finished_when_unregistered);
+  worker.reset();
+}
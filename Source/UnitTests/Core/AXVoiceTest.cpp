@@ -0,0 +1,131 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+
+#define AX_GC
+#include "Core/HW/DSPHLE/UCodes/AXVoice.h"
+
+namespace
+{
+std::vector<s16> MakeSamples(u32 count, u32 seed)
+{
+  std::vector<s16> samples(count);
+  u32 state = seed;
+  for (s16& sample : samples)
+  {
+    state = state * 1103515245 + 12345;
+    sample = static_cast<s16>(state >> 16);
+  }
+  // Extremes, which saturate with volumes above 1.0
+  samples[0] = -32768;
+  samples[count / 2] = 32767;
+  return samples;
+}
+
+// The mixing loop before it was vectorized
+void ReferenceMixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+  u16& volume = pvol[0];
+  u16 volume_delta = ramp ? pvol[1] : 0;
+  for (u32 i = 0; i < count; ++i)
+  {
+    s64 sample = input[i];
+    sample *= volume;
+    sample >>= 15;
+    sample = MathUtil::Clamp((s32)sample, -32767, 32767);
+    out[i] += (s16)sample;
+    volume += volume_delta;
+    *dpop = (s16)sample;
+  }
+}
+}
+
+TEST(AXVoice, MixAddMatchesReference)
+{
+  static const u16 VOLUMES[][2] = {
+      {0x0000, 0x0000}, {0x8000, 0x0000}, {0xFFFF, 0x0000}, {0x7FFF, 0x0123},
+      {0x8000, 0xFF00}, {0x0010, 0xFFFF}, {0xFFF0, 0x0001}, {0x1234, 0x8000},
+  };
+  static const u32 COUNTS[] = {1, 7, 8, 18, 32, 33, 96};
+
+  const std::vector<s16> input = MakeSamples(MAX_SAMPLES_PER_FRAME, 0x12345678);
+  for (const auto& volume : VOLUMES)
+  {
+    for (u32 count : COUNTS)
+    {
+      if (count > MAX_SAMPLES_PER_FRAME)
+        continue;
+      for (bool ramp : {false, true})
+      {
+        std::vector<int> expected_out(count, 1000), out(count, 1000);
+        u16 expected_vol[2] = {volume[0], volume[1]};
+        u16 vol[2] = {volume[0], volume[1]};
+        s16 expected_dpop = 0, dpop = 0;
+
+        ReferenceMixAdd(expected_out.data(), input.data(), count, expected_vol, &expected_dpop, ramp);
+        DSP::HLE::MixAdd(out.data(), input.data(), count, vol, &dpop, ramp);
+
+        EXPECT_EQ(expected_out, out) << "volume " << volume[0] << ", delta " << volume[1]
+                                     << ", count " << count << ", ramp " << ramp;
+        EXPECT_EQ(expected_vol[0], vol[0]);
+        EXPECT_EQ(expected_vol[1], vol[1]);
+        EXPECT_EQ(expected_dpop, dpop);
+      }
+    }
+  }
+}
+
+TEST(AXVoice, ApplyVolumeWorksInPlace)
+{
+  std::vector<s16> samples = MakeSamples(MAX_SAMPLES_PER_FRAME, 0x87654321);
+  std::vector<s16> expected(MAX_SAMPLES_PER_FRAME);
+  const u16 end_volume = DSP::HLE::ApplyVolume(expected.data(), samples.data(),
+                                               MAX_SAMPLES_PER_FRAME, 0xC000, 0xFFC0);
+  EXPECT_EQ(end_volume, DSP::HLE::ApplyVolume(samples.data(), samples.data(),
+                                              MAX_SAMPLES_PER_FRAME, 0xC000, 0xFFC0));
+  EXPECT_EQ(expected, samples);
+}
+
+// Not a correctness test: compares the speed of MixAdd with the scalar loop it replaced. Disabled
+// by default, run it with --gtest_also_run_disabled_tests.
+TEST(AXVoice, DISABLED_Benchmark)
+{
+  // Enough ms worth of voices to take a measurable time
+  const u32 ITERATIONS = 1000000;
+  const std::vector<s16> input = MakeSamples(MAX_SAMPLES_PER_FRAME, 0x12345678);
+  std::vector<int> expected_out(MAX_SAMPLES_PER_FRAME), out(MAX_SAMPLES_PER_FRAME);
+
+  using Clock = std::chrono::steady_clock;
+  u16 expected_vol[2] = {0x4000, 0x0001};
+  s16 expected_dpop = 0;
+  auto start = Clock::now();
+  for (u32 i = 0; i < ITERATIONS; ++i)
+  {
+    ReferenceMixAdd(expected_out.data(), input.data(), MAX_SAMPLES_PER_FRAME, expected_vol,
+                    &expected_dpop, true);
+  }
+  const std::chrono::duration<double, std::nano> reference_time = Clock::now() - start;
+
+  u16 vol[2] = {0x4000, 0x0001};
+  s16 dpop = 0;
+  start = Clock::now();
+  for (u32 i = 0; i < ITERATIONS; ++i)
+    DSP::HLE::MixAdd(out.data(), input.data(), MAX_SAMPLES_PER_FRAME, vol, &dpop, true);
+  const std::chrono::duration<double, std::nano> mix_time = Clock::now() - start;
+
+  // Also keeps the loops from being optimized out
+  EXPECT_EQ(expected_out, out);
+  EXPECT_EQ(expected_vol[0], vol[0]);
+  EXPECT_EQ(expected_dpop, dpop);
+  std::printf("MixAdd of %u samples: %.1f ns, scalar %.1f ns\n", MAX_SAMPLES_PER_FRAME,
+              mix_time.count() / ITERATIONS, reference_time.count() / ITERATIONS);
+}
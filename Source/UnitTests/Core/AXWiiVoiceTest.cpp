@@ -0,0 +1,215 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/DSP.h"
+#include "Core/DSPEmulator.h"
+#include "Core/HW/Memmap.h"
+
+#define AX_WII
+#include "Core/HW/DSPHLE/UCodes/AXVoice.h"
+
+namespace
+{
+using namespace DSP::HLE;
+
+const u32 NUM_VOICES = 7;
+const u32 PB_ADDRESS = 0x00010000;
+// In samples: 16-bit PCM data at 0x00100000 in MEM1
+const u32 SAMPLES_ADDRESS = 0x00080000;
+const u32 NUM_SAMPLES = 1000;
+
+// One frame of the 20 AXWii buffers
+struct Mix
+{
+  std::array<std::array<int, 96>, 20> buffers{};
+
+  AXBuffers GetBuffers()
+  {
+    AXBuffers ptrs;
+    for (size_t i = 0; i < buffers.size(); ++i)
+      ptrs.ptrs[i] = buffers[i].data();
+    return ptrs;
+  }
+};
+
+class AXWiiVoiceTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SConfig::Init();
+    SConfig::GetInstance().bWii = true;
+    Memory::Init();
+    CoreTiming::Init();
+    DSP::Init(true);
+    DSP::GetDSPEmulator()->Initialize(true, false);
+
+    u32 state = 0x12345678;
+    for (u32 i = 0; i < NUM_SAMPLES; ++i)
+    {
+      state = state * 1103515245 + 12345;
+      Memory::Write_U16(static_cast<u16>(state >> 16), (SAMPLES_ADDRESS + i) * 2);
+    }
+  }
+
+  void TearDown() override
+  {
+    DSP::Shutdown();
+    CoreTiming::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+  }
+
+  // Writes a list of looping voices at different pitches, all of them mixed to the main, aux and
+  // Wii Remote buffers
+  void WritePBs()
+  {
+    for (u32 voice = 0; voice < NUM_VOICES; ++voice)
+    {
+      AXPBWii pb = {};
+      const u32 next = voice + 1 < NUM_VOICES ? PB_ADDRESS + (voice + 1) * sizeof(AXPBWii) : 0;
+      pb.next_pb_hi = next >> 16;
+      pb.next_pb_lo = next & 0xFFFF;
+      pb.src_type = SRCTYPE_LINEAR;
+      pb.running = 1;
+
+      pb.mixer.left = 0x6000;
+      pb.mixer.left_delta = 0x0010;
+      pb.mixer.right = 0x3000;
+      pb.mixer.auxA_left = 0x7FFF;
+      pb.mixer.auxC_surround = 0x2000;
+      pb.vol_env.cur_volume = 0x7000;
+      pb.vol_env.cur_volume_delta = -4;
+
+      pb.audio_addr.looping = 1;
+      pb.audio_addr.sample_format = 0x0A;
+      pb.audio_addr.loop_addr_hi = SAMPLES_ADDRESS >> 16;
+      pb.audio_addr.loop_addr_lo = SAMPLES_ADDRESS & 0xFFFF;
+      pb.audio_addr.end_addr_hi = (SAMPLES_ADDRESS + NUM_SAMPLES - 1) >> 16;
+      pb.audio_addr.end_addr_lo = (SAMPLES_ADDRESS + NUM_SAMPLES - 1) & 0xFFFF;
+      pb.audio_addr.cur_addr_hi = (SAMPLES_ADDRESS + voice * 37) >> 16;
+      pb.audio_addr.cur_addr_lo = (SAMPLES_ADDRESS + voice * 37) & 0xFFFF;
+      const u32 ratio = 0x10000 + voice * 0x1800;
+      pb.src.ratio_hi = ratio >> 16;
+      pb.src.ratio_lo = ratio & 0xFFFF;
+
+      // All Wii Remote channels on, ramping on the odd ones
+      pb.remote = 1;
+      pb.remote_mixer_control = 0xBBBB;
+      u16* remote_volumes = reinterpret_cast<u16*>(&pb.remote_mixer);
+      for (u32 i = 0; i < sizeof(pb.remote_mixer) / sizeof(u16); i += 2)
+      {
+        remote_volumes[i] = static_cast<u16>(0x2000 + voice * 0x800 + i * 0x100);
+        remote_volumes[i + 1] = 0x0020;
+      }
+
+      WritePB(PB_ADDRESS + voice * sizeof(AXPBWii), pb);
+    }
+  }
+
+  std::vector<u16> ReadPBs()
+  {
+    std::vector<u16> pbs(NUM_VOICES * sizeof(AXPBWii) / sizeof(u16));
+    for (size_t i = 0; i < pbs.size(); ++i)
+      pbs[i] = Memory::Read_U16(PB_ADDRESS + static_cast<u32>(i) * 2);
+    return pbs;
+  }
+
+  // Compares the serial and the parallel processing of two frames of the voices
+  void CheckParallelMatchesSerial(bool ms_per_ms)
+  {
+    // Like AXWiiUCode::ProcessPBList, with an update of the left volume before every step
+    const AXMixControl mixer_control =
+        static_cast<AXMixControl>(MIX_L | MIX_L_RAMP | MIX_R | MIX_AUXA_L | MIX_AUXC_S);
+    const u32 num_steps = ms_per_ms ? 3 : 1;
+    auto update_pb = [](AXPBWii& pb, u32 step) {
+      pb.mixer.left = static_cast<u16>(0x6000 + step * 0x1000);
+    };
+    auto mix_pb = [&](AXPBWii& pb, AXBuffers buffers, u32 step) {
+      if (ms_per_ms)
+      {
+        for (u32 i = 0; i < step; ++i)
+          ForwardBuffersOneMs(buffers);
+        ProcessVoice(pb, buffers, 32, mixer_control, nullptr);
+      }
+      else
+      {
+        ProcessVoice(pb, buffers, 96, mixer_control, nullptr);
+      }
+    };
+    static const u32 buffer_sizes[] = {96, 96, 96, 96, 96, 96, 96, 96, 96, 96,
+                                       96, 96, 18, 18, 18, 18, 18, 18, 18, 18};
+
+    Mix serial[2];
+    WritePBs();
+    for (Mix& frame : serial)
+    {
+      const AXBuffers buffers = frame.GetBuffers();
+      for (u32 pb_addr = PB_ADDRESS; pb_addr;)
+      {
+        AXPBWii pb;
+        ReadPB(pb_addr, pb);
+        for (u32 step = 0; step < num_steps; ++step)
+        {
+          update_pb(pb, step);
+          mix_pb(pb, buffers, step);
+        }
+        WritePB(pb_addr, pb);
+        pb_addr = HILO_TO_32(pb.next_pb);
+      }
+    }
+    const std::vector<u16> serial_pbs = ReadPBs();
+
+    Mix parallel[2];
+    WritePBs();
+    for (Mix& frame : parallel)
+    {
+      ASSERT_TRUE(ProcessPBListParallel(PB_ADDRESS, frame.GetBuffers(), buffer_sizes, 96,
+                                        num_steps, [](const AXPBWii&) { return true; },
+                                        update_pb, mix_pb));
+    }
+    EXPECT_EQ(serial_pbs, ReadPBs());
+
+    // Left, right, auxA left, auxC surround and the Wii Remote ones
+    const std::vector<size_t> mixed = {0, 1, 3, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    for (u32 frame = 0; frame < 2; ++frame)
+    {
+      for (size_t i = 0; i < serial[frame].buffers.size(); ++i)
+      {
+        const auto& buffer = serial[frame].buffers[i];
+        EXPECT_EQ(buffer, parallel[frame].buffers[i]) << "frame " << frame << ", buffer " << i;
+
+        // The mixed buffers get a whole frame, and nothing past it
+        const bool is_mixed = std::find(mixed.begin(), mixed.end(), i) != mixed.end();
+        const auto frame_end = buffer.begin() + (is_mixed ? buffer_sizes[i] : 0);
+        if (is_mixed)
+        {
+          EXPECT_NE(0, *(frame_end - 1)) << "frame " << frame << ", buffer " << i;
+        }
+        EXPECT_TRUE(std::all_of(frame_end, buffer.end(), [](int sample) { return sample == 0; }))
+            << "frame " << frame << ", buffer " << i;
+      }
+    }
+  }
+};
+}
+
+TEST_F(AXWiiVoiceTest, ParallelMatchesSerial)
+{
+  CheckParallelMatchesSerial(false);
+}
+
+TEST_F(AXWiiVoiceTest, ParallelMatchesSerialMsPerMs)
+{
+  CheckParallelMatchesSerial(true);
+}
@@ -0,0 +1,173 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "TestUtils/TempDirectory.h"
+
+namespace
+{
+class FifoDataFileTest : public TempDirectoryTest
+{
+};
+
+std::vector<u8> MakeData(size_t size, u32 seed)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<u8>((i / 4) * seed + (i % 4));
+  return data;
+}
+
+// Like a game drawing the same scene: the same texture every frame, and new vertices
+FifoFrameInfo MakeFrame(u32 frame)
+{
+  FifoFrameInfo info;
+  info.fifoData = MakeData(20000 + frame, frame + 1);
+  info.fifoStart = 0x00200000;
+  info.fifoEnd = 0x00280000 + frame;
+
+  MemoryUpdate texture;
+  texture.fifoPosition = 16;
+  texture.address = 0x00400000;
+  texture.data = MakeData(64 * 1024, 3);
+  texture.type = MemoryUpdate::TEXTURE_MAP;
+  info.memoryUpdates.push_back(texture);
+
+  MemoryUpdate vertices;
+  vertices.fifoPosition = 256;
+  vertices.address = 0x10000000 + frame * 64;
+  vertices.data = MakeData(4096, frame * 7 + 5);
+  vertices.type = MemoryUpdate::VERTEX_STREAM;
+  info.memoryUpdates.push_back(vertices);
+  return info;
+}
+
+void ExpectEqual(const FifoFrameInfo& expected, const FifoFrameInfo& actual)
+{
+  EXPECT_EQ(expected.fifoData, actual.fifoData);
+  EXPECT_EQ(expected.fifoStart, actual.fifoStart);
+  EXPECT_EQ(expected.fifoEnd, actual.fifoEnd);
+  ASSERT_EQ(expected.memoryUpdates.size(), actual.memoryUpdates.size());
+  for (size_t i = 0; i < expected.memoryUpdates.size(); ++i)
+  {
+    EXPECT_EQ(expected.memoryUpdates[i].fifoPosition, actual.memoryUpdates[i].fifoPosition);
+    EXPECT_EQ(expected.memoryUpdates[i].address, actual.memoryUpdates[i].address);
+    EXPECT_EQ(expected.memoryUpdates[i].type, actual.memoryUpdates[i].type);
+    EXPECT_EQ(expected.memoryUpdates[i].data, actual.memoryUpdates[i].data);
+  }
+}
+
+std::unique_ptr<FifoDataFile> Record(u32 num_frames, const std::string& stream_filename)
+{
+  auto file = std::make_unique<FifoDataFile>();
+  file->SetIsWii(true);
+  file->GetBPMem()[0x10] = 0x12345678;
+  file->GetTexMem()[1000] = 0x9A;
+  if (!stream_filename.empty())
+  {
+    EXPECT_TRUE(file->StartStreaming(stream_filename));
+  }
+  for (u32 frame = 0; frame < num_frames; ++frame)
+    file->AddFrame(MakeFrame(frame));
+  return file;
+}
+}
+
+TEST_F(FifoDataFileTest, RoundTrips)
+{
+  for (bool compressed : {false, true})
+  {
+    const std::string filename = Path(compressed ? "compressed.dff" : "raw.dff");
+    {
+      auto file = Record(20, compressed ? Path("stream.tmp") : "");
+      EXPECT_EQ(compressed, file->IsCompressed());
+      // Recorded frames can be looked at before saving, even if the writer didn't get to them
+      ExpectEqual(MakeFrame(19), file->GetFrame(19));
+      ASSERT_TRUE(file->Save(filename));
+    }
+    EXPECT_FALSE(File::Exists(Path("stream.tmp")));
+
+    auto file = FifoDataFile::Load(filename, false);
+    ASSERT_NE(nullptr, file);
+    EXPECT_EQ(compressed, file->IsCompressed());
+    EXPECT_TRUE(file->GetIsWii());
+    EXPECT_FALSE(file->HasBrokenEFBCopies());
+    EXPECT_EQ(0x12345678u, file->GetBPMem()[0x10]);
+    EXPECT_EQ(0x9A, file->GetTexMem()[1000]);
+    ASSERT_EQ(20u, file->GetFrameCount());
+    for (u32 frame = 0; frame < 20; ++frame)
+      ExpectEqual(MakeFrame(frame), file->GetFrame(frame));
+
+    // A loaded compressed file can be saved again
+    ASSERT_TRUE(file->Save(Path("copy.dff")));
+    auto copy = FifoDataFile::Load(Path("copy.dff"), false);
+    ASSERT_NE(nullptr, copy);
+    ASSERT_EQ(20u, copy->GetFrameCount());
+    ExpectEqual(MakeFrame(7), copy->GetFrame(7));
+  }
+}
+
+TEST_F(FifoDataFileTest, DeduplicatesMemoryUpdates)
+{
+  ASSERT_TRUE(Record(50, "")->Save(Path("raw.dff")));
+  ASSERT_TRUE(Record(50, Path("stream.tmp"))->Save(Path("compressed.dff")));
+
+  // The texture is only stored once, instead of in all 50 frames
+  const u64 raw_size = File::GetSize(Path("raw.dff"));
+  const u64 compressed_size = File::GetSize(Path("compressed.dff"));
+  EXPECT_LT(compressed_size + 49 * 64 * 1024, raw_size);
+  std::printf("50 frames: %llu bytes raw, %llu bytes compressed\n",
+              static_cast<unsigned long long>(raw_size),
+              static_cast<unsigned long long>(compressed_size));
+}
+
+// Not a correctness test: times recording and playing raw and compressed logs. Disabled by
+// default, run it with --gtest_also_run_disabled_tests.
+TEST_F(FifoDataFileTest, DISABLED_Benchmark)
+{
+  const u32 FRAMES = 2000;
+  std::vector<FifoFrameInfo> frames;
+  for (u32 frame = 0; frame < FRAMES; ++frame)
+    frames.push_back(MakeFrame(frame % 100));
+
+  std::printf("%-12s%14s%14s\n", "", "record us/fr", "play us/fr");
+  for (bool compressed : {false, true})
+  {
+    const std::string filename = Path(compressed ? "compressed.dff" : "raw.dff");
+    FifoDataFile file;
+    if (compressed)
+    {
+      ASSERT_TRUE(file.StartStreaming(Path("stream.tmp")));
+    }
+
+    // Recording includes saving, which is where uncompressed files are written
+    auto start = std::chrono::steady_clock::now();
+    for (const FifoFrameInfo& frame : frames)
+      file.AddFrame(frame);
+    ASSERT_TRUE(file.Save(filename));
+    const std::chrono::duration<double, std::micro> record = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    auto loaded = FifoDataFile::Load(filename, false);
+    ASSERT_NE(nullptr, loaded);
+    size_t bytes = 0;
+    for (u32 frame = 0; frame < FRAMES; ++frame)
+      bytes += loaded->GetFrame(frame).fifoData.size();
+    const std::chrono::duration<double, std::micro> play = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(file.GetFifoDataSize(), bytes);
+    std::printf("%-12s%14.1f%14.1f\n", compressed ? "compressed" : "raw", record.count() / FRAMES,
+                play.count() / FRAMES);
+  }
+}
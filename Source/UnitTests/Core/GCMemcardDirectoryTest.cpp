@@ -0,0 +1,201 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/GCMemcard.h"
+#include "Core/HW/GCMemcardDirectory.h"
+#include "DiscIO/Enums.h"
+#include "TestUtils/TempDirectory.h"
+
+namespace
+{
+// The game ID of the save, so that it's loaded right away
+const u32 GAME_ID = 0x47414C45;  // GALE
+// The size of the EXI transfers games use to write saves
+const s32 WRITE_SIZE = 0x80;
+
+class GCMemcardDirectoryTest : public TempDirectoryTest
+{
+protected:
+  void SetUp() override
+  {
+    // Flushes are started by the tests instead of the flush thread
+    SConfig::Init();
+    SConfig::GetInstance().bEnableMemcardSdWriting = false;
+    ASSERT_NO_FATAL_FAILURE(TempDirectoryTest::SetUp());
+  }
+  void TearDown() override
+  {
+    TempDirectoryTest::TearDown();
+    SConfig::Shutdown();
+  }
+
+  // Creates a save of num_blocks blocks, where each byte is the index of its block
+  void CreateSave(u16 num_blocks)
+  {
+    DEntry header;
+    std::memcpy(header.Gamecode, "GALE", 4);
+    std::memcpy(header.Makercode, "01", 2);
+    std::memset(header.Filename, 0, sizeof(header.Filename));
+    std::strcpy(reinterpret_cast<char*>(header.Filename), "test");
+    *reinterpret_cast<u16*>(header.BlockCount) = Common::swap16(num_blocks);
+
+    File::IOFile file(SavePath(), "wb");
+    file.WriteBytes(&header, DENTRY_SIZE);
+    for (u16 i = 0; i < num_blocks; ++i)
+    {
+      const std::vector<u8> block(BLOCK_SIZE, static_cast<u8>(i));
+      file.WriteBytes(block.data(), block.size());
+    }
+  }
+
+  std::unique_ptr<GCMemcardDirectory> OpenCard()
+  {
+    auto card = std::make_unique<GCMemcardDirectory>(m_dir + DIR_SEP, 0, MemCard2043Mb, false,
+                                                     DiscIO::Region::NTSC_U, GAME_ID);
+    // The save is the first directory entry
+    DEntry entry;
+    card->Read(BLOCK_SIZE, DENTRY_SIZE, reinterpret_cast<u8*>(&entry));
+    m_first_block = Common::swap16(entry.FirstBlock);
+    return card;
+  }
+
+  // Card address of offset in block of the save
+  u32 Address(u16 block, u32 offset) const { return (m_first_block + block) * BLOCK_SIZE + offset; }
+
+  std::string SavePath() const { return Path("01-GALE-test.gci"); }
+
+  u8 ReadFile(u16 block, u32 offset) const
+  {
+    File::IOFile file(SavePath(), "rb");
+    file.Seek(DENTRY_SIZE + block * BLOCK_SIZE + offset, SEEK_SET);
+    u8 value = 0;
+    file.ReadBytes(&value, 1);
+    return value;
+  }
+
+  void WriteFile(u16 block, u32 offset, u8 value)
+  {
+    File::IOFile file(SavePath(), "r+b");
+    file.Seek(DENTRY_SIZE + block * BLOCK_SIZE + offset, SEEK_SET);
+    file.WriteBytes(&value, 1);
+  }
+
+  u16 m_first_block = 0;
+};
+}
+
+TEST_F(GCMemcardDirectoryTest, OnlyWritesChangedBlocks)
+{
+  CreateSave(4);
+  auto card = OpenCard();
+  ASSERT_NE(0, m_first_block);
+
+  const std::vector<u8> data(WRITE_SIZE, 0xAB);
+  for (u16 block : {1, 2})
+    card->Write(Address(block, 0x100), WRITE_SIZE, data.data());
+
+  // Blocks the game didn't write are left alone
+  WriteFile(0, 0x100, 0x55);
+  WriteFile(3, 0x100, 0x55);
+  card->FlushToFile();
+
+  EXPECT_EQ(0x55, ReadFile(0, 0x100));
+  EXPECT_EQ(0xAB, ReadFile(1, 0x100));
+  EXPECT_EQ(0xAB, ReadFile(2, 0x100));
+  EXPECT_EQ(1, ReadFile(1, 0x100 + WRITE_SIZE));
+  EXPECT_EQ(0x55, ReadFile(3, 0x100));
+  EXPECT_EQ(DENTRY_SIZE + 4u * BLOCK_SIZE, File::GetSize(SavePath()));
+}
+
+TEST_F(GCMemcardDirectoryTest, WritesAfterAFlushAreFlushed)
+{
+  CreateSave(2);
+  auto card = OpenCard();
+
+  // The second write goes to the block the first one left cached
+  const std::vector<u8> first(WRITE_SIZE, 0x11);
+  const std::vector<u8> second(WRITE_SIZE, 0x22);
+  card->Write(Address(1, 0), WRITE_SIZE, first.data());
+  card->FlushToFile();
+  card->Write(Address(1, WRITE_SIZE), WRITE_SIZE, second.data());
+  card->FlushToFile();
+
+  EXPECT_EQ(0x11, ReadFile(1, 0));
+  EXPECT_EQ(0x22, ReadFile(1, WRITE_SIZE));
+  EXPECT_EQ(0, ReadFile(0, 0));
+}
+
+TEST_F(GCMemcardDirectoryTest, WritesToABlockCachedByAReadAreFlushed)
+{
+  CreateSave(2);
+  auto card = OpenCard();
+
+  // Games read a block before they update it
+  std::vector<u8> data(WRITE_SIZE);
+  card->Read(Address(1, 0), WRITE_SIZE, data.data());
+  EXPECT_EQ(1, data[0]);
+  std::fill(data.begin(), data.end(), 0x33);
+  card->Write(Address(1, 0), WRITE_SIZE, data.data());
+  card->FlushToFile();
+
+  EXPECT_EQ(0x33, ReadFile(1, 0));
+}
+
+// Not a correctness test: times writes while the card is flushed over and over. Disabled by
+// default, run it with --gtest_also_run_disabled_tests.
+TEST_F(GCMemcardDirectoryTest, DISABLED_Benchmark)
+{
+  // A large save, flushed over and over while the game keeps writing to it
+  const u16 BLOCKS = 251;
+  CreateSave(BLOCKS);
+  auto card = OpenCard();
+
+  std::atomic<bool> done{false};
+  u32 flushes = 0;
+  std::thread flusher([&] {
+    while (!done)
+    {
+      card->FlushToFile();
+      ++flushes;
+    }
+  });
+
+  const std::vector<u8> data(WRITE_SIZE, 0x5A);
+  const u32 WRITES = 20000;
+  std::chrono::steady_clock::duration worst{};
+  const auto start = std::chrono::steady_clock::now();
+  for (u32 i = 0; i < WRITES; ++i)
+  {
+    const auto write_start = std::chrono::steady_clock::now();
+    const u32 offset = (i * WRITE_SIZE) % (16 * BLOCK_SIZE);
+    card->Write(Address(offset / BLOCK_SIZE, offset % BLOCK_SIZE), WRITE_SIZE, data.data());
+    worst = std::max(worst, std::chrono::steady_clock::now() - write_start);
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  done = true;
+  flusher.join();
+  card->FlushToFile();
+
+  EXPECT_EQ(0x5A, ReadFile(15, 0));
+  std::printf("%u writes during %u flushes: %.2f us average, %.1f us worst\n", WRITES, flushes,
+              elapsed.count() / WRITES,
+              std::chrono::duration<double, std::micro>(worst).count());
+}
@@ -0,0 +1,95 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PowerPC.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+// Physical address of the test block, with address translation off
+const u32 BLOCK_ADDRESS = 0x00003100;
+const u32 NUM_ADDS = 8;
+
+class Jit64Test : public testing::Test
+{
+protected:
+  void Start(bool background_compile)
+  {
+    SConfig::Init();
+    SConfig::GetInstance().bJITBackgroundCompile = background_compile;
+    SConfig::GetInstance().bFastmem = false;
+    Memory::Init();
+    PowerPC::Init(PowerPC::CORE_JIT64);
+    CoreTiming::Init();
+
+    // addi r3, r3, 1 repeated, then a branch to itself to end the block
+    for (u32 i = 0; i < NUM_ADDS; i++)
+      Memory::Write_U32(0x38630001, BLOCK_ADDRESS + i * 4);
+    Memory::Write_U32(0x48000000, BLOCK_ADDRESS + NUM_ADDS * 4);
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+  }
+
+  // What the dispatcher does on a miss
+  void Miss()
+  {
+    PC = BLOCK_ADDRESS;
+    PowerPC::ppcState.downcount = 1000;
+    g_jit->Jit(BLOCK_ADDRESS);
+  }
+
+  bool IsCompiled()
+  {
+    return g_jit->GetBlockCache()->GetBlockFromStartAddress(BLOCK_ADDRESS, MSR) != nullptr;
+  }
+};
+}
+
+TEST_F(Jit64Test, CompilesMissedBlocksRightAway)
+{
+  Start(false);
+  Miss();
+  EXPECT_TRUE(IsCompiled());
+  // The dispatcher can run the block without checking the downcount again
+  EXPECT_FALSE(Jit64::s_ran_block_in_interpreter);
+  EXPECT_EQ(1000, PowerPC::ppcState.downcount);
+  EXPECT_EQ(0u, GPR(3));
+}
+
+TEST_F(Jit64Test, RunsMissedBlocksInInterpreterWhileCompiling)
+{
+  Start(true);
+  Miss();
+  // The block ran, and the dispatcher must check the downcount it used up
+  EXPECT_TRUE(Jit64::s_ran_block_in_interpreter);
+  EXPECT_EQ(NUM_ADDS, GPR(3));
+  EXPECT_EQ(BLOCK_ADDRESS + NUM_ADDS * 4, PC);
+  EXPECT_GT(1000, PowerPC::ppcState.downcount);
+
+  // The compiled block is added on a later miss, once the compile thread is done with it
+  for (int i = 0; i < 5000 && Jit64::s_ran_block_in_interpreter; i++)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    Miss();
+  }
+  EXPECT_FALSE(Jit64::s_ran_block_in_interpreter);
+  EXPECT_TRUE(IsCompiled());
+}
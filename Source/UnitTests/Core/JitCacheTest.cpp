@@ -0,0 +1,176 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+class FakeJit : public JitBase
+{
+public:
+  // CPUCoreBase methods
+  void Init() override {}
+  void Shutdown() override {}
+  void ClearCache() override {}
+  void Run() override {}
+  void SingleStep() override {}
+  const char* GetName() override { return nullptr; }
+  // JitBase methods
+  JitBaseBlockCache* GetBlockCache() override { return nullptr; }
+  void Jit(u32 em_address) override {}
+  const CommonAsmRoutinesBase* GetAsmRoutines() override { return nullptr; }
+  bool HandleFault(uintptr_t access_address, SContext* ctx) override { return false; }
+};
+
+class TestBlockCache final : public JitBaseBlockCache
+{
+public:
+  explicit TestBlockCache(JitBase& jit) : JitBaseBlockCache(jit) {}
+
+  // Adds a block of contiguous instructions which exits to the instruction after it
+  JitBlock* AddBlock(u32 address, u32 num_instructions)
+  {
+    JitBlock* block = AllocateBlock(address);
+    block->checkedEntry = nullptr;
+    block->normalEntry = nullptr;
+    block->codeSize = 0;
+    block->originalSize = num_instructions;
+    block->linkData.push_back({nullptr, address + num_instructions * 4, false, false});
+
+    std::set<u32> physical_addresses;
+    for (u32 i = 0; i < num_instructions; i++)
+      physical_addresses.insert(address + i * 4);
+    FinalizeBlock(*block, true, physical_addresses);
+    return block;
+  }
+
+  size_t CountBlocks()
+  {
+    size_t count = 0;
+    RunOnBlocks([&count](const JitBlock&) { count++; });
+    return count;
+  }
+
+private:
+  void WriteLinkBlock(const JitBlock::LinkData& source, const JitBlock* dest) override {}
+};
+
+// A synthetic population: blocks of 1 to 32 instructions packed into the low part of MEM1
+void Populate(TestBlockCache& cache, u32 num_blocks)
+{
+  u32 state = 0x12345678;
+  u32 address = 0x80003100;
+  for (u32 i = 0; i < num_blocks; i++)
+  {
+    state = state * 1103515245 + 12345;
+    const u32 num_instructions = 1 + ((state >> 16) & 31);
+    cache.AddBlock(address, num_instructions);
+    address += num_instructions * 4;
+  }
+}
+}
+
+TEST(JitCache, ErasePhysicalRangeDestroysOverlappingBlocks)
+{
+  FakeJit jit;
+  TestBlockCache cache(jit);
+  cache.Clear();
+
+  cache.AddBlock(0x80000000, 8);
+  cache.AddBlock(0x80000100, 4);
+  // Spans two macro blocks
+  cache.AddBlock(0x800001F0, 8);
+  EXPECT_EQ(3u, cache.CountBlocks());
+
+  cache.ErasePhysicalRange(0x80000110, 0x10);
+  EXPECT_NE(nullptr, cache.GetBlockFromStartAddress(0x80000100, 0));
+
+  cache.ErasePhysicalRange(0x8000010C, 4);
+  EXPECT_EQ(nullptr, cache.GetBlockFromStartAddress(0x80000100, 0));
+  EXPECT_NE(nullptr, cache.GetBlockFromStartAddress(0x80000000, 0));
+  EXPECT_NE(nullptr, cache.GetBlockFromStartAddress(0x800001F0, 0));
+
+  cache.ErasePhysicalRange(0x80000200, 4);
+  EXPECT_EQ(nullptr, cache.GetBlockFromStartAddress(0x800001F0, 0));
+  EXPECT_EQ(1u, cache.CountBlocks());
+
+  // The block must be gone from the first macro block too
+  cache.AddBlock(0x800001F0, 2);
+  cache.ErasePhysicalRange(0x800001F0, 0x10);
+  EXPECT_EQ(1u, cache.CountBlocks());
+}
+
+TEST(JitCache, InvalidateICacheClearsLargeRanges)
+{
+  FakeJit jit;
+  TestBlockCache cache(jit);
+  cache.Clear();
+
+  Populate(cache, 1000);
+  cache.AddBlock(0x817FFFF8, 2);
+  EXPECT_EQ(1001u, cache.CountBlocks());
+
+  cache.InvalidateICache(0x80000000, 0x01000000, true);
+  EXPECT_EQ(1u, cache.CountBlocks());
+  cache.InvalidateICache(0x817FFFE0, 32, true);
+  EXPECT_EQ(0u, cache.CountBlocks());
+}
+
+// Not a correctness test: reports the cost of adding and invalidating blocks. Disabled by default,
+// run it with --gtest_also_run_disabled_tests.
+TEST(JitCache, DISABLED_Benchmark)
+{
+  FakeJit jit;
+  TestBlockCache cache(jit);
+  cache.Clear();
+
+  static const u32 NUM_BLOCKS[] = {1000, 10000, 50000};
+  std::printf("%-10s%14s%14s%14s%14s\n", "blocks", "add ns/blk", "dcbi ns/blk", "dma ns/blk",
+              "clear ns/blk");
+  for (u32 num_blocks : NUM_BLOCKS)
+  {
+    using Clock = std::chrono::steady_clock;
+    auto ns_per_block = [num_blocks](Clock::duration elapsed) {
+      return std::chrono::duration<double, std::nano>(elapsed).count() / num_blocks;
+    };
+
+    // Populate, then erase one cache line at a time like dcbi/icbi do
+    auto start = Clock::now();
+    Populate(cache, num_blocks);
+    const auto add_time = Clock::now() - start;
+    start = Clock::now();
+    for (u32 address = 0x80000000; address < 0x80003100 + num_blocks * 33 * 4; address += 32)
+      cache.InvalidateICache(address, 32, true);
+    const auto dcbi_time = Clock::now() - start;
+    EXPECT_EQ(0u, cache.CountBlocks());
+
+    // Erase in 4 KiB chunks like a DMA to code memory
+    Populate(cache, num_blocks);
+    start = Clock::now();
+    for (u32 address = 0x80000000; address < 0x80003100 + num_blocks * 33 * 4; address += 0x1000)
+      cache.ErasePhysicalRange(address, 0x1000);
+    const auto dma_time = Clock::now() - start;
+    EXPECT_EQ(0u, cache.CountBlocks());
+
+    // Erase all of MEM1 at once
+    Populate(cache, num_blocks);
+    start = Clock::now();
+    cache.ErasePhysicalRange(0x80000000, 0x01800000);
+    const auto clear_time = Clock::now() - start;
+    EXPECT_EQ(0u, cache.CountBlocks());
+
+    std::printf("%-10u%14.1f%14.1f%14.1f%14.1f\n", num_blocks, ns_per_block(add_time),
+                ns_per_block(dcbi_time), ns_per_block(dma_time), ns_per_block(clear_time));
+  }
+}
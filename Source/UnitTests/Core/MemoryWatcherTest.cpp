@@ -0,0 +1,242 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemoryWatcher.h"
+#include "TestUtils/TempDirectory.h"
+
+namespace
+{
+// Watched values live here, pointer tables for the chained entries right after.
+constexpr u32 VALUES_BASE = 0x80100000;
+constexpr u32 POINTERS_BASE = 0x80200000;
+
+class MemoryWatcherTest : public TempDirectoryTest
+{
+protected:
+  void SetUp() override
+  {
+    SConfig::Init();
+    Memory::Init();
+    ASSERT_NO_FATAL_FAILURE(TempDirectoryTest::SetUp());
+    m_locations_path = Path("Locations.txt");
+    m_socket_path = Path("MemoryWatcher");
+
+    m_reader_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    ASSERT_GE(m_reader_fd, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(0, bind(m_reader_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+  }
+
+  void TearDown() override
+  {
+    close(m_reader_fd);
+    TempDirectoryTest::TearDown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+  }
+
+  // Every other entry follows a pointer so both paths are measured.
+  void WriteLocations(size_t count)
+  {
+    std::ofstream locations(m_locations_path);
+    for (size_t i = 0; i < count; ++i)
+    {
+      const u32 value_address = VALUES_BASE + static_cast<u32>(i) * 4;
+      if (i % 2 == 0)
+      {
+        locations << StringFromFormat("%08x\n", value_address);
+      }
+      else
+      {
+        const u32 pointer_address = POINTERS_BASE + static_cast<u32>(i) * 4;
+        Memory::Write_U32(value_address - 0x10, pointer_address);
+        locations << StringFromFormat("%08x 10\n", pointer_address);
+      }
+    }
+  }
+
+  void SetValue(size_t index, u32 value)
+  {
+    Memory::Write_U32(value, VALUES_BASE + static_cast<u32>(index) * 4);
+  }
+
+  std::vector<u8> Receive()
+  {
+    std::vector<u8> buffer(1 << 16);
+    ssize_t size = recv(m_reader_fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+    buffer.resize(size > 0 ? size : 0);
+    return buffer;
+  }
+
+  void Drain()
+  {
+    while (!Receive().empty())
+    {
+    }
+  }
+
+  // Receives in the background until stopped, like a client keeping up with the
+  // game. Text mode sends block once the socket's queue is full.
+  std::thread StartReader(std::atomic<bool>* stop)
+  {
+    timeval timeout = {0, 10000};
+    setsockopt(m_reader_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return std::thread([this, stop] {
+      std::vector<u8> buffer(1 << 16);
+      while (!stop->load())
+        recv(m_reader_fd, buffer.data(), buffer.size(), 0);
+    });
+  }
+
+  std::string m_locations_path;
+  std::string m_socket_path;
+  int m_reader_fd = -1;
+};
+}
+
+TEST_F(MemoryWatcherTest, TextMode)
+{
+  WriteLocations(2);
+  MemoryWatcher watcher(m_locations_path, m_socket_path, MemoryWatcher::Mode::Text);
+  ASSERT_TRUE(watcher.IsRunning());
+
+  SetValue(1, 0xCAFE);
+  watcher.Step();
+  std::vector<u8> message = Receive();
+  EXPECT_EQ(StringFromFormat("%08x 10\ncafe", POINTERS_BASE + 4),
+            std::string(reinterpret_cast<const char*>(message.data())));
+
+  // Unchanged values aren't sent again
+  watcher.Step();
+  EXPECT_TRUE(Receive().empty());
+}
+
+TEST_F(MemoryWatcherTest, TextModeSendsInAddressOrder)
+{
+  {
+    std::ofstream locations(m_locations_path);
+    locations << StringFromFormat("%08x\n\n%08x\n%08x\n", VALUES_BASE + 4, VALUES_BASE,
+                                  VALUES_BASE + 4);
+  }
+  MemoryWatcher watcher(m_locations_path, m_socket_path, MemoryWatcher::Mode::Text);
+  ASSERT_TRUE(watcher.IsRunning());
+  // The empty line is watched too, the repeated one only once
+  EXPECT_EQ(3u, watcher.GetWatchCount());
+
+  SetValue(0, 1);
+  SetValue(1, 2);
+  watcher.Step();
+  std::vector<u8> message = Receive();
+  EXPECT_EQ(StringFromFormat("%08x\n1", VALUES_BASE),
+            std::string(reinterpret_cast<const char*>(message.data())));
+  message = Receive();
+  EXPECT_EQ(StringFromFormat("%08x\n2", VALUES_BASE + 4),
+            std::string(reinterpret_cast<const char*>(message.data())));
+  EXPECT_TRUE(Receive().empty());
+}
+
+TEST_F(MemoryWatcherTest, BinaryMode)
+{
+  WriteLocations(4);
+  MemoryWatcher watcher(m_locations_path, m_socket_path, MemoryWatcher::Mode::Binary);
+  ASSERT_TRUE(watcher.IsRunning());
+  EXPECT_EQ(4u, watcher.GetWatchCount());
+
+  SetValue(0, 11);
+  SetValue(3, 33);
+  watcher.Step();
+  std::vector<u8> message = Receive();
+  ASSERT_EQ(6 * sizeof(u32), message.size());
+  u32 words[6];
+  std::memcpy(words, message.data(), sizeof(words));
+  EXPECT_EQ(1u, words[0]);
+  EXPECT_EQ(2u, words[1]);
+  EXPECT_EQ(0u, words[2]);
+  EXPECT_EQ(11u, words[3]);
+  EXPECT_EQ(3u, words[4]);
+  EXPECT_EQ(33u, words[5]);
+
+  watcher.Step();
+  EXPECT_TRUE(Receive().empty());
+}
+
+TEST_F(MemoryWatcherTest, IndexSkipsEmptyAndRepeatedLines)
+{
+  {
+    std::ofstream locations(m_locations_path);
+    locations << StringFromFormat("%08x\n\n%08x\n%08x\n%08x\n", VALUES_BASE, VALUES_BASE + 4,
+                                  VALUES_BASE, VALUES_BASE + 8);
+  }
+  MemoryWatcher watcher(m_locations_path, m_socket_path, MemoryWatcher::Mode::Binary);
+  ASSERT_TRUE(watcher.IsRunning());
+  EXPECT_EQ(3u, watcher.GetWatchCount());
+
+  // The last line of the file is the third address
+  SetValue(2, 7);
+  watcher.Step();
+  std::vector<u8> message = Receive();
+  ASSERT_EQ(4 * sizeof(u32), message.size());
+  u32 words[4];
+  std::memcpy(words, message.data(), sizeof(words));
+  EXPECT_EQ(1u, words[1]);
+  EXPECT_EQ(2u, words[2]);
+  EXPECT_EQ(7u, words[3]);
+}
+
+TEST_F(MemoryWatcherTest, DISABLED_StepCost)
+{
+  constexpr int STEPS = 600;
+  for (size_t count : {16, 64, 256, 1024})
+  {
+    for (MemoryWatcher::Mode mode : {MemoryWatcher::Mode::Text, MemoryWatcher::Mode::Binary})
+    {
+      WriteLocations(count);
+      MemoryWatcher watcher(m_locations_path, m_socket_path, mode);
+      ASSERT_TRUE(watcher.IsRunning());
+
+      std::atomic<bool> stop{false};
+      std::thread reader = StartReader(&stop);
+
+      // Change every value on every step, the worst case for the transport.
+      double total_us = 0;
+      for (int step = 0; step < STEPS; ++step)
+      {
+        for (size_t i = 0; i < count; ++i)
+          SetValue(i, step + 1);
+        auto start = std::chrono::steady_clock::now();
+        watcher.Step();
+        total_us +=
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count();
+      }
+      stop = true;
+      reader.join();
+      Drain();
+      std::printf("MemoryWatcher %-6s %4zu addresses: %8.2f us/step\n",
+                  mode == MemoryWatcher::Mode::Text ? "text" : "binary", count, total_us / STEPS);
+    }
+  }
+}
@@ -0,0 +1,189 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/MovieStream.h"
+#include "TestUtils/TempDirectory.h"
+
+namespace
+{
+class MovieStreamTest : public TempDirectoryTest
+{
+};
+
+std::vector<u8> MakeInput(size_t size, u8 seed)
+{
+  std::vector<u8> input(size);
+  for (size_t i = 0; i < size; ++i)
+    input[i] = static_cast<u8>(i * 7 + seed);
+  return input;
+}
+
+std::vector<u8> ReadAll(Movie::InputStream& stream)
+{
+  std::vector<u8> input(static_cast<size_t>(stream.GetSize()));
+  EXPECT_TRUE(stream.Read(0, input.data(), input.size()));
+  return input;
+}
+}
+
+TEST_F(MovieStreamTest, AppendsAcrossChunks)
+{
+  Movie::InputStream stream;
+  ASSERT_TRUE(stream.Create(Path("a.dtm"), 1));
+
+  // Records of the sizes GC pads and Wii remotes use, spanning several chunks
+  const std::vector<u8> input = MakeInput(Movie::InputStream::CHUNK_SIZE * 3 + 100, 3);
+  for (size_t offset = 0; offset < input.size();)
+  {
+    const size_t size = std::min<size_t>(offset % 3 ? 8 : 23, input.size() - offset);
+    stream.Write(offset, &input[offset], size);
+    offset += size;
+    if (offset / 4096 == (offset - size) / 4096)
+      continue;
+
+    // Reading back the most recent input, which the writer may not have reached yet
+    u8 last;
+    ASSERT_TRUE(stream.Read(offset - 1, &last, 1));
+    EXPECT_EQ(input[offset - 1], last);
+  }
+  EXPECT_EQ(input, ReadAll(stream));
+  u8 past_end[8];
+  EXPECT_FALSE(stream.Read(input.size() - 4, past_end, sizeof(past_end)));
+
+  stream.Flush();
+  EXPECT_EQ(Movie::InputStream::HEADER_SIZE + input.size(), File::GetSize(Path("a.dtm")));
+}
+
+TEST_F(MovieStreamTest, RerecordsInvalidateLaterPrefixes)
+{
+  Movie::InputStream stream;
+  ASSERT_TRUE(stream.Create(Path("a.dtm"), 1));
+
+  std::vector<u8> input = MakeInput(1000, 5);
+  stream.Write(0, input.data(), input.size());
+  const u32 generation = stream.GetGeneration();
+  EXPECT_TRUE(stream.IsUnchangedSince(generation, 1000));
+  EXPECT_FALSE(stream.IsUnchangedSince(generation, 1001));
+
+  // Load a state at byte 600 and record something else
+  const std::vector<u8> rerecord = MakeInput(200, 9);
+  stream.Write(600, rerecord.data(), rerecord.size());
+  input.resize(600);
+  input.insert(input.end(), rerecord.begin(), rerecord.end());
+  EXPECT_EQ(input, ReadAll(stream));
+
+  EXPECT_TRUE(stream.IsUnchangedSince(generation, 600));
+  EXPECT_FALSE(stream.IsUnchangedSince(generation, 700));
+  EXPECT_TRUE(stream.IsUnchangedSince(stream.GetGeneration(), 800));
+}
+
+TEST_F(MovieStreamTest, RecordingContinuesInACopy)
+{
+  const std::vector<u8> input = MakeInput(5000, 1);
+  {
+    File::IOFile file(Path("movie.dtm"), "wb");
+    const std::vector<u8> header(Movie::InputStream::HEADER_SIZE, 0xAA);
+    file.WriteBytes(header.data(), header.size());
+    file.WriteBytes(input.data(), input.size());
+  }
+
+  Movie::InputStream stream;
+  ASSERT_TRUE(stream.Open(Path("movie.dtm"), 2));
+  EXPECT_TRUE(stream.IsReadOnly());
+  EXPECT_EQ(input, ReadAll(stream));
+
+  ASSERT_TRUE(stream.MakeWritable(Path("copy.dtm")));
+  const u8 record[8] = {};
+  stream.Write(4000, record, sizeof(record));
+  const std::vector<u8> header(Movie::InputStream::HEADER_SIZE, 0x55);
+  ASSERT_TRUE(stream.Save(Path("export.dtm"), header.data(), 4004));
+  stream.Close();
+
+  // The played movie is left alone
+  EXPECT_EQ(Movie::InputStream::HEADER_SIZE + input.size(), File::GetSize(Path("movie.dtm")));
+  EXPECT_EQ(Movie::InputStream::HEADER_SIZE + 4008, File::GetSize(Path("copy.dtm")));
+
+  std::vector<u8> exported(Movie::InputStream::HEADER_SIZE + 4004);
+  File::IOFile file(Path("export.dtm"), "rb");
+  ASSERT_EQ(exported.size(), file.GetSize());
+  file.ReadBytes(exported.data(), exported.size());
+  EXPECT_EQ(0x55, exported[0]);
+  EXPECT_EQ(input[3999], exported[Movie::InputStream::HEADER_SIZE + 3999]);
+  EXPECT_EQ(0, exported[Movie::InputStream::HEADER_SIZE + 4000]);
+}
+
+TEST_F(MovieStreamTest, SavesOverItsOwnFile)
+{
+  Movie::InputStream stream;
+  ASSERT_TRUE(stream.Create(Path("a.dtm"), 1));
+  std::vector<u8> input = MakeInput(Movie::InputStream::CHUNK_SIZE + 1000, 4);
+  stream.Write(0, input.data(), input.size());
+  // Maps the whole file
+  EXPECT_EQ(input, ReadAll(stream));
+
+  const std::vector<u8> header(Movie::InputStream::HEADER_SIZE, 0x55);
+  ASSERT_TRUE(stream.Save(Path("a.dtm"), header.data(), 3000));
+  EXPECT_EQ(Movie::InputStream::HEADER_SIZE + 3000, File::GetSize(Path("a.dtm")));
+  EXPECT_EQ(3000u, stream.GetSize());
+  input.resize(3000);
+  EXPECT_EQ(input, ReadAll(stream));
+
+  // Recording goes on after the saved input
+  const std::vector<u8> record = MakeInput(8, 9);
+  stream.Write(3000, record.data(), record.size());
+  input.insert(input.end(), record.begin(), record.end());
+  EXPECT_EQ(input, ReadAll(stream));
+  stream.Close();
+
+  std::vector<u8> saved(Movie::InputStream::HEADER_SIZE + input.size());
+  File::IOFile file(Path("a.dtm"), "rb");
+  ASSERT_EQ(saved.size(), file.GetSize());
+  file.ReadBytes(saved.data(), saved.size());
+  EXPECT_EQ(0x55, saved[0]);
+  EXPECT_TRUE(std::equal(input.begin(), input.end(), saved.begin() + header.size()));
+}
+
+TEST_F(MovieStreamTest, FillsGapsWithZeros)
+{
+  Movie::InputStream stream;
+  ASSERT_TRUE(stream.Create(Path("a.dtm"), 1));
+  const std::vector<u8> input = MakeInput(100, 2);
+  stream.Write(0, input.data(), input.size());
+  stream.Write(Movie::InputStream::CHUNK_SIZE + 200, input.data(), input.size());
+
+  std::vector<u8> expected = input;
+  expected.resize(Movie::InputStream::CHUNK_SIZE + 200);
+  expected.insert(expected.end(), input.begin(), input.end());
+  EXPECT_EQ(expected, ReadAll(stream));
+}
+
+// Not a correctness test: times appending input. Disabled by default, run it with
+// --gtest_also_run_disabled_tests.
+TEST_F(MovieStreamTest, DISABLED_Benchmark)
+{
+  // An hour of four GC pads at 60 polls per second
+  const size_t RECORDS = 60 * 60 * 60 * 4;
+  const u8 record[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+  Movie::InputStream stream;
+  ASSERT_TRUE(stream.Create(Path("a.dtm"), 1));
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < RECORDS; ++i)
+    stream.Write(i * sizeof(record), record, sizeof(record));
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  stream.Flush();
+
+  EXPECT_EQ(RECORDS * sizeof(record), stream.GetSize());
+  std::printf("Streamed %zu records: %.1f ns per record\n", RECORDS, elapsed.count() / RECORDS);
+}
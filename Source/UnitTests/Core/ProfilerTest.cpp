@@ -0,0 +1,107 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/PowerPC/Profiler.h"
+#include "TestUtils/TempDirectory.h"
+
+namespace
+{
+// Samples two blocks, without the sampler thread
+void SampleTwoBlocks()
+{
+  Profiler::StartSampling(0);
+  Profiler::g_current_block = 0x80003100;
+  Profiler::TakeSample();
+  Profiler::TakeSample();
+  Profiler::g_current_block = 0x80004000;
+  Profiler::TakeSample();
+  Profiler::StopSampling();
+}
+
+class ProfilerTest : public TempDirectoryTest
+{
+};
+}
+
+TEST(Profiler, SamplesCurrentBlock)
+{
+  SampleTwoBlocks();
+  EXPECT_FALSE(Profiler::g_SampleBlocks);
+
+  const std::vector<Profiler::Sample> samples = Profiler::GetSamples();
+  ASSERT_EQ(3u, samples.size());
+  EXPECT_EQ(0x80003100u, samples[0].address);
+  EXPECT_EQ(0x80003100u, samples[1].address);
+  EXPECT_EQ(0x80004000u, samples[2].address);
+  EXPECT_LE(samples[0].time_us, samples[1].time_us);
+  EXPECT_LE(samples[1].time_us, samples[2].time_us);
+}
+
+TEST(Profiler, KeepsMostRecentSamples)
+{
+  // The size of the ring buffer
+  const size_t BUFFER_SIZE = 64 * 1024;
+
+  Profiler::StartSampling(0);
+  Profiler::g_current_block = 0x80003100;
+  for (size_t i = 0; i < BUFFER_SIZE; i++)
+    Profiler::TakeSample();
+  for (u32 i = 0; i < 3; i++)
+  {
+    Profiler::g_current_block = 0x80004000 + i * 4;
+    Profiler::TakeSample();
+  }
+  Profiler::StopSampling();
+
+  const std::vector<Profiler::Sample> samples = Profiler::GetSamples();
+  ASSERT_EQ(BUFFER_SIZE, samples.size());
+  EXPECT_EQ(0x80003100u, samples.front().address);
+  EXPECT_EQ(0x80003100u, samples[BUFFER_SIZE - 4].address);
+  EXPECT_EQ(0x80004000u, samples[BUFFER_SIZE - 3].address);
+  EXPECT_EQ(0x80004004u, samples[BUFFER_SIZE - 2].address);
+  EXPECT_EQ(0x80004008u, samples.back().address);
+  for (size_t i = 1; i < samples.size(); i++)
+    ASSERT_LE(samples[i - 1].time_us, samples[i].time_us);
+}
+
+TEST(Profiler, SamplerThreadTakesSamples)
+{
+  Profiler::StartSampling(100);
+  EXPECT_TRUE(Profiler::g_SampleBlocks);
+  Profiler::g_current_block = 0x80003100;
+  for (int i = 0; i < 5000 && Profiler::GetSamples().empty(); i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  Profiler::StopSampling();
+  EXPECT_FALSE(Profiler::g_SampleBlocks);
+  ASSERT_FALSE(Profiler::GetSamples().empty());
+
+  // The sampler may run before the store
+  const u32 address = Profiler::GetSamples().back().address;
+  EXPECT_TRUE(address == 0 || address == 0x80003100);
+}
+
+TEST_F(ProfilerTest, WritesChromeTrace)
+{
+  SampleTwoBlocks();
+  Profiler::WriteSampleTrace(Path("trace.json"));
+  std::string trace;
+  ASSERT_TRUE(File::ReadFileToString(Path("trace.json"), trace));
+
+  EXPECT_EQ(0u, trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_EQ(trace.size() - 4, trace.rfind("\n]}\n"));
+  // The two samples of the first function are merged, the last one has no following sample to
+  // end it
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"80003100\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"args\":{\"samples\":2}"));
+  EXPECT_EQ(std::string::npos, trace.find("\"name\":\"80004000\""));
+}
@@ -0,0 +1,107 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/Rewind.h"
+
+namespace
+{
+constexpr size_t STATE_SIZE = 256 * 1024;
+
+// Like consecutive savestates: mostly the same data, with a few changes and a varying size
+std::vector<u8> MakeState(u32 index)
+{
+  std::vector<u8> state(STATE_SIZE + index * 3);
+  for (size_t i = 0; i < state.size(); ++i)
+    state[i] = static_cast<u8>(i * 7 + (i >> 12));
+  for (u32 i = 0; i < 64; ++i)
+    state[(index * 4099 + i * 97) % state.size()] = static_cast<u8>(index + i);
+  return state;
+}
+
+void Push(Rewind::History* history, u32 index)
+{
+  std::vector<u8> state = MakeState(index);
+  history->Push(state);
+}
+}
+
+TEST(RewindHistory, StartsEmpty)
+{
+  Rewind::History history(64 * 1024 * 1024);
+  EXPECT_TRUE(history.GetLatest().empty());
+  EXPECT_EQ(0u, history.GetOlderCount());
+  EXPECT_FALSE(history.Pop());
+}
+
+TEST(RewindHistory, StepsBackThroughEverySnapshot)
+{
+  Rewind::History history(64 * 1024 * 1024);
+  for (u32 i = 0; i < 10; ++i)
+    Push(&history, i);
+  EXPECT_EQ(9u, history.GetOlderCount());
+  EXPECT_EQ(MakeState(9), history.GetLatest());
+
+  for (u32 i = 9; i-- > 0;)
+  {
+    ASSERT_TRUE(history.Pop());
+    EXPECT_EQ(MakeState(i), history.GetLatest());
+  }
+  EXPECT_FALSE(history.Pop());
+  EXPECT_EQ(MakeState(0), history.GetLatest());
+}
+
+TEST(RewindHistory, ContinuesAfterSteppingBack)
+{
+  Rewind::History history(64 * 1024 * 1024);
+  for (u32 i = 0; i < 4; ++i)
+    Push(&history, i);
+  ASSERT_TRUE(history.Pop());
+  ASSERT_TRUE(history.Pop());
+
+  // Emulation goes on from state 1 and takes a different path
+  Push(&history, 20);
+  EXPECT_EQ(2u, history.GetOlderCount());
+  ASSERT_TRUE(history.Pop());
+  EXPECT_EQ(MakeState(1), history.GetLatest());
+  ASSERT_TRUE(history.Pop());
+  EXPECT_EQ(MakeState(0), history.GetLatest());
+}
+
+TEST(RewindHistory, DeltasAreSmall)
+{
+  Rewind::History history(64 * 1024 * 1024);
+  for (u32 i = 0; i < 10; ++i)
+    Push(&history, i);
+  EXPECT_LT(history.GetSize(), 2 * STATE_SIZE);
+}
+
+TEST(RewindHistory, DropsOldestSnapshotsOverBudget)
+{
+  Rewind::History unlimited(64 * 1024 * 1024);
+  Push(&unlimited, 0);
+  Push(&unlimited, 1);
+  const size_t delta_size = unlimited.GetSize() - unlimited.GetLatest().size();
+
+  // Room for the newest state and about three deltas
+  const size_t budget = STATE_SIZE + 100 * 3 + delta_size * 7 / 2;
+  Rewind::History history(budget);
+  for (u32 i = 0; i < 20; ++i)
+  {
+    Push(&history, i);
+    EXPECT_LE(history.GetSize(), budget);
+  }
+  EXPECT_GE(history.GetOlderCount(), 2u);
+  EXPECT_LE(history.GetOlderCount(), 4u);
+
+  // The snapshots that are left are still correct
+  u32 index = 19;
+  while (history.Pop())
+    EXPECT_EQ(MakeState(--index), history.GetLatest());
+  EXPECT_LT(0u, index);
+}
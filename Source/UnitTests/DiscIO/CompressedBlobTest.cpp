@@ -0,0 +1,130 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CompressedBlob.h"
+#include "TestUtils/TempDirectory.h"
+
+namespace
+{
+constexpr u32 BLOCK_SIZE = 16384;
+
+bool NullCallback(const std::string&, float, void*)
+{
+  return true;
+}
+
+// Builds an image that looks roughly like a disc: runs of padding, repetitive
+// structured data and incompressible (already compressed) file data.
+std::vector<u8> MakeSyntheticImage(size_t size)
+{
+  std::vector<u8> image(size);
+  u32 seed = 0x12345678;
+  for (size_t i = 0; i < size; ++i)
+  {
+    const size_t region = (i / (BLOCK_SIZE * 7)) % 3;
+    if (region == 0)
+    {
+      image[i] = 0;
+    }
+    else if (region == 1)
+    {
+      image[i] = static_cast<u8>((i * 31) ^ (i >> 9));
+    }
+    else
+    {
+      seed = seed * 1664525 + 1013904223;
+      image[i] = static_cast<u8>(seed >> 24);
+    }
+  }
+  return image;
+}
+
+class CompressedBlobTest : public TempDirectoryTest
+{
+protected:
+  void SetUp() override
+  {
+    ASSERT_NO_FATAL_FAILURE(TempDirectoryTest::SetUp());
+    m_iso_path = Path("image.iso");
+    m_gcz_path = Path("image.gcz");
+    m_out_path = Path("image.out");
+  }
+
+  void WriteImage(const std::vector<u8>& image)
+  {
+    File::IOFile file(m_iso_path, "wb");
+    ASSERT_TRUE(file.WriteBytes(image.data(), image.size()));
+  }
+
+  std::vector<u8> ReadOutput()
+  {
+    std::string data;
+    File::ReadFileToString(m_out_path, data);
+    return std::vector<u8>(data.begin(), data.end());
+  }
+
+  std::string m_iso_path;
+  std::string m_gcz_path;
+  std::string m_out_path;
+};
+}
+
+TEST_F(CompressedBlobTest, RoundTrip)
+{
+  // Not a multiple of the block size, so the last block is padded.
+  const std::vector<u8> image = MakeSyntheticImage(BLOCK_SIZE * 300 + 1234);
+  WriteImage(image);
+
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(m_iso_path, m_gcz_path, 0, BLOCK_SIZE, NullCallback,
+                                         nullptr));
+
+  File::IOFile gcz(m_gcz_path, "rb");
+  std::unique_ptr<DiscIO::CompressedBlobReader> reader =
+      DiscIO::CompressedBlobReader::Create(std::move(gcz), m_gcz_path);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(image.size(), reader->GetDataSize());
+  EXPECT_EQ(301u, reader->GetHeader().num_blocks);
+
+  std::vector<u8> read_back(image.size());
+  ASSERT_TRUE(reader->Read(0, read_back.size(), read_back.data()));
+  EXPECT_EQ(image, read_back);
+  reader.reset();
+
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_gcz_path, m_out_path, NullCallback, nullptr));
+  EXPECT_EQ(image, ReadOutput());
+}
+
+TEST_F(CompressedBlobTest, DISABLED_Throughput)
+{
+  const std::vector<u8> image = MakeSyntheticImage(BLOCK_SIZE * 1024);
+  WriteImage(image);
+  const double megabytes = image.size() / (1024.0 * 1024.0);
+
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(m_iso_path, m_gcz_path, 0, BLOCK_SIZE, NullCallback,
+                                         nullptr));
+  auto compressed = std::chrono::steady_clock::now();
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_gcz_path, m_out_path, NullCallback, nullptr));
+  auto decompressed = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(image, ReadOutput());
+
+  const double compress_s = std::chrono::duration<double>(compressed - start).count();
+  const double decompress_s = std::chrono::duration<double>(decompressed - compressed).count();
+  std::printf("GCZ compress:   %.1f MiB in %.3f s (%.1f MiB/s)\n", megabytes, compress_s,
+              megabytes / compress_s);
+  std::printf("GCZ decompress: %.1f MiB in %.3f s (%.1f MiB/s)\n", megabytes, decompress_s,
+              megabytes / decompress_s);
+}
@@ -0,0 +1,155 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mbedtls/aes.h>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/VolumeWiiCrypted.h"
+
+namespace
+{
+using DiscIO::CVolumeWiiCrypted;
+
+constexpr u64 DATA_OFFSET = 0x20000;
+constexpr u64 NUM_BLOCKS = 2 * CVolumeWiiCrypted::CACHED_BLOCKS + 8;
+const std::array<u8, 16> KEY = {{0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78, 0x87, 0x96,
+                                 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0}};
+
+u8 PlainByte(u64 offset)
+{
+  return static_cast<u8>((offset / CVolumeWiiCrypted::BLOCK_DATA_SIZE) * 13 + offset * 7);
+}
+
+// An encrypted partition at offset 0 that counts the reads made to it
+class CountingBlobReader : public DiscIO::IBlobReader
+{
+public:
+  CountingBlobReader() : m_data(DATA_OFFSET + NUM_BLOCKS * CVolumeWiiCrypted::BLOCK_TOTAL_SIZE)
+  {
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, KEY.data(), 128);
+    std::vector<u8> plain(CVolumeWiiCrypted::BLOCK_DATA_SIZE);
+    for (u64 block = 0; block < NUM_BLOCKS; ++block)
+    {
+      for (u64 i = 0; i < plain.size(); ++i)
+        plain[i] = PlainByte(block * CVolumeWiiCrypted::BLOCK_DATA_SIZE + i);
+      u8* encrypted = &m_data[DATA_OFFSET + block * CVolumeWiiCrypted::BLOCK_TOTAL_SIZE];
+      u8 iv[16];
+      for (u8 i = 0; i < 16; ++i)
+        iv[i] = encrypted[0x3D0 + i] = static_cast<u8>(block + i);
+      mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_ENCRYPT, plain.size(), iv, plain.data(),
+                            encrypted + CVolumeWiiCrypted::BLOCK_HEADER_SIZE);
+    }
+    mbedtls_aes_free(&aes);
+  }
+
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::PLAIN; }
+  u64 GetRawSize() const override { return m_data.size(); }
+  u64 GetDataSize() const override { return m_data.size(); }
+  bool Read(u64 offset, u64 size, u8* out_ptr) override
+  {
+    if (offset + size > m_data.size())
+      return false;
+    ++m_reads;
+    std::copy(m_data.begin() + offset, m_data.begin() + offset + size, out_ptr);
+    return true;
+  }
+
+  u32 GetReadCount() const { return m_reads; }
+
+private:
+  std::vector<u8> m_data;
+  u32 m_reads = 0;
+};
+
+class VolumeWiiCryptedTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    auto reader = std::make_unique<CountingBlobReader>();
+    m_reader = reader.get();
+    m_volume = std::make_unique<CVolumeWiiCrypted>(std::move(reader), 0, KEY.data());
+  }
+
+  // Reads the start of a block and checks that it was decrypted correctly
+  void ReadBlock(u64 block)
+  {
+    const u64 offset = block * CVolumeWiiCrypted::BLOCK_DATA_SIZE;
+    u8 data[0x20];
+    ASSERT_TRUE(m_volume->Read(offset, sizeof(data), data, true));
+    for (u64 i = 0; i < sizeof(data); ++i)
+      ASSERT_EQ(PlainByte(offset + i), data[i]);
+  }
+
+  CountingBlobReader* m_reader = nullptr;
+  std::unique_ptr<CVolumeWiiCrypted> m_volume;
+};
+}
+
+TEST_F(VolumeWiiCryptedTest, ReadsAcrossBlocks)
+{
+  const u64 offset = 3 * CVolumeWiiCrypted::BLOCK_DATA_SIZE - 100;
+  std::vector<u8> data(CVolumeWiiCrypted::BLOCK_DATA_SIZE + 200);
+  ASSERT_TRUE(m_volume->Read(offset, data.size(), data.data(), true));
+  for (u64 i = 0; i < data.size(); ++i)
+    ASSERT_EQ(PlainByte(offset + i), data[i]);
+  // The three blocks are fetched with a single read
+  EXPECT_EQ(1u, m_reader->GetReadCount());
+}
+
+TEST_F(VolumeWiiCryptedTest, CacheHit)
+{
+  ReadBlock(10);
+  EXPECT_EQ(1u, m_reader->GetReadCount());
+  ReadBlock(10);
+  EXPECT_EQ(1u, m_reader->GetReadCount());
+}
+
+TEST_F(VolumeWiiCryptedTest, CacheMiss)
+{
+  ReadBlock(10);
+  ReadBlock(40);
+  EXPECT_EQ(2u, m_reader->GetReadCount());
+  ReadBlock(20);
+  EXPECT_EQ(3u, m_reader->GetReadCount());
+}
+
+TEST_F(VolumeWiiCryptedTest, EvictsLeastRecentlyUsed)
+{
+  // Every other block, so that the reads don't look sequential and nothing is read ahead
+  const u64 blocks = CVolumeWiiCrypted::CACHED_BLOCKS;
+  for (u64 i = 0; i < blocks; ++i)
+    ReadBlock(i * 2);
+  ASSERT_EQ(blocks, m_reader->GetReadCount());
+
+  // Block 0 becomes the most recently used, block 2 the least
+  ReadBlock(0);
+  ReadBlock(blocks * 2 + 1);
+  EXPECT_EQ(blocks + 1, m_reader->GetReadCount());
+
+  ReadBlock(0);
+  EXPECT_EQ(blocks + 1, m_reader->GetReadCount());
+  ReadBlock(2);
+  EXPECT_EQ(blocks + 2, m_reader->GetReadCount());
+}
+
+TEST_F(VolumeWiiCryptedTest, ReadsAheadWhenSequential)
+{
+  ReadBlock(5);
+  ReadBlock(6);
+  EXPECT_EQ(2u, m_reader->GetReadCount());
+  for (u64 block = 7; block < 7 + CVolumeWiiCrypted::READ_AHEAD_BLOCKS; ++block)
+    ReadBlock(block);
+  EXPECT_EQ(2u, m_reader->GetReadCount());
+}
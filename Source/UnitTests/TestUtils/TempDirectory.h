@@ -0,0 +1,35 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+
+// Fixture for tests working on files: every test gets a new empty directory, which is deleted
+// with everything in it once the test is done. Fixtures overriding SetUp or TearDown must call
+// these ones too.
+class TempDirectoryTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = File::CreateTempDir();
+    ASSERT_FALSE(m_dir.empty());
+  }
+  void TearDown() override
+  {
+    if (!m_dir.empty())
+      File::DeleteDirRecursively(m_dir);
+  }
+
+  // Path of a file in the directory
+  std::string Path(const std::string& name) const { return m_dir + DIR_SEP + name; }
+
+  std::string m_dir;
+};
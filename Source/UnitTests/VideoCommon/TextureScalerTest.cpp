@@ -0,0 +1,213 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
+#include "VideoCommon/TextureScalerCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+struct ReferenceTexture
+{
+  const char* name;
+  int width;
+  int height;
+  std::vector<u32> pixels;
+};
+
+// Synthetic stand-ins for the kind of content games upload: smooth gradients, hard edged
+// pixel art, high frequency noise, and a non power of two atlas with transparent areas.
+std::vector<ReferenceTexture> MakeReferenceTextures()
+{
+  std::vector<ReferenceTexture> textures;
+
+  ReferenceTexture gradient{"gradient", 256, 256, {}};
+  for (int y = 0; y < gradient.height; y++)
+    for (int x = 0; x < gradient.width; x++)
+      gradient.pixels.push_back(0xFF000000 | (x << 16) | (y << 8) | ((x + y) / 2));
+  textures.push_back(gradient);
+
+  ReferenceTexture sprite{"sprite", 64, 64, {}};
+  for (int y = 0; y < sprite.height; y++)
+  {
+    for (int x = 0; x < sprite.width; x++)
+    {
+      const int dx = x - 32, dy = y - 32;
+      const bool inside = dx * dx + dy * dy < 24 * 24;
+      const bool stripe = ((x / 4) + (y / 8)) % 3 == 0;
+      sprite.pixels.push_back(!inside ? 0x00000000 : stripe ? 0xFF2040E0 : 0xFFF0D020);
+    }
+  }
+  textures.push_back(sprite);
+
+  ReferenceTexture noise{"noise", 128, 128, {}};
+  u32 seed = 0x12345678;
+  for (int i = 0; i < noise.width * noise.height; i++)
+  {
+    seed = seed * 1664525 + 1013904223;
+    noise.pixels.push_back(seed | 0xFF000000);
+  }
+  textures.push_back(noise);
+
+  ReferenceTexture atlas{"atlas", 200, 72, {}};
+  for (int y = 0; y < atlas.height; y++)
+  {
+    for (int x = 0; x < atlas.width; x++)
+    {
+      const bool glyph = ((x % 10) < 6) && ((y % 12) < 9) && (((x * 7) ^ (y * 3)) & 4);
+      atlas.pixels.push_back(glyph ? 0xFFFFFFFF : 0x40000000);
+    }
+  }
+  textures.push_back(atlas);
+
+  return textures;
+}
+
+struct Algorithm
+{
+  int type;
+  const char* name;
+};
+
+const Algorithm ALGORITHMS[] = {
+    {TextureScaler::XBRZ, "xBRZ"},
+    {TextureScaler::HYBRID, "Hybrid"},
+    {TextureScaler::BICUBIC, "Bicubic"},
+    {TextureScaler::HYBRID_BICUBIC, "Hybrid Bicubic"},
+    {TextureScaler::JINC, "Jinc"},
+    {TextureScaler::JINC_SHARPER, "Jinc Sharper"},
+    {TextureScaler::SMOOTHSTEP, "Smoothstep"},
+    {TextureScaler::THREE_POINT, "3-Point"},
+    {TextureScaler::DDT, "DDT"},
+    {TextureScaler::DDT_SHARP, "DDT Sharp"},
+};
+
+// The scaling factor is clamped to this range by VideoConfig
+const int MIN_FACTOR = 2;
+const int MAX_FACTOR = 5;
+
+std::vector<u32> ScaleCopy(TextureScaler& scaler, ReferenceTexture& texture, int factor)
+{
+  const u32* out = scaler.Scale(texture.pixels.data(), texture.width, texture.height);
+  return std::vector<u32>(out, out + texture.width * texture.height * factor * factor);
+}
+
+// Runs the scaler with the thread pool unavailable, as a ParallelFor issued while another one
+// is in progress falls back to the calling thread.
+std::vector<u32> ScaleCopySerial(TextureScaler& scaler, ReferenceTexture& texture, int factor)
+{
+  std::vector<u32> result;
+  Common::ThreadPool::ParallelFor(0, 2, [&](s32 l, s32 u) {
+    if (l == 0)
+      result = ScaleCopy(scaler, texture, factor);
+  });
+  return result;
+}
+}
+
+class TextureScalerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_saved_config = g_ActiveConfig;
+    g_ActiveConfig.bTexDeposterize = false;
+  }
+  void TearDown() override { g_ActiveConfig = m_saved_config; }
+
+  VideoConfig m_saved_config;
+};
+
+TEST_F(TextureScalerTest, ParallelMatchesSerial)
+{
+  TextureScaler scaler;
+  std::vector<ReferenceTexture> textures = MakeReferenceTextures();
+  for (bool deposterize : {false, true})
+  {
+    g_ActiveConfig.bTexDeposterize = deposterize;
+    for (const Algorithm& algorithm : ALGORITHMS)
+    {
+      g_ActiveConfig.iTexScalingType = algorithm.type;
+      for (int factor = MIN_FACTOR; factor <= MAX_FACTOR; factor++)
+      {
+        g_ActiveConfig.iTexScalingFactor = factor;
+        for (ReferenceTexture& texture : textures)
+        {
+          std::vector<u32> serial = ScaleCopySerial(scaler, texture, factor);
+          std::vector<u32> parallel = ScaleCopy(scaler, texture, factor);
+          EXPECT_TRUE(serial == parallel) << algorithm.name << " " << factor << "x " << texture.name
+                                          << (deposterize ? " deposterized" : "");
+        }
+      }
+    }
+  }
+}
+
+// The backends and the asynchronous texture decoder use separate scalers on separate threads, the
+// xBRZ tables they share must stay valid while any of them is alive.
+TEST_F(TextureScalerTest, ScalersOnSeveralThreads)
+{
+  g_ActiveConfig.iTexScalingType = TextureScaler::XBRZ;
+  g_ActiveConfig.iTexScalingFactor = MIN_FACTOR;
+  std::vector<ReferenceTexture> textures = MakeReferenceTextures();
+  ReferenceTexture& texture = textures[0];
+
+  TextureScaler scaler;
+  const std::vector<u32> expected = ScaleCopy(scaler, texture, MIN_FACTOR);
+
+  std::atomic<bool> done{false};
+  std::thread other([&] {
+    while (!done.load())
+      std::make_unique<TextureScaler>().reset();
+  });
+  for (int i = 0; i < 20; i++)
+    EXPECT_TRUE(expected == ScaleCopy(scaler, texture, MIN_FACTOR)) << "iteration " << i;
+  done.store(true);
+  other.join();
+}
+
+// Not a correctness test: reports how long each algorithm takes per reference texture, so
+// changes to the scalers or the thread pool can be compared between builds. Disabled by default,
+// run it with --gtest_also_run_disabled_tests.
+TEST_F(TextureScalerTest, DISABLED_Benchmark)
+{
+  const int ITERATIONS = 3;
+  TextureScaler scaler;
+  std::vector<ReferenceTexture> textures = MakeReferenceTextures();
+
+  std::printf("%-16s", "ms/texture");
+  for (int factor = MIN_FACTOR; factor <= MAX_FACTOR; factor++)
+    std::printf("%10dx", factor);
+  std::printf("\n");
+
+  for (const Algorithm& algorithm : ALGORITHMS)
+  {
+    g_ActiveConfig.iTexScalingType = algorithm.type;
+    std::printf("%-16s", algorithm.name);
+    for (int factor = MIN_FACTOR; factor <= MAX_FACTOR; factor++)
+    {
+      g_ActiveConfig.iTexScalingFactor = factor;
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < ITERATIONS; i++)
+      {
+        for (ReferenceTexture& texture : textures)
+          EXPECT_NE(nullptr, scaler.Scale(texture.pixels.data(), texture.width, texture.height));
+      }
+      const std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - start;
+      std::printf("%11.2f", elapsed.count() / (ITERATIONS * textures.size()));
+    }
+    std::printf("\n");
+  }
+}
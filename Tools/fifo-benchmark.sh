@@ -0,0 +1,27 @@
+#!/bin/bash
+#
+# Replays every FIFO log (.dff) in a directory with the Null video backend and
+# prints the timing report of each one. Useful to compare the CPU cost of the
+# video pipeline before and after a VideoCommon change.
+#
+# Example usage:
+# $ ./Tools/fifo-benchmark.sh ./Build/Binaries/dolphin-emu-nogui ~/fifologs 10
+
+if [ $# -lt 2 ]; then
+    echo >&2 "usage: $0 <dolphin-emu-nogui> <directory with .dff files> [loops]"
+    exit 1
+fi
+
+dolphin=$1
+logs=$2
+loops=${3:-5}
+
+status=0
+for dff in "$logs"/*.dff; do
+    [ -f "$dff" ] || continue
+    echo "== $(basename "$dff")"
+    if ! "$dolphin" --fifo_benchmark="$loops" -v Null -e "$dff"; then
+        status=1
+    fi
+done
+exit $status